@@ -619,6 +619,14 @@ void ai_set_mode_warp_out(object *objp, ai_info *aip);
 // prototyped by Goober5000
 int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, int class_type = -1);
 
+// decide the targets of AI ships before the objects are moved, see -parallel_ai
+void ai_decide_targets();
+void ai_discard_target_decisions();
+void ai_decide_target_objnums(const SCP_vector<int> &objnums, bool parallel, SCP_vector<int> &target_objnums);
+
+// number of differences -check_ai_targets has found between the decided targets and the ones found without -parallel_ai
+extern int Ai_target_check_mismatches;
+
 // moved to header file by Goober5000
 void ai_announce_ship_dying(object *dying_objp);
 
@@ -25,6 +25,7 @@
 #include "ai/ailua.h"
 #include "asteroid/asteroid.h"
 #include "autopilot/autopilot.h"
+#include "cmdline/cmdline.h"
 #include "cmeasure/cmeasure.h"
 #include "debris/debris.h"
 #include "debugconsole/console.h"
@@ -55,6 +56,7 @@
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/waypoint.h"
 #include "parse/parselo.h"
@@ -71,7 +73,9 @@
 #include "ship/shipfx.h"
 #include "ship/shiphit.h"
 #include "ship/subsysdamage.h"
+#include "tracing/tracing.h"
 #include "utils/Random.h"
+#include "utils/threading.h"
 #include "weapon/beam.h"
 #include "weapon/flak.h"
 #include "weapon/swarm.h"
@@ -2357,11 +2361,11 @@ void evaluate_object_as_nearest_objnum(eval_nearest_objnum *eno)
  * @param ship_info_index	If >=0, the enemy object must be of the specified ship class
  * @param class_type		If >=0, the enemy object must be of the specified ship type
  */
-int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, int class_type)
+static int find_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, int class_type)
 {
 	object	*danger_weapon_objp;
 	ai_info	*aip;
-	ship_obj	*so;
+	SCP_vector<int> candidates;
 
 	// initialize eno struct
 	eval_nearest_objnum eno;
@@ -2376,12 +2380,14 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	eno.nearest_objnum = -1;
 	eno.check_danger_weapon_objnum = 0;
 
-	// go through the list of all ships and evaluate as potential targets
-	for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-		if (Objects[so->objnum].flags[Object::Object_Flags::Should_be_dead])
+	// go through the ships which may be in range and evaluate them as potential targets
+	// the distance is scaled down by at most half for fighters, so a ship can be up to twice the range away
+	obj_grid_query_ships(&Objects[objnum].pos, 2.0f * range, candidates);
+	for (int candidate : candidates) {
+		if (Objects[candidate].flags[Object::Object_Flags::Should_be_dead])
 			continue;
 
-		eno.trial_objp = &Objects[so->objnum];
+		eno.trial_objp = &Objects[candidate];
 		evaluate_object_as_nearest_objnum(&eno);
 	}
 
@@ -2413,12 +2419,257 @@ int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float ra
 	//	If only looking for target in certain wing and couldn't find anything in
 	//	that wing, look for any object.
 	if ((eno.nearest_objnum == -1) && (enemy_wing != -1)) {
-		return get_nearest_objnum(objnum, enemy_team_mask, -1, range, max_attackers, ship_info_index, class_type);
+		return find_nearest_objnum(objnum, enemy_team_mask, -1, range, max_attackers, ship_info_index, class_type);
 	}
 
 	return eno.nearest_objnum;
 }
 
+//	The target an AI ship will look for when it needs a new one, decided before the ships are moved.
+//	See ai_decide_targets().
+typedef struct ai_target_decision {
+	bool	valid;
+	int	objnum;				//	The ship the decision was made for
+	int	signature;
+	int	enemy_team_mask;	//	The arguments find_enemy() passes to get_nearest_objnum()
+	int	enemy_wing;
+	int	max_attackers;
+	float	range;
+	int	target_objnum;		//	The result of get_nearest_objnum(), or -1
+	int	target_signature;
+	int	ignore_objnum;		//	The objects the ship ignored, after the search has reset the ones which died
+	int	ignore_signature;
+	int	ignore_new_objnums[MAX_IGNORE_NEW_OBJECTS];
+	int	ignore_new_signatures[MAX_IGNORE_NEW_OBJECTS];
+} ai_target_decision;
+
+static ai_target_decision Ai_target_decisions[MAX_AI_INFO];
+static SCP_vector<int> Ai_decided_ai_indices;
+
+int Ai_target_check_mismatches = 0;
+
+int ai_need_new_target(object *pl_objp, int target_objnum);
+
+//	Whether find_enemy() may call get_nearest_objnum() for this ship this frame.
+//	This only reads game state, so it can be called while the decisions are made in parallel.
+static bool ai_may_look_for_target(object *objp)
+{
+	if (objp->flags[Object::Object_Flags::Should_be_dead])
+		return false;
+
+	auto shipp = &Ships[objp->instance];
+	if (shipp->ai_index < 0 || shipp->flags[Ship::Ship_Flags::Dying])
+		return false;
+
+	if (objp->flags[Object::Object_Flags::Player_ship] && !Player_use_ai)
+		return false;
+
+	auto aip = &Ai_info[shipp->ai_index];
+	if (!timestamp_elapsed(aip->choose_enemy_timestamp))
+		return false;
+
+	//	Only ships which automatically attack look for a target in ai_frame()
+	int class_type = Ship_info[shipp->ship_info_index].class_type;
+	if (class_type < 0 || !(Ship_types[class_type].flags[Ship::Type_Info_Flags::AI_auto_attacks]))
+		return false;
+
+	return ai_need_new_target(objp, aip->target_objnum) != 0;
+}
+
+static void ai_decide_target(ai_target_decision *decision, int objnum)
+{
+	object *objp = &Objects[objnum];
+	ai_info *aip = &Ai_info[Ships[objp->instance].ai_index];
+
+	decision->objnum = objnum;
+	decision->signature = objp->signature;
+	decision->enemy_team_mask = iff_get_attackee_mask(obj_team(objp));
+	decision->enemy_wing = aip->enemy_wing;
+	decision->max_attackers = The_mission.ai_profile->max_attackers[Game_skill_level];
+	decision->range = MAX_ENEMY_DISTANCE;
+
+	decision->target_objnum = find_nearest_objnum(objnum, decision->enemy_team_mask, decision->enemy_wing, decision->range, decision->max_attackers, -1, -1);
+	decision->target_signature = (decision->target_objnum >= 0) ? Objects[decision->target_objnum].signature : -1;
+
+	decision->ignore_objnum = aip->ignore_objnum;
+	decision->ignore_signature = aip->ignore_signature;
+	for (int i = 0; i < MAX_IGNORE_NEW_OBJECTS; i++) {
+		decision->ignore_new_objnums[i] = aip->ignore_new_objnums[i];
+		decision->ignore_new_signatures[i] = aip->ignore_new_signatures[i];
+	}
+
+	decision->valid = true;
+}
+
+//	Makes the decisions for the given ships, spread over the job system if parallel is set.
+static void ai_decide_targets_of(const SCP_vector<int> &objnums, bool parallel, SCP_vector<ai_target_decision> &decisions)
+{
+	//	ship_is_visible_by_team() would otherwise process AWACS on the first frame, from several jobs at once
+	awacs_ensure_processed();
+
+	decisions.resize(objnums.size());
+
+	if (!parallel) {
+		for (size_t i = 0; i < objnums.size(); ++i)
+			ai_decide_target(&decisions[i], objnums[i]);
+		return;
+	}
+
+	threading::parallel_for(0, objnums.size(), 4, [&objnums, &decisions](size_t first, size_t last) {
+		for (size_t i = first; i < last; ++i)
+			ai_decide_target(&decisions[i], objnums[i]);
+	});
+}
+
+/**
+ * Decides the targets of the given ships like ai_decide_targets() does, without storing the decisions.
+ * Used by the tests to compare the decisions made on the job system with the ones made one after the other.
+ */
+void ai_decide_target_objnums(const SCP_vector<int> &objnums, bool parallel, SCP_vector<int> &target_objnums)
+{
+	SCP_vector<ai_target_decision> decisions;
+	ai_decide_targets_of(objnums, parallel, decisions);
+
+	target_objnums.clear();
+	for (auto &decision : decisions)
+		target_objnums.push_back(decision.target_objnum);
+}
+
+//	Whether the ship still ignores the same objects as when the decision was made.  An expired temporary ignore is
+//	only dropped in ai_frame(), and orders may change what a ship ignores, after the decisions have been made.
+static bool ai_target_decision_ignores_match(const ai_target_decision *decision, const ai_info *aip)
+{
+	if ((decision->ignore_objnum != aip->ignore_objnum) || (decision->ignore_signature != aip->ignore_signature))
+		return false;
+
+	for (int i = 0; i < MAX_IGNORE_NEW_OBJECTS; i++) {
+		if ((decision->ignore_new_objnums[i] != aip->ignore_new_objnums[i]) || (decision->ignore_new_signatures[i] != aip->ignore_new_signatures[i]))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Decides the targets of AI ships which are going to look for one this frame.
+ *
+ * Called by obj_move_all() before any object is moved, if -parallel_ai or -check_ai_targets is used. Each job
+ * only writes to the decisions it makes and to the ai_info of the ship it decides for, where the search resets
+ * ignored objects which have died. Nothing else reads those while the decisions are made, so they see the state at the
+ * start of the frame no matter which thread makes them. They are applied when the ships call find_enemy() in
+ * ai_frame(), one after the other like before. With -check_ai_targets, every decision which is applied is
+ * compared with the target the search on the current state finds, see get_nearest_objnum().
+ */
+void ai_decide_targets()
+{
+	ai_discard_target_decisions();
+
+	if (!Cmdline_parallel_ai && !Cmdline_check_ai_targets)
+		return;
+
+	if (physics_paused || ai_paused || MULTIPLAYER_CLIENT)
+		return;
+
+	TRACE_SCOPE(tracing::AIDecideTargets);
+
+	SCP_vector<int> objnums;
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		if (ai_may_look_for_target(&Objects[so->objnum]))
+			objnums.push_back(so->objnum);
+	}
+
+	if (objnums.empty())
+		return;
+
+	SCP_vector<ai_target_decision> decisions;
+	ai_decide_targets_of(objnums, true, decisions);
+
+	for (size_t i = 0; i < objnums.size(); ++i) {
+		int ai_index = Ships[Objects[objnums[i]].instance].ai_index;
+		Ai_target_decisions[ai_index] = decisions[i];
+		Ai_decided_ai_indices.push_back(ai_index);
+	}
+}
+
+/**
+ * Drops the decisions which haven't been used.  Called after all objects have been moved, since the state they
+ * were made from is out of date by then.
+ */
+void ai_discard_target_decisions()
+{
+	for (int ai_index : Ai_decided_ai_indices)
+		Ai_target_decisions[ai_index].valid = false;
+
+	Ai_decided_ai_indices.clear();
+}
+
+//	Uses the decision made for this ship at the start of the frame if there is one for exactly this search.
+//	Each decision is only used once, later searches in the same frame see the current state.
+static bool ai_use_target_decision(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, int class_type, int *target_objnum)
+{
+	int ai_index = Ships[Objects[objnum].instance].ai_index;
+	if (ai_index < 0)
+		return false;
+
+	auto decision = &Ai_target_decisions[ai_index];
+	if (!decision->valid)
+		return false;
+
+	decision->valid = false;
+
+	if ((decision->objnum != objnum) || (decision->signature != Objects[objnum].signature))
+		return false;
+
+	if ((decision->enemy_team_mask != enemy_team_mask) || (decision->enemy_wing != enemy_wing) || (decision->range != range)
+		|| (decision->max_attackers != max_attackers) || (ship_info_index >= 0) || (class_type >= 0))
+		return false;
+
+	if (!ai_target_decision_ignores_match(decision, &Ai_info[ai_index]))
+		return false;
+
+	if (decision->target_objnum >= 0) {
+		object *target_objp = &Objects[decision->target_objnum];
+
+		//	The target may have died, or ships which decided earlier this frame may have taken up all attacker slots
+		if ((target_objp->signature != decision->target_signature) || (target_objp->type != OBJ_SHIP) || target_objp->flags[Object::Object_Flags::Should_be_dead])
+			return false;
+
+		if (!Ship_info[Ships[target_objp->instance].ship_info_index].is_big_or_huge() && (num_enemies_attacking(decision->target_objnum) >= max_attackers))
+			return false;
+	}
+
+	*target_objnum = decision->target_objnum;
+	return true;
+}
+
+/**
+ * Given an object and an enemy team, return the index of the nearest enemy object.
+ * See find_nearest_objnum(), this uses the target decided at the start of the frame if there is one.
+ *
+ * With -check_ai_targets, the search on the current state is done as well, like without -parallel_ai. Its target
+ * is used, and any difference to the decided one is logged.
+ */
+int get_nearest_objnum(int objnum, int enemy_team_mask, int enemy_wing, float range, int max_attackers, int ship_info_index, int class_type)
+{
+	int target_objnum;
+
+	if (ai_use_target_decision(objnum, enemy_team_mask, enemy_wing, range, max_attackers, ship_info_index, class_type, &target_objnum)) {
+		if (!Cmdline_check_ai_targets)
+			return target_objnum;
+
+		int live_target_objnum = find_nearest_objnum(objnum, enemy_team_mask, enemy_wing, range, max_attackers, ship_info_index, class_type);
+		if (live_target_objnum != target_objnum) {
+			Ai_target_check_mismatches++;
+			mprintf(("AI target check: %s decided on target %d at the start of the frame, but finds %d now (%d mismatches so far)\n",
+				Ships[Objects[objnum].instance].ship_name, target_objnum, live_target_objnum, Ai_target_check_mismatches));
+		}
+
+		return live_target_objnum;
+	}
+
+	return find_nearest_objnum(objnum, enemy_team_mask, enemy_wing, range, max_attackers, ship_info_index, class_type);
+}
+
 /**
  * Given an object and an enemy team, return the index of the nearest enemy object.
  *
@@ -15,6 +15,7 @@
 #include "network/multi.h"
 #include "network/multimsgs.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "scripting/global_hooks.h"
 #include "scripting/scripting.h"
 #include "render/3d.h"
@@ -774,8 +775,7 @@ int get_nearest_turret_objnum(int turret_parent_objnum, const ship_subsys *turre
 	auto swp = &turret_subsys->weapons;
 
 	// list of stuff to go thru
-	ship_obj		*so;
-	missile_obj *mo;
+	SCP_vector<int> candidates;
 
 	//wip=&Weapon_info[tp->turret_weapon_type];
 	//weapon_travel_dist = MIN(wip->lifetime * wip->max_speed, wip->weapon_range);
@@ -978,8 +978,18 @@ int get_nearest_turret_objnum(int turret_parent_objnum, const ship_subsys *turre
 					if ( !((aip->ai_profile_flags[AI::Profile_Flags::Huge_turret_weapons_ignore_bombs]) && big_only_flag) )
 					{
 						// Missile_obj_list
-						for( mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo) ) {
-							auto objp = &Objects[mo->objnum];
+						// bombs are only limited to the range of the turret if the AI profile says so
+						if (aip->ai_profile_flags[AI::Profile_Flags::Prevent_targeting_bombs_beyond_range]) {
+							obj_grid_query_missiles(tpos, eeo.weapon_travel_dist, candidates);
+						} else {
+							candidates.clear();
+							for (auto mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo)) {
+								candidates.push_back(mo->objnum);
+							}
+						}
+
+						for (int candidate : candidates) {
+							auto objp = &Objects[candidate];
 							if (objp->flags[Object::Object_Flags::Should_be_dead])
 								continue;
 
@@ -1001,8 +1011,15 @@ int get_nearest_turret_objnum(int turret_parent_objnum, const ship_subsys *turre
 				case 1:
 					//Return if a ship is found
 					// Ship_used_list
-					for ( so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so) ) {
-						auto objp = &Objects[so->objnum];
+					// only ships within range can become the nearest attacker, stealth ships are always included.
+					// If the turret needs its target in the field of view, the ships outside of it can't either.
+					if ((turret_subsys->flags[Ship::Subsystem_Flags::FOV_Required]) || (current_enemy != -1)) {
+						obj_grid_query_ships_in_cone(tpos, tvec, eeo.weapon_travel_dist, turret_subsys->system_info->turret_fov, candidates);
+					} else {
+						obj_grid_query_ships(tpos, eeo.weapon_travel_dist, candidates);
+					}
+					for (int candidate : candidates) {
+						auto objp = &Objects[candidate];
 						if (objp->flags[Object::Object_Flags::Should_be_dead])
 							continue;
 						evaluate_obj_as_target(objp, &eeo);
@@ -32,7 +32,9 @@
 #include "tgautils/tgautils.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
+#include <atomic>
 #include <cctype>
 #include <climits>
 #include <iomanip>
@@ -2269,6 +2271,11 @@ void bm_lock_dds(int handle, bitmap_slot *bs, bitmap *bmp, int /*bpp*/, ushort /
 	bmp->flags = 0;
 
 	if (error != DDS_ERROR_NONE) {
+		// the header was fine when the bitmap was loaded, so this is a compression format which can't be decoded
+		if (error == DDS_ERROR_INVALID_FORMAT) {
+			Error(LOCATION, "Invalid FourCC for DDS decompression of '%s'!", filename);
+		}
+
 		bm_free_data(bs);
 		return;
 	}
@@ -2633,6 +2640,194 @@ void bm_page_in_start() {
 	gr_bm_page_in_start();
 }
 
+/**
+ * Image data of a bitmap which is decoded by a worker thread while bm_page_in_stop() uploads the bitmaps before it
+ */
+struct bm_page_in_decode {
+	bitmap_slot* slot = nullptr;
+
+	// Copied from the entry up front so that the worker never has to look at it
+	BM_TYPE type = BM_TYPE_NONE;
+	BM_TYPE comp_type = BM_TYPE_NONE;
+	char filename[MAX_FILENAME_LEN];
+	int dir_type = CF_TYPE_ANY;
+	size_t size = 0;
+
+	ubyte* data = nullptr;
+	int bpp = 0;
+
+	threading::job_counter done;
+};
+
+/**
+ * Reads the image data the same way bm_lock_png(), bm_lock_jpg() and bm_lock_dds() would, but into a staging buffer
+ */
+static void bm_page_in_decode_data(bm_page_in_decode* decode, std::atomic<std::uint64_t>* decode_time)
+{
+	TRACE_SCOPE(tracing::PageInDecode);
+
+	auto start = timer_get_nanoseconds();
+
+	auto data = static_cast<ubyte*>(vm_malloc(decode->size));
+	memset(data, 0, decode->size);
+
+	bool ok = false;
+
+	switch (decode->type) {
+	case BM_TYPE_PNG: {
+		int bpp = 32;
+		ok = png_read_bitmap(decode->filename, data, &bpp, 4, decode->dir_type) == PNG_ERROR_NONE;
+		decode->bpp = bpp;
+		break;
+	}
+
+	case BM_TYPE_JPG:
+		ok = jpeg_read_bitmap(decode->filename, data, nullptr, 3, decode->dir_type, true) == JPEG_ERROR_NONE;
+		decode->bpp = 24;
+		break;
+
+	default: {
+		ubyte dds_bpp = 0;
+		ok = dds_read_bitmap(decode->filename, data, &dds_bpp, decode->dir_type) == DDS_ERROR_NONE;
+
+#if BYTE_ORDER == BIG_ENDIAN
+		// see bm_lock_dds()
+		if ((decode->comp_type == BM_TYPE_DDS) || (decode->comp_type == BM_TYPE_CUBEMAP_DDS)) {
+			if (dds_bpp == 32) {
+				for (size_t i = 0; i < decode->size; i += 4) {
+					auto swap_tmp = reinterpret_cast<unsigned int*>(data + i);
+					*swap_tmp = INTEL_INT(*swap_tmp);
+				}
+			} else if (dds_bpp == 16) {
+				for (size_t i = 0; i < decode->size; i += 2) {
+					auto swap_tmp = reinterpret_cast<unsigned short*>(data + i);
+					*swap_tmp = INTEL_SHORT(*swap_tmp);
+				}
+			}
+		}
+#endif
+
+		decode->bpp = dds_bpp;
+		break;
+	}
+	}
+
+	if (ok) {
+		decode->data = data;
+	} else {
+		// bm_lock() will try again later and handle the error
+		vm_free(data);
+	}
+
+	*decode_time += timer_get_nanoseconds() - start;
+}
+
+/**
+ * Starts decoding the image data of a bitmap on the job system, if it is of a type that can be decoded off the main thread
+ *
+ * @return The pending decode, or nullptr if the bitmap will be loaded by bm_lock() as usual
+ */
+static std::unique_ptr<bm_page_in_decode> bm_page_in_queue_decode(bitmap_slot* slot, std::atomic<std::uint64_t>* decode_time)
+{
+	auto be = &slot->entry;
+
+	if (be->bm.data != 0) {
+		return nullptr;
+	}
+
+	// make sure we use the real graphic type for EFFs
+	auto c_type = (be->type == BM_TYPE_EFF) ? be->info.ani.eff.type : be->type;
+	size_t size;
+
+	switch (c_type) {
+	case BM_TYPE_PNG:
+		if (be->info.ani.apng.is_apng) {
+			return nullptr;
+		}
+		size = static_cast<size_t>(be->bm.w * be->bm.h * 4);
+		break;
+
+	case BM_TYPE_JPG:
+	case BM_TYPE_DDS:
+	case BM_TYPE_DXT1:
+	case BM_TYPE_DXT3:
+	case BM_TYPE_DXT5:
+	case BM_TYPE_BC7:
+	case BM_TYPE_CUBEMAP_DDS:
+	case BM_TYPE_CUBEMAP_DXT1:
+	case BM_TYPE_CUBEMAP_DXT3:
+	case BM_TYPE_CUBEMAP_DXT5:
+		size = be->mem_taken;
+		break;
+
+	default:
+		return nullptr;
+	}
+
+	if (size == 0) {
+		return nullptr;
+	}
+
+	std::unique_ptr<bm_page_in_decode> decode(new bm_page_in_decode());
+	decode->slot = slot;
+	decode->type = c_type;
+	decode->comp_type = be->comp_type;
+	char filename[MAX_FILENAME_LEN];
+	EFF_FILENAME_CHECK;
+	strcpy_s(decode->filename, filename);
+	decode->dir_type = be->dir_type;
+	decode->size = size;
+
+	auto ptr = decode.get();
+	threading::submit_job([ptr, decode_time]() { bm_page_in_decode_data(ptr, decode_time); }, &decode->done);
+
+	return decode;
+}
+
+/**
+ * Waits for a decode to finish and hands its image data to the bitmap, which is then uploaded by the usual bm_lock() path
+ *
+ * @return true if the bitmap now holds the decoded data
+ */
+static bool bm_page_in_finish_decode(bm_page_in_decode* decode)
+{
+	{
+		TRACE_SCOPE(tracing::PageInWaitForDecode);
+		threading::wait_for(decode->done);
+	}
+
+	if (decode->data == nullptr) {
+		return false;
+	}
+
+	auto bs = decode->slot;
+	auto be = &bs->entry;
+
+	// loaded in the meantime, e.g. as another frame of an animation
+	if (be->bm.data != 0) {
+		vm_free(decode->data);
+		decode->data = nullptr;
+		return false;
+	}
+
+	bm_free_data(bs);
+
+#ifdef BMPMAN_NDEBUG
+	Assert(be->data_size == 0);
+	be->data_size = decode->size;
+	bm_texture_ram += decode->size;
+#endif
+
+	be->bm.bpp = static_cast<ubyte>(decode->bpp);
+	be->bm.data = reinterpret_cast<ptr_u>(decode->data);
+	be->bm.palette = nullptr;
+	be->bm.flags = 0;
+
+	decode->data = nullptr;
+
+	return true;
+}
+
 void bm_page_in_stop() {
 	TRACE_SCOPE(tracing::PageInStop);
 
@@ -2647,6 +2842,8 @@ void bm_page_in_stop() {
 
 	int bm_preloading = 1;
 
+	SCP_vector<bitmap_slot*> preloaded;
+
 	for (auto& block : bm_blocks) {
 		for (auto& slot : block) {
 			auto& entry = slot.entry;
@@ -2654,45 +2851,99 @@ void bm_page_in_stop() {
 			if ((entry.type != BM_TYPE_NONE) && (entry.type != BM_TYPE_RENDER_TARGET_DYNAMIC)
 				&& (entry.type != BM_TYPE_RENDER_TARGET_STATIC)) {
 				if (entry.preloaded) {
-					TRACE_SCOPE(tracing::PageInSingleBitmap);
-					if (bm_preloading) {
-						if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
-							mprintf(("Out of VRAM.  Done preloading.\n"));
-							bm_preloading = 0;
-						}
-					} else {
-						bm_lock(entry.handle, (entry.used_flags == BMP_AABITMAP) ? 8 : 16, entry.used_flags);
-						if (entry.ref_count >= 1) {
-							bm_unlock(entry.handle);
-						}
+					preloaded.push_back(&slot);
+				} else {
+					bm_unload_fast(entry.handle);
+				}
+			}
+		}
+	}
+
+	// While the main thread uploads one bitmap, the worker threads already decode the image data of the next few.
+	// The window limits how much decoded data waits around in memory.
+	const size_t decode_window = threading::is_threading() ? (threading::get_num_workers() * 2) : 0;
+	SCP_vector<std::unique_ptr<bm_page_in_decode>> decodes(preloaded.size());
+	size_t next_decode = 0;
+	std::atomic<std::uint64_t> decode_time{0};
+	int num_decoded = 0;
+
+	for (size_t i = 0; i < preloaded.size(); ++i) {
+		auto& entry = preloaded[i]->entry;
+
+		TRACE_SCOPE(tracing::PageInSingleBitmap);
+
+		// uploading the first frame of an animation loads all of its frames, so they need to be ready as well
+		size_t upload_end = i + 1;
+		if (entry.info.ani.first_frame == entry.handle) {
+			while (upload_end < preloaded.size() && (upload_end - i) < static_cast<size_t>(entry.info.ani.num_frames)
+				&& preloaded[upload_end]->entry.info.ani.first_frame == entry.handle) {
+				++upload_end;
+			}
+		}
+
+		for (; decode_window > 0 && next_decode < preloaded.size() && (next_decode < upload_end || next_decode < i + decode_window); ++next_decode) {
+			decodes[next_decode] = bm_page_in_queue_decode(preloaded[next_decode], &decode_time);
+		}
+
+		bool decoded = false;
+		for (size_t j = i; j < upload_end; ++j) {
+			if (decodes[j] != nullptr) {
+				if (bm_page_in_finish_decode(decodes[j].get())) {
+					++num_decoded;
+
+					if (j == i) {
+						decoded = true;
 					}
+				}
+				decodes[j].reset();
+			}
+		}
+
+		{
+			TRACE_SCOPE(tracing::PageInUpload);
+
+			if (bm_preloading) {
+				if (!gr_preload(entry.handle, (entry.preloaded == 2))) {
+					mprintf(("Out of VRAM.  Done preloading.\n"));
+					bm_preloading = 0;
+				} else if (decoded && (entry.bm.data != 0)) {
+					// the texture was already in VRAM so the decoded data was never needed
+					bm_free_data_fast(entry.handle);
+				}
+			} else {
+				bm_lock(entry.handle, (entry.used_flags == BMP_AABITMAP) ? 8 : 16, entry.used_flags);
+				if (entry.ref_count >= 1) {
+					bm_unlock(entry.handle);
+				}
+			}
+		}
 
-					n++;
+		n++;
 
-					multi_send_anti_timeout_ping();
+		multi_send_anti_timeout_ping();
 
-					if ((entry.info.ani.first_frame == 0) || (entry.info.ani.first_frame == entry.handle)) {
+		if ((entry.info.ani.first_frame == 0) || (entry.info.ani.first_frame == entry.handle)) {
 #ifndef NDEBUG
-						memset(busy_text, 0, sizeof(busy_text));
+			memset(busy_text, 0, sizeof(busy_text));
 
-						strcat_s(busy_text, "** BmpMan: ");
-						strcat_s(busy_text, entry.filename);
-						strcat_s(busy_text, " **");
+			strcat_s(busy_text, "** BmpMan: ");
+			strcat_s(busy_text, entry.filename);
+			strcat_s(busy_text, " **");
 
-						game_busy(busy_text);
+			game_busy(busy_text);
 #else
-						game_busy();
+			game_busy();
 #endif
-					}
-				} else {
-					bm_unload_fast(entry.handle);
-				}
-			}
 		}
 	}
 
 	nprintf(("BmpInfo", "BMPMAN: Loaded %d bitmaps that are marked as used for this level.\n", n));
 
+	if (num_decoded > 0) {
+		mprintf(("BMPMAN: Decoded %d bitmaps on worker threads, taking %d ms of worker time.\n", num_decoded,
+			static_cast<int>(decode_time.load() / (NANOSECONDS_PER_MICROSECOND * MICROSECONDS_PER_MILLISECOND))));
+	}
+
 #ifndef NDEBUG
 	int total_bitmaps = 0;
 	int total_slots = 0;
@@ -28,6 +28,7 @@
 
 #include "cfile/cfile.h"
 #include "cfile/cfilearchive.h"
+#include "cfile/cfilecompression.h"
 #include "cfile/cfilesystem.h"
 #include "osapi/osapi.h"
 #include "parse/encrypt.h"
@@ -35,6 +36,7 @@
 
 
 #include <limits>
+#include <mutex>
 
 char Cfile_root_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
 char Cfile_user_dir[CFILE_ROOT_DIRECTORY_LEN] = "";
@@ -96,6 +98,9 @@ static SCP_vector<SCP_string> Cfile_stack;
 
 std::array<CFILE, MAX_CFILE_BLOCKS> Cfile_block_list;
 
+// Files may be opened and closed from worker threads, so claiming and releasing blocks is serialized
+static std::mutex Cfile_block_mutex;
+
 static const char *Cfile_cdrom_dir = NULL;
 
 //
@@ -761,7 +766,29 @@ CFILE *_cfopen_special(const char* source, int line, const CFileLocation &res, c
 	if (res.data_ptr != nullptr) {
 		return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), res.data_ptr, res.size, dir_type);
 	}
-	else {
+
+	if (res.offset) {
+		// Files in pack files are read straight out of the mapped pack if possible. Compressed files still need to go
+		// through stdio since the decompression code reads the compressed blocks from the file pointer.
+		size_t pack_size = 0;
+		auto pack_data = cf_get_pack_mapping(res.root_index, &pack_size);
+
+		if (pack_data != nullptr && res.offset + res.size <= pack_size) {
+			auto file_data = pack_data + res.offset;
+
+			int header = 0;
+			if (res.size > 16) {
+				memcpy(&header, file_data, sizeof(header));
+				header = INTEL_INT(header);
+			}
+
+			if (comp_check_header(header) != COMP_HEADER_MATCH) {
+				return cf_open_memory_fill_cfblock(source, line, res.name_ext.c_str(), file_data, res.size, dir_type);
+			}
+		}
+	}
+
+	{
 		// "file_path" should already be a fully qualified path, so just try to open it
 		FILE *fp = fopen(res.full_name.c_str(), "rb");
 
@@ -813,6 +840,8 @@ static int cfget_cfile_block()
 	int i;
 	CFILE* cfile;
 
+	std::unique_lock<std::mutex> guard(Cfile_block_mutex);
+
 	for ( i = 0; i < MAX_CFILE_BLOCKS; i++ ) {
 		cfile = &Cfile_block_list[i];
 		if (cfile->type == CFILE_BLOCK_UNUSED) {
@@ -824,6 +853,8 @@ static int cfget_cfile_block()
 		}
 	}
 
+	guard.unlock();
+
 	// If we've reached this point, a free Cfile_block could not be found
 	nprintf(("Warning","A free Cfile_block could not be found.\n"));
 
@@ -856,6 +887,8 @@ int cfclose( CFILE * cfile )
 		// VP  do nothing
 	}
 	cf_clear_compression_info(cfile);
+
+	std::lock_guard<std::mutex> guard(Cfile_block_mutex);
 	cfile->type = CFILE_BLOCK_UNUSED;
 	return result;
 }
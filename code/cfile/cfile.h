@@ -256,6 +256,12 @@ int cfeof(CFILE *cfile);
 // Return the data pointer associated with the CFILE structure (for memory mapped files)
 const void *cf_returndata(CFILE *cfile);
 
+// Returns a pointer to the next len bytes of the file and moves the read position past them, without copying anything.
+// This only works for memory mapped files (which includes uncompressed files in pack files), for all other files or if
+// there are fewer than len bytes left, nullptr is returned and the read position is left alone. The pointer stays valid
+// until the file is closed, and the data must not be modified.
+const void *cf_borrow_data(CFILE *cfile, size_t len);
+
 // get the 2 byte checksum of the passed filename - return 0 if operation failed, 1 if succeeded
 int cf_chksum_short(const char *filename, ushort *chksum, int max_size = -1, int cf_type = CF_TYPE_ANY );
 
@@ -375,6 +381,7 @@ struct CFileLocation {
 	size_t offset        = 0;
 	time_t m_time        = 0;
 	const void* data_ptr = nullptr;
+	int root_index       = -1; // The root the file was found in, if it is in a pack file
 
 	explicit CFileLocation(bool found_in = false) : found(found_in) {}
 };
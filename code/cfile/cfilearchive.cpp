@@ -76,8 +76,9 @@ void cf_clear_compression_info(CFILE* cfile)
 		cfile->compression_info.decoder_buffer = nullptr;
 		cfile->compression_info.header = 0;
 		cfile->compression_info.block_size = 0;
-		cfile->compression_info.last_decoded_block_pos = 0;
-		cfile->compression_info.last_decoded_block_bytes = 0;
+		cfile->compression_info.decoder_buffer_blocks = 0;
+		cfile->compression_info.cached_first_block = 0;
+		cfile->compression_info.cached_num_blocks = 0;
 		cfile->compression_info.num_offsets = 0;
 	}
 }
@@ -258,6 +259,29 @@ int cfread(void *buf, int elsize, int nelem, CFILE *cfile)
 	return (int)(bytes_read / elsize);
 }
 
+const void *cf_borrow_data(CFILE *cfile, size_t len)
+{
+	if (!cf_is_valid(cfile) || cfile->data == nullptr)
+		return nullptr;
+
+	if (cfile->raw_position + len > cfile->size)
+		return nullptr;
+
+	if (cfile->max_read_len) {
+		if ( cfile->raw_position+len > cfile->max_read_len ) {
+			std::ostringstream s_buf;
+			s_buf << "Attempted to read " << len << "-byte(s) beyond length limit";
+
+			throw cfile::max_read_length(s_buf.str());
+		}
+	}
+
+	auto data = reinterpret_cast<const char*>(cfile->data) + cfile->raw_position;
+	cfile->raw_position += len;
+
+	return data;
+}
+
 int cfread_lua_number(double *buf, CFILE *cfile)
 {
 	if(!cf_is_valid(cfile))
@@ -266,13 +290,6 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 	if(buf == NULL)
 		return 0;
 
-	// cfread() not supported for memory-mapped files
-	if(cfile->data != nullptr)
-	{
-		Warning(LOCATION, "Writing is not supported for mem-mapped files");
-		return 0;
-	}
-
 	size_t advance = 0;
 	int items_read;
 	if (cfile->fp) {
@@ -280,10 +297,17 @@ int cfread_lua_number(double *buf, CFILE *cfile)
 		items_read = fscanf(cfile->fp, LUA_NUMBER_SCAN, buf);
 		advance = (size_t) (ftell(cfile->fp)-orig_pos);
 	} else {
-		int read;
+		// The data isn't null terminated (memory mapped pack files just continue with the next file), so scan a
+		// terminated copy of the text at the current position. No number is anywhere near this long.
+		char number[64];
+		size_t length = std::min(sizeof(number) - 1, cfile->size - cfile->raw_position);
+		memcpy(number, reinterpret_cast<const char*>(cfile->data) + cfile->raw_position, length);
+		number[length] = '\0';
+
+		int read = 0;
 		// %n returns the number of bytes currently read so we append that to the scan format at the end so it will return
 		// how many bytes we have consumed
-		items_read = sscanf(reinterpret_cast<const char*>(cfile->data), LUA_NUMBER_SCAN "%n", buf, &read);
+		items_read = sscanf(number, LUA_NUMBER_SCAN "%n", buf, &read);
 		if (items_read == 2) {
 			// We need to correct the items read counter since we read one additional item
 			items_read = 1;
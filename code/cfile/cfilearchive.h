@@ -28,9 +28,10 @@ struct COMPRESSION_INFO {
 	int block_size = 0;
 	int num_offsets = 0;
 	int* offsets = nullptr;
-	char* decoder_buffer = nullptr;
-	int last_decoded_block_pos = 0;
-	int last_decoded_block_bytes = 0;
+	char* decoder_buffer = nullptr;		// Decoded blocks cached_first_block to cached_first_block + cached_num_blocks
+	int decoder_buffer_blocks = 0;		// How many blocks fit into decoder_buffer
+	int cached_first_block = 0;
+	int cached_num_blocks = 0;
 };
 
 struct CFILE {
@@ -1,5 +1,7 @@
 #define _CFILE_INTERNAL 
 
+#include <algorithm>
+#include <atomic>
 #include <cstdlib>
 #include <cstring>
 #include <cstdio>
@@ -14,6 +16,7 @@
 #include "lz4.h"
 #include "cfilecompression.h"
 #include "cfilearchive.h"
+#include "utils/threading.h"
 
 /*INTERNAL FUNCTIONS*/
 /*LZ41*/
@@ -130,9 +133,10 @@ void lz41_create_ci(CFILE* cf, int header)
 	Assertion(fBsize == 1, "Error while reading block size, compressed file is possibly in the wrong format or corrupted.");
 	#endif
 
-	cf->compression_info.decoder_buffer = (char*)malloc(LZ4_compressBound(cf->compression_info.block_size));
-	cf->compression_info.last_decoded_block_pos = 0;
-	cf->compression_info.last_decoded_block_bytes = 0;
+	cf->compression_info.decoder_buffer = (char*)malloc(cf->compression_info.block_size);
+	cf->compression_info.decoder_buffer_blocks = 1;
+	cf->compression_info.cached_first_block = 0;
+	cf->compression_info.cached_num_blocks = 0;
 	lz41_load_offsets(cf);
 }
 
@@ -151,56 +155,181 @@ void lz41_load_offsets(CFILE* cf)
 	}
 }
 
+/* The decoded size of a block, only the last block of the file may be shorter than the block size */
+static size_t lz41_block_bytes(CFILE* cf, size_t block)
+{
+	size_t block_size = (size_t)cf->compression_info.block_size;
+	return std::min(block_size, cf->size - block * block_size);
+}
+
+/* Makes sure the decoder buffer can hold at least num_blocks blocks, the cached blocks are lost if it has to grow */
+static void lz41_reserve_decoder_buffer(CFILE* cf, int num_blocks)
+{
+	if (cf->compression_info.decoder_buffer_blocks >= num_blocks)
+		return;
+
+	free(cf->compression_info.decoder_buffer);
+	cf->compression_info.decoder_buffer = (char*)malloc((size_t)num_blocks * cf->compression_info.block_size);
+	cf->compression_info.decoder_buffer_blocks = num_blocks;
+	cf->compression_info.cached_num_blocks = 0;
+}
+
+/* Reads the compressed data of blocks first_block to end_block with a single read */
+static bool lz41_read_blocks(CFILE* cf, size_t first_block, size_t end_block, SCP_vector<char>& cmp_buf)
+{
+	int cmp_bytes = cf->compression_info.offsets[end_block] - cf->compression_info.offsets[first_block];
+	if (cmp_bytes <= 0)
+		return false;
+
+	cmp_buf.resize((size_t)cmp_bytes);
+
+	fso_fseek(cf, cf->compression_info.offsets[first_block], SEEK_SET);
+	auto bytes_read = fread(cmp_buf.data(), cmp_bytes, 1, cf->fp);
+	Assertion(bytes_read == 1, "Error reading from compressed file.");
+
+	return bytes_read == 1;
+}
+
+/*
+	Decodes blocks first_block to end_block out of the data read by lz41_read_blocks(), dest(block) says where each block goes.
+	Every block is compressed on its own, so the blocks can be spread across the worker threads.
+*/
+template <typename Dest>
+static bool lz41_decode_blocks(CFILE* cf, size_t first_block, size_t end_block, const SCP_vector<char>& cmp_buf, Dest&& dest)
+{
+	const int* offsets = cf->compression_info.offsets;
+	std::atomic_bool failed(false);
+
+	auto decode = [&](size_t first, size_t last) {
+		for (size_t block = first; block < last; ++block)
+		{
+			/* The difference in offsets is the size of the block */
+			int cmp_bytes = offsets[block + 1] - offsets[block];
+			int block_bytes = (int)lz41_block_bytes(cf, block);
+			const char* cmp_data = cmp_buf.data() + (offsets[block] - offsets[first_block]);
+
+			if (cmp_bytes <= 0 || LZ4_decompress_safe(cmp_data, dest(block), cmp_bytes, block_bytes) != block_bytes)
+				failed.store(true, std::memory_order_relaxed);
+		}
+	};
+
+	if (end_block - first_block > LZ41_PARALLEL_GRAIN_BLOCKS)
+		threading::parallel_for(first_block, end_block, LZ41_PARALLEL_GRAIN_BLOCKS, decode);
+	else
+		decode(first_block, end_block);
+
+	return !failed.load();
+}
+
+/* Decodes num_blocks blocks starting at first_block into the decoder buffer */
+static bool lz41_fill_cache(CFILE* cf, size_t first_block, size_t num_blocks, SCP_vector<char>& cmp_buf)
+{
+	lz41_reserve_decoder_buffer(cf, (int)num_blocks);
+	cf->compression_info.cached_num_blocks = 0;
+
+	size_t end_block = first_block + num_blocks;
+	char* decoder_buffer = cf->compression_info.decoder_buffer;
+	size_t block_size = (size_t)cf->compression_info.block_size;
+
+	if (!lz41_read_blocks(cf, first_block, end_block, cmp_buf))
+		return false;
+
+	if (!lz41_decode_blocks(cf, first_block, end_block, cmp_buf, [=](size_t block) { return decoder_buffer + (block - first_block) * block_size; }))
+		return false;
+
+	cf->compression_info.cached_first_block = (int)first_block;
+	cf->compression_info.cached_num_blocks = (int)num_blocks;
+	return true;
+}
+
+/*
+	Decodes a read of many blocks straight into the output. The blocks at the ends may only be needed in part, those are decoded into the
+	decoder buffer instead: the last block goes into the first slot, so that it stays cached for whatever is read next.
+*/
+static size_t lz41_parallel_read(CFILE* cf, char* bytes_out, size_t offset, size_t length, size_t first_block, size_t end_block, SCP_vector<char>& cmp_buf)
+{
+	lz41_reserve_decoder_buffer(cf, 2);
+	cf->compression_info.cached_num_blocks = 0;
+
+	size_t block_size = (size_t)cf->compression_info.block_size;
+	size_t last_block = end_block - 1;
+	size_t first_block_offset = offset % block_size;
+	char* last_block_buffer = cf->compression_info.decoder_buffer;
+	char* first_block_buffer = cf->compression_info.decoder_buffer + block_size;
+
+	if (!lz41_read_blocks(cf, first_block, end_block, cmp_buf))
+		return (size_t)LZ41_DECOMPRESSION_ERROR;
+
+	auto dest = [=](size_t block) {
+		if (block == last_block)
+			return last_block_buffer;
+		if (block == first_block && first_block_offset != 0)
+			return first_block_buffer;
+		return bytes_out + (block * block_size - offset);
+	};
+
+	if (!lz41_decode_blocks(cf, first_block, end_block, cmp_buf, dest))
+		return (size_t)LZ41_DECOMPRESSION_ERROR;
+
+	if (first_block_offset != 0)
+		memcpy(bytes_out, first_block_buffer + first_block_offset, block_size - first_block_offset);
+
+	size_t last_block_start = last_block * block_size - offset;
+	memcpy(bytes_out + last_block_start, last_block_buffer, length - last_block_start);
+
+	cf->compression_info.cached_first_block = (int)last_block;
+	cf->compression_info.cached_num_blocks = 1;
+
+	return length;
+}
+
 size_t lz41_stream_random_access(CFILE* cf, char* bytes_out, size_t offset, size_t length)
 {
-	LZ4_streamDecode_t lz4_stream_decode_body;
-	LZ4_streamDecode_t* lz4_stream_decode = &lz4_stream_decode_body;
 	/* The blocks (current_block to end_block) contain the data we want */
-	size_t current_block = offset / cf->compression_info.block_size;
-	size_t end_block = ((offset + length - 1) / cf->compression_info.block_size) + 1;
+	size_t block_size = (size_t)cf->compression_info.block_size;
+	size_t current_block = offset / block_size;
+	size_t end_block = ((offset + length - 1) / block_size) + 1;
 	size_t written_bytes = 0;
 
+	/* Kept between reads so the compressed data doesn't need a new allocation every time */
+	thread_local static SCP_vector<char> cmp_buf;
+
 	if (cf->compression_info.num_offsets <= (int)end_block)
 		return (size_t)LZ41_OFFSETS_MISMATCH;
 
-	/* Seek to the first block to read, if it matches the cached block, search the next one instead */
-	if (cf->compression_info.last_decoded_block_pos == cf->compression_info.offsets[current_block] && current_block + 1 <= end_block)
-		fso_fseek(cf, cf->compression_info.offsets[current_block+1], SEEK_SET);
-	else
-		fso_fseek(cf, cf->compression_info.offsets[current_block], SEEK_SET);
-	
-	offset = offset % cf->compression_info.block_size;
-	char* cmp_buf = (char*)malloc(LZ4_compressBound(cf->compression_info.block_size));
+	/* Big reads, like loading a whole texture, are decoded in parallel without going through the cache */
+	if (end_block - current_block >= LZ41_PARALLEL_MIN_BLOCKS)
+		return lz41_parallel_read(cf, bytes_out, offset, length, current_block, end_block, cmp_buf);
+
+	offset = offset % block_size;
 
-	/* Start decoding */
 	for (; current_block < end_block; ++current_block)
 	{
-		/* Only read and decode if the requested block is not the cached one */
-		if (cf->compression_info.last_decoded_block_pos != cf->compression_info.offsets[current_block])
+		size_t cached_first_block = (size_t)cf->compression_info.cached_first_block;
+		size_t cached_end_block = cached_first_block + (size_t)cf->compression_info.cached_num_blocks;
+
+		/* Only read and decode if the requested block is not cached */
+		if (current_block < cached_first_block || current_block >= cached_end_block)
 		{
-			cf->compression_info.last_decoded_block_pos = cf->compression_info.offsets[current_block];
+			/* Continuing right where the cached blocks end means that the file is read sequentially, so decode the following blocks too */
+			size_t num_blocks = 1;
+			if (cf->compression_info.cached_num_blocks > 0 && current_block == cached_end_block)
+				num_blocks = std::min((size_t)LZ41_READ_AHEAD_BLOCKS, (size_t)cf->compression_info.num_offsets - 1 - current_block);
 
-			/* The difference in offsets is the size of the block */
-			int cmp_bytes = cf->compression_info.offsets[current_block + 1] - cf->compression_info.offsets[current_block];
-			auto bytes_read = fread(cmp_buf, cmp_bytes, 1, cf->fp);
-			Assertion(bytes_read == 1, "Error reading from compressed file.");
-
-			cf->compression_info.last_decoded_block_bytes = LZ4_decompress_safe_continue(lz4_stream_decode, cmp_buf, cf->compression_info.decoder_buffer, cmp_bytes, cf->compression_info.block_size);
-			if (cf->compression_info.last_decoded_block_bytes <= 0)
-			{
-				free(cmp_buf);
+			if (!lz41_fill_cache(cf, current_block, num_blocks, cmp_buf))
 				return (size_t)LZ41_DECOMPRESSION_ERROR;
-			}
+
+			cached_first_block = current_block;
 		}
 
 		/* Write out the part of the data we care about from buffer */
-		size_t block_length = (length < (cf->compression_info.last_decoded_block_bytes - offset) ? length : (cf->compression_info.last_decoded_block_bytes - offset));
-		memcpy(bytes_out + written_bytes, cf->compression_info.decoder_buffer + offset, (size_t)block_length);
+		const char* block_data = cf->compression_info.decoder_buffer + (current_block - cached_first_block) * block_size;
+		size_t block_length = std::min(length, lz41_block_bytes(cf, current_block) - offset);
+		memcpy(bytes_out + written_bytes, block_data + offset, block_length);
 		written_bytes += block_length;
 		offset = 0;
 		length -= block_length;
 	}
 
-	free(cmp_buf);
 	return written_bytes;
 }
@@ -5,9 +5,12 @@ ShivanSpS - Compressed files support for FSO. Many thanks to ngld, taylor and ev
 -The header ID can be used to add diferent revisions to LZ41 decompression system or to add other compression format supports whiout breaking compatibility.
 -The system uses a offset list to record the position of every block in file, this list, along with the number of offsets, original filesize,
 and block size, must be written by the compressor app.
--A decoder cache is used to store the last decoded block, this ensures each block is read and decoded only once in sequential reads. This cache
-is a little bit bigger than the block size, a higher block size means less overhead added to the file, but it also means a little more ram will
-be used during decompression.
+-A decoder cache is used to store the last decoded blocks, this ensures each block is read and decoded only once in sequential reads. Once a
+file is read sequentially, the cache reads ahead and decodes the following LZ41_READ_AHEAD_BLOCKS blocks at once, spread across the worker
+threads. A higher block size means less overhead added to the file, but it also means a little more ram will be used during decompression.
+-Reads covering at least LZ41_PARALLEL_MIN_BLOCKS blocks, like reading a whole texture or model, bypass the cache and decode all blocks
+straight into the output buffer in parallel. This only works because every block is compressed independently. Each job decodes
+LZ41_PARALLEL_GRAIN_BLOCKS blocks, a single block is too little work to be worth handing to another thread.
 -All this dynamic memory is assigned at cfopen() and it is cleared on cfclose().
 
 ................................char[4]..........(n ints)...(int)..........(int)..........(int)
@@ -24,6 +27,9 @@ struct CFILE;
 #define LZ41_MAX_BLOCKS_OVERFLOW -2
 #define LZ41_HEADER_MISMATCH -3
 #define LZ41_OFFSETS_MISMATCH -4
+#define LZ41_READ_AHEAD_BLOCKS 8
+#define LZ41_PARALLEL_MIN_BLOCKS 4
+#define LZ41_PARALLEL_GRAIN_BLOCKS 4
 /******/
 
 #define COMP_HEADER_MATCH 1
@@ -32,16 +32,97 @@
 #include <sys/stat.h>
 #include <unistd.h>
 #include <libgen.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #endif
 
+#include <mutex>
+
 #include "cfile/cfile.h"
 #include "cfile/cfilesystem.h"
 #include "cmdline/cmdline.h"
 #include "globalincs/pstypes.h"
 #include "def_files/def_files.h"
+#include "io/timer.h"
 #include "osapi/osapi.h"
 #include "parse/parselo.h"
 
+#ifdef _WIN32
+bool cf_file_mapping::map(const char *path)
+{
+	HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	m_file = file;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_file, &size) || size.QuadPart == 0) {
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr) {
+		return false;
+	}
+
+	m_data = static_cast<const ubyte *>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	if (m_data == nullptr) {
+		return false;
+	}
+
+	m_size = static_cast<size_t>(size.QuadPart);
+	return true;
+}
+
+cf_file_mapping::~cf_file_mapping()
+{
+	if (m_data != nullptr) {
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr) {
+		CloseHandle(m_mapping);
+	}
+	if (m_file != nullptr) {
+		CloseHandle(m_file);
+	}
+}
+#else
+bool cf_file_mapping::map(const char *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) {
+		close(fd);
+		return false;
+	}
+
+	void *data = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+
+	// The mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return false;
+	}
+
+	m_data = static_cast<const ubyte *>(data);
+	m_size = static_cast<size_t>(st.st_size);
+	return true;
+}
+
+cf_file_mapping::~cf_file_mapping()
+{
+	if (m_data != nullptr) {
+		munmap(const_cast<ubyte *>(m_data), m_size);
+	}
+}
+#endif
+
 enum CfileRootType {
 	CF_ROOTTYPE_PATH = 0,
 	CF_ROOTTYPE_PACK = 1,
@@ -63,7 +144,11 @@ typedef struct cf_root {
 	SCP_unordered_map<int, SCP_string> pathTypeToRealPath;
 #endif
 
-	cf_root() : roottype(-1), location_flags(0) {}
+	// For pack files, the contents mapped into memory. Only set up once a file from the pack is opened.
+	std::unique_ptr<cf_file_mapping> mapping;
+	bool mapping_attempted;
+
+	cf_root() : roottype(-1), location_flags(0), mapping_attempted(false) {}
 } cf_root;
 
 // convenient type for sorting (see cf_build_pack_list())
@@ -88,6 +173,9 @@ static SCP_vector<std::unique_ptr<cf_root_block>> Root_blocks;
 
 static int Num_path_roots = 0;
 
+// Pack files may be opened from several threads at once
+static std::mutex Pack_mapping_mutex;
+
 // Created by searching all roots in order.   This means Files is then sorted by precedence.
 typedef struct cf_file {
 	SCP_string	name_ext;	// Filename and extension
@@ -116,6 +204,12 @@ typedef struct cf_file_block {
 static uint Num_files = 0;
 static SCP_vector<std::unique_ptr<cf_file_block>> File_blocks;
 
+// All files by name and extension, built once the file list is complete. The file indices for one name are in list
+// order, so the first one which passes the pathtype, location and sub path checks is the one shadowing all the others.
+// The pathtype is not part of the key since CF_TYPE_ANY lookups need the precedence across all pathtypes.
+typedef SCP_unordered_map<SCP_string, SCP_vector<uint>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> cf_file_index;
+static cf_file_index File_index;
+
 // Return a pointer to to file 'index'.
 cf_file *cf_get_file(int index)
 {
@@ -945,14 +1039,239 @@ typedef struct VP_FILE {
 	_fs_time_t write_time;
 } VP_FILE;
 
-static int cf_add_pack_files(const int root_index, SCP_vector<_file_list_t> &files)
+// Pack directories from the last run, see cf_load_pack_index_cache()
+struct cf_pack_index {
+	int64_t m_time = 0;		// Write time of the pack file when it was read
+	int64_t size = 0;		// Size of the pack file when it was read
+	SCP_vector<_file_list_t> files;
+};
+
+#define CF_PACK_INDEX_CACHE_FILE		"cf_pack_index.bin"
+#define CF_PACK_INDEX_CACHE_ID			0x49504643		// "CFPI"
+#define CF_PACK_INDEX_CACHE_VERSION		1
+
+static SCP_unordered_map<SCP_string, cf_pack_index> Pack_index_cache;
+static bool Pack_index_cache_changed = false;
+static int Pack_index_cache_hits = 0;
+static int Pack_index_cache_lookups = 0;
+
+static bool cf_get_pack_stat(const SCP_string &path, int64_t *m_time, int64_t *size)
 {
-	if (files.empty()) {
-		return 0;
+	struct stat buf;
+
+	if (stat(path.c_str(), &buf) != 0) {
+		return false;
+	}
+
+	*m_time = static_cast<int64_t>(buf.st_mtime);
+	*size = static_cast<int64_t>(buf.st_size);
+
+	return true;
+}
+
+// The directory of a pack gets filtered through the pathtypes, so a cache made with different ones is useless
+static uint cf_get_pathtypes_hash()
+{
+	uint hash = 2166136261u;
+
+	auto hash_string = [&hash](const char *str) {
+		for (; str != nullptr && *str != '\0'; ++str) {
+			hash = (hash ^ static_cast<ubyte>(*str)) * 16777619u;
+		}
+		hash = (hash ^ 0xffu) * 16777619u;
+	};
+
+	for (auto &pathtype : Pathtypes) {
+		hash_string(pathtype.path);
+		hash_string(pathtype.extensions);
+	}
+
+	return hash;
+}
+
+static bool cf_cache_read(FILE *fp, void *data, size_t size)
+{
+	return fread(data, size, 1, fp) == 1;
+}
+
+template <typename T>
+static bool cf_cache_read(FILE *fp, T *value)
+{
+	return cf_cache_read(fp, value, sizeof(T));
+}
+
+static bool cf_cache_read(FILE *fp, SCP_string *str)
+{
+	uint len;
+
+	if ( !cf_cache_read(fp, &len) || (len > CF_MAX_PATHNAME_LENGTH) ) {
+		return false;
+	}
+
+	str->resize(len);
+
+	return (len == 0) || cf_cache_read(fp, &(*str)[0], len);
+}
+
+template <typename T>
+static void cf_cache_write(FILE *fp, const T &value)
+{
+	fwrite(&value, sizeof(T), 1, fp);
+}
+
+static void cf_cache_write(FILE *fp, const SCP_string &str)
+{
+	cf_cache_write(fp, static_cast<uint>(str.length()));
+	fwrite(str.data(), 1, str.length(), fp);
+}
+
+// Loads the pack directories which were read during the last startup. The cache is machine local, so everything is
+// stored in native byte order.
+static void cf_load_pack_index_cache()
+{
+	Pack_index_cache.clear();
+	Pack_index_cache_changed = false;
+	Pack_index_cache_hits = 0;
+	Pack_index_cache_lookups = 0;
+
+	if (Cmdline_rebuild_file_cache) {
+		mprintf(("Rebuilding the pack index cache.\n"));
+		Pack_index_cache_changed = true;
+		return;
+	}
+
+	SCP_string cache_path;
+	cf_create_default_path_string(cache_path, CF_TYPE_CACHE, CF_PACK_INDEX_CACHE_FILE, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+
+	FILE *fp = fopen(cache_path.c_str(), "rb");
+
+	if ( !fp ) {
+		Pack_index_cache_changed = true;
+		return;
+	}
+
+	uint id = 0, version = 0, pathtypes_hash = 0, num_packs = 0;
+	bool ok = cf_cache_read(fp, &id) && cf_cache_read(fp, &version) && cf_cache_read(fp, &pathtypes_hash) && cf_cache_read(fp, &num_packs);
+
+	ok = ok && (id == CF_PACK_INDEX_CACHE_ID) && (version == CF_PACK_INDEX_CACHE_VERSION) && (pathtypes_hash == cf_get_pathtypes_hash());
+
+	for (uint i = 0; ok && (i < num_packs); ++i) {
+		SCP_string pack_path;
+		cf_pack_index index;
+		uint num_files = 0;
+
+		ok = cf_cache_read(fp, &pack_path) && cf_cache_read(fp, &index.m_time) && cf_cache_read(fp, &index.size) && cf_cache_read(fp, &num_files);
+
+		// every entry takes up more than 16 bytes, which rules out absurd counts before they get allocated
+		ok = ok && (static_cast<int64_t>(num_files) <= index.size / 16);
+
+		if ( !ok ) {
+			break;
+		}
+
+		index.files.resize(num_files);
+
+		for (auto &file : index.files) {
+			int64_t m_time = 0;
+			uint64_t size = 0;
+
+			ok = cf_cache_read(fp, &file.name) && cf_cache_read(fp, &file.sub_path) && cf_cache_read(fp, &m_time)
+				&& cf_cache_read(fp, &size) && cf_cache_read(fp, &file.pathtype) && cf_cache_read(fp, &file.offset);
+
+			ok = ok && CF_TYPE_SPECIFIED(file.pathtype);
+
+			if ( !ok ) {
+				break;
+			}
+
+			file.m_time = static_cast<time_t>(m_time);
+			file.size = static_cast<size_t>(size);
+		}
+
+		Pack_index_cache[pack_path] = std::move(index);
+	}
+
+	fclose(fp);
+
+	if ( !ok ) {
+		mprintf(("Pack index cache '%s' is invalid or outdated, ignoring it.\n", cache_path.c_str()));
+		Pack_index_cache.clear();
+		Pack_index_cache_changed = true;
+	}
+}
+
+static void cf_save_pack_index_cache()
+{
+	// forget about packs which have been removed
+	for (auto it = Pack_index_cache.begin(); it != Pack_index_cache.end(); ) {
+		int64_t m_time, size;
+
+		if ( !cf_get_pack_stat(it->first, &m_time, &size) ) {
+			it = Pack_index_cache.erase(it);
+			Pack_index_cache_changed = true;
+		} else {
+			++it;
+		}
+	}
+
+	if ( !Pack_index_cache_changed ) {
+		return;
+	}
+
+	cf_create_directory(CF_TYPE_CACHE, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+
+	SCP_string cache_path;
+	cf_create_default_path_string(cache_path, CF_TYPE_CACHE, CF_PACK_INDEX_CACHE_FILE, CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT);
+
+	// write to a temporary file first so that an interrupted write, or another instance starting up at the same time,
+	// can't leave a partial cache behind
+	SCP_string temp_path = cache_path + ".tmp";
+
+	FILE *fp = fopen(temp_path.c_str(), "wb");
+
+	if ( !fp ) {
+		mprintf(("Could not write pack index cache '%s'!\n", temp_path.c_str()));
+		return;
+	}
+
+	cf_cache_write(fp, static_cast<uint>(CF_PACK_INDEX_CACHE_ID));
+	cf_cache_write(fp, static_cast<uint>(CF_PACK_INDEX_CACHE_VERSION));
+	cf_cache_write(fp, cf_get_pathtypes_hash());
+	cf_cache_write(fp, static_cast<uint>(Pack_index_cache.size()));
+
+	for (auto &entry : Pack_index_cache) {
+		cf_cache_write(fp, entry.first);
+		cf_cache_write(fp, entry.second.m_time);
+		cf_cache_write(fp, entry.second.size);
+		cf_cache_write(fp, static_cast<uint>(entry.second.files.size()));
+
+		for (auto &file : entry.second.files) {
+			cf_cache_write(fp, file.name);
+			cf_cache_write(fp, file.sub_path);
+			cf_cache_write(fp, static_cast<int64_t>(file.m_time));
+			cf_cache_write(fp, static_cast<uint64_t>(file.size));
+			cf_cache_write(fp, file.pathtype);
+			cf_cache_write(fp, file.offset);
+		}
+	}
+
+	bool ok = (ferror(fp) == 0);
+	ok = (fclose(fp) == 0) && ok;
+
+	if (ok) {
+		// rename() won't replace an existing file on Windows
+		remove(cache_path.c_str());
+		ok = (rename(temp_path.c_str(), cache_path.c_str()) == 0);
 	}
 
-	std::sort(files.begin(), files.end(), sort_file_list);
+	if ( !ok ) {
+		mprintf(("Could not write pack index cache '%s'!\n", cache_path.c_str()));
+		remove(temp_path.c_str());
+	}
+}
 
+static int cf_add_pack_files(const int root_index, const SCP_vector<_file_list_t> &files)
+{
 	for (auto &file : files) {
 		check_file_shadows(root_index, file.pathtype, file.name, file.sub_path);
 
@@ -970,41 +1289,44 @@ static int cf_add_pack_files(const int root_index, SCP_vector<_file_list_t> &fil
 	return static_cast<int>(files.size());
 }
 
-void cf_search_root_pack(int root_index)
+// Files of one pathtype get sorted before they are added to the file list
+static void cf_add_pack_file_group(SCP_vector<_file_list_t> &group, SCP_vector<_file_list_t> &files)
 {
-	int num_files = 0;
-	cf_root *root = cf_get_root(root_index);
+	std::sort(group.begin(), group.end(), sort_file_list);
 
-	Assert( root != NULL );
+	files.insert(files.end(), std::make_move_iterator(group.begin()), std::make_move_iterator(group.end()));
+	group.clear();
+}
 
+// Reads the directory of a pack file. The files are returned in the order they go into the file list.
+static bool cf_read_pack_index(const SCP_string &pack_path, SCP_vector<_file_list_t> &files)
+{
 	// Open data		
-	FILE *fp = fopen( root->path.c_str(), "rb" );
+	FILE *fp = fopen( pack_path.c_str(), "rb" );
 	// Read the file header
 	if (!fp) {
-		return;
+		return false;
 	}
 
 	if ( filelength(fileno(fp)) < (int)(sizeof(VP_FILE_HEADER) + (sizeof(int) * 3)) ) {
-		mprintf(( "Skipping VP file ('%s') of invalid size...\n", root->path.c_str() ));
+		mprintf(( "Skipping VP file ('%s') of invalid size...\n", pack_path.c_str() ));
 		fclose(fp);
-		return;
+		return false;
 	}
 
 	VP_FILE_HEADER VP_header;
 
 	Assert( sizeof(VP_header) == 16 );
 	if (fread(&VP_header, sizeof(VP_header), 1, fp) != 1) {
-		mprintf(("Skipping VP file ('%s') because the header could not be read...\n", root->path.c_str()));
+		mprintf(("Skipping VP file ('%s') because the header could not be read...\n", pack_path.c_str()));
 		fclose(fp);
-		return;
+		return false;
 	}
 
 	VP_header.version = INTEL_INT( VP_header.version ); //-V570
 	VP_header.index_offset = INTEL_INT( VP_header.index_offset ); //-V570
 	VP_header.num_files = INTEL_INT( VP_header.num_files ); //-V570
 
-	mprintf(( "Searching root pack '%s' ... ", root->path.c_str() ));
-
 	// Read index info
 	fseek(fp, VP_header.index_offset, SEEK_SET);
 
@@ -1013,9 +1335,9 @@ void cf_search_root_pack(int root_index)
 	SCP_string sub_path;
 	int path_type = CF_TYPE_INVALID;
 
-	SCP_vector<_file_list_t> files;
+	SCP_vector<_file_list_t> group;
 
-	files.reserve(256);		// should be set to a good baseline of files per path
+	group.reserve(256);		// should be set to a good baseline of files per path
 
 	// Go through all the files
 	int i;
@@ -1053,8 +1375,7 @@ void cf_search_root_pack(int root_index)
 
 			// if the pathtype root changed then add all of the files
 			if (rval != path_type) {
-				num_files += cf_add_pack_files(root_index, files);
-				files.clear();
+				cf_add_pack_file_group(group, files);
 			}
 
 			path_type = rval;
@@ -1083,7 +1404,7 @@ void cf_search_root_pack(int root_index)
 						file.pathtype = path_type;
 						file.offset = find.offset;
 
-						files.push_back(file);
+						group.push_back(file);
 
 						//mprintf(( "Found pack file '%s'\n", find.filename ));
 					}
@@ -1093,11 +1414,56 @@ void cf_search_root_pack(int root_index)
 	}
 
 	// add final set of files
-	num_files += cf_add_pack_files(root_index, files);
-	files.clear();
+	cf_add_pack_file_group(group, files);
 
 	fclose(fp);
 
+	return true;
+}
+
+void cf_search_root_pack(int root_index)
+{
+	cf_root *root = cf_get_root(root_index);
+
+	Assert( root != NULL );
+
+	mprintf(( "Searching root pack '%s' ... ", root->path.c_str() ));
+
+	int64_t m_time = 0, size = 0;
+	bool have_stat = cf_get_pack_stat(root->path, &m_time, &size);
+
+	++Pack_index_cache_lookups;
+
+	if (have_stat) {
+		auto cached = Pack_index_cache.find(root->path);
+
+		if ( (cached != Pack_index_cache.end()) && (cached->second.m_time == m_time) && (cached->second.size == size) ) {
+			++Pack_index_cache_hits;
+
+			mprintf(( "%i files (cached)\n", cf_add_pack_files(root_index, cached->second.files) ));
+			return;
+		}
+	}
+
+	SCP_vector<_file_list_t> files;
+
+	if ( !cf_read_pack_index(root->path, files) ) {
+		mprintf(( "0 files\n" ));
+		return;
+	}
+
+	int num_files = cf_add_pack_files(root_index, files);
+
+	if (have_stat) {
+		auto &cached = Pack_index_cache[root->path];
+
+		cached.m_time = m_time;
+		cached.size = size;
+		cached.files = std::move(files);
+
+		Pack_index_cache_changed = true;
+	}
+
 	mprintf(( "%i files\n", num_files ));
 }
 
@@ -1144,6 +1510,30 @@ void cf_search_memory_root(int root_index) {
 	mprintf(( "%i files\n", num_files ));
 }
 
+static void cf_build_file_index()
+{
+	File_index.clear();
+	File_index.reserve(Num_files);
+
+	for (uint i = 0; i < Num_files; ++i) {
+		File_index[cf_get_file(i)->name_ext].push_back(i);
+	}
+}
+
+// Returns the indices of all files with the given name and extension in list order, or nullptr if there are none
+static const SCP_vector<uint> *cf_find_file_indices(const SCP_string &name_ext)
+{
+	auto it = File_index.find(name_ext);
+
+	if (it == File_index.end()) {
+		return nullptr;
+	}
+
+	return &it->second;
+}
+
+static void cf_benchmark_file_lookups();
+
 void cf_build_file_list()
 {
 	int i;
@@ -1162,6 +1552,8 @@ void cf_build_file_list()
 		}
 	}
 
+	cf_build_file_index();
+
 #ifndef NDEBUG
 	// if some special/critical files might be shadowed then make sure the user knows about it
 	if ( !critical_shadowed.empty() && !running_unittests ) {
@@ -1189,14 +1581,70 @@ void cf_build_secondary_filelist(const char *cdrom_dir)
 	cf_free_secondary_filelist();
 
 	mprintf(( "Building file index...\n" ));
+
+	auto start_time = timer_get_microseconds();
 	
 	// build the list of searchable roots
 	cf_build_root_list(cdrom_dir);	
 
+	auto roots_time = timer_get_microseconds();
+
 	// build the list of files themselves
+	cf_load_pack_index_cache();
 	cf_build_file_list();
+	cf_save_pack_index_cache();
+
+	// only needed while the file list gets built
+	Pack_index_cache.clear();
+
+	auto files_time = timer_get_microseconds();
 
 	mprintf(( "Found %d roots and %d files.\n", Num_roots, Num_files ));
+	mprintf(( "Building the file index took %d ms (roots: %d ms, files: %d ms), %d of %d packs were in the index cache.\n",
+		static_cast<int>((files_time - start_time) / MICROSECONDS_PER_MILLISECOND), static_cast<int>((roots_time - start_time) / MICROSECONDS_PER_MILLISECOND),
+		static_cast<int>((files_time - roots_time) / MICROSECONDS_PER_MILLISECOND), Pack_index_cache_hits, Pack_index_cache_lookups ));
+
+	if (Cmdline_benchmark_mode) {
+		cf_benchmark_file_lookups();
+	}
+}
+
+const ubyte *cf_get_pack_mapping(int root_index, size_t *size)
+{
+	// Mapping a whole mod's worth of packs could easily exhaust the address space of a 32-bit process
+	if (sizeof(void *) < 8) {
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> guard(Pack_mapping_mutex);
+
+	if (root_index < 0 || root_index >= Num_roots) {
+		return nullptr;
+	}
+
+	cf_root *root = cf_get_root(root_index);
+
+	if (root->roottype != CF_ROOTTYPE_PACK) {
+		return nullptr;
+	}
+
+	if (!root->mapping_attempted) {
+		root->mapping_attempted = true;
+
+		std::unique_ptr<cf_file_mapping> mapping(new cf_file_mapping());
+		if (mapping->map(root->path.c_str())) {
+			root->mapping = std::move(mapping);
+		} else {
+			mprintf(("Could not map pack file '%s' into memory, reading it through stdio instead.\n", root->path.c_str()));
+		}
+	}
+
+	if (root->mapping == nullptr) {
+		return nullptr;
+	}
+
+	*size = root->mapping->size();
+	return root->mapping->data();
 }
 
 void cf_free_secondary_filelist()
@@ -1208,6 +1656,8 @@ void cf_free_secondary_filelist()
 	// Free the file blocks
 	File_blocks.clear();
 	Num_files = 0;
+
+	File_index.clear();
 }
 
 static bool is_absolute_path(const char *path)
@@ -1380,8 +1830,14 @@ CFileLocation cf_find_file_location(const char* filespec, int pathtype, uint32_t
 	}
 
 	// Search the pak files and CD-ROM.
-	for (ui = 0; ui < Num_files; ui++ )	{
-		cf_file *f = cf_get_file(ui);
+	auto file_indices = cf_find_file_indices(filename);
+
+	if (file_indices == nullptr) {
+		return CFileLocation();
+	}
+
+	for (auto file_index : *file_indices) {
+		cf_file *f = cf_get_file(file_index);
 
 		// only search paths we're supposed to...
 		if ( (pathtype != CF_TYPE_ANY) && (pathtype != f->pathtype_index) )
@@ -1402,40 +1858,36 @@ CFileLocation cf_find_file_location(const char* filespec, int pathtype, uint32_t
 		}
 
 		// file either not localized or localized version not found
-		if ( !stricmp(filename.c_str(), f->name_ext.c_str()) ) {
-			CFileLocation res(true);
-			res.size = static_cast<size_t>(f->size);
-			res.offset = (size_t)f->pack_offset;
-			res.data_ptr = f->data;
-			res.name_ext = f->name_ext;
-			res.m_time = f->write_time;
-
-			if (f->data != nullptr) {
-				// This is an in-memory file so we just copy the pathtype name + file name
-				res.full_name = Pathtypes[f->pathtype_index].path;
-				res.full_name += DIR_SEPARATOR_STR;
-				res.full_name += f->sub_path;
-				res.full_name += f->name_ext;
-			} else if (f->pack_offset < 1) {
-				// This is a real file, return the actual file path
-				res.full_name = f->real_name;
-			} else {
-				// File is in a pack file
-				cf_root *r = cf_get_root(f->root_index);
-
-				res.full_name = r->path;
-			}
+		CFileLocation res(true);
+		res.size = static_cast<size_t>(f->size);
+		res.offset = (size_t)f->pack_offset;
+		res.data_ptr = f->data;
+		res.name_ext = f->name_ext;
+		res.m_time = f->write_time;
+
+		if (f->data != nullptr) {
+			// This is an in-memory file so we just copy the pathtype name + file name
+			res.full_name = Pathtypes[f->pathtype_index].path;
+			res.full_name += DIR_SEPARATOR_STR;
+			res.full_name += f->sub_path;
+			res.full_name += f->name_ext;
+		} else if (f->pack_offset < 1) {
+			// This is a real file, return the actual file path
+			res.full_name = f->real_name;
+		} else {
+			// File is in a pack file
+			cf_root *r = cf_get_root(f->root_index);
 
-			return res;
+			res.full_name = r->path;
+			res.root_index = f->root_index;
 		}
+
+		return res;
 	}
 		
 	return CFileLocation();
 }
 
-// -- from parselo.cpp --
-extern char *stristr(char *str, const char *substr);
-
 /**
  * Searches for a file.
  *
@@ -1561,17 +2013,34 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 
 	// get total length, with extension, which is used to test with later
 	// (FIXME: this assumes that everything in ext_list[] is the same length!)
-	size_t filespec_len_big = filespec.length() + strlen(ext_list[0]);
+	size_t ext_len = strlen(ext_list[0]);
+
+	// gather all files with one of our supported types, in list order
+	SCP_vector<uint> base_matches;
+
+	for (cur_ext = 0; cur_ext < ext_num; cur_ext++) {
+		if (strlen(ext_list[cur_ext]) != ext_len)
+			continue;
+
+		auto file_indices = cf_find_file_indices(filespec + ext_list[cur_ext]);
+
+		if (file_indices != nullptr) {
+			base_matches.insert(base_matches.end(), file_indices->begin(), file_indices->end());
+		}
+	}
+
+	std::sort(base_matches.begin(), base_matches.end());
+	base_matches.erase(std::unique(base_matches.begin(), base_matches.end()), base_matches.end());
 
 	SCP_vector< cf_file* > file_list_index;
 	int last_root_index = -1;
 	int last_path_index = -1;
 
-	file_list_index.reserve( MIN(ext_num * 4, (int)Num_files) );
+	file_list_index.reserve(base_matches.size());
 
 	// next, run though and pick out base matches
-	for (ui = 0; ui < Num_files; ui++) {
-		cf_file *f = cf_get_file(ui);
+	for (auto file_index : base_matches) {
+		cf_file *f = cf_get_file(file_index);
 
 		// ... only search paths that we're supposed to
 		if ( (num_search_dirs == 1) && (pathtype != f->pathtype_index) )
@@ -1582,26 +2051,6 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 			continue;
 		}
 
-		// ... check that our names are the same length (accounting for the missing extension on our own name)
-		if (f->name_ext.length() != filespec_len_big )
-			continue;
-
-		// ... check that we match the base filename
-		if ( strnicmp(f->name_ext.c_str(), filespec.c_str(), filespec.length()) != 0 )
-			continue;
-
-		// ... make sure that it's one of our supported types
-		bool found_one = false;
-		for (cur_ext = 0; cur_ext < ext_num; cur_ext++) {
-			if ( stristr(f->name_ext.c_str(), ext_list[cur_ext]) ) {
-				found_one = true;
-				break;
-			}
-		}
-
-		if ( !found_one )
-			continue;
-
 		// ... we check based on location, so if location changes after the first find then bail
 		if (last_root_index == -1) {
 			last_root_index = f->root_index;
@@ -1649,6 +2098,7 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 					cf_root *r = cf_get_root(f->root_index);
 
 					res.full_name = r->path;
+					res.root_index = f->root_index;
 				}
 
 				// found it, so cleanup and return
@@ -1663,6 +2113,65 @@ CFileLocationExt cf_find_file_location_ext(const char *filename, const int ext_n
 }
 
 
+// Compares name lookups through the file index against walking the whole file list, which is how lookups used to be
+// done. Only run in benchmark mode.
+static void cf_benchmark_file_lookups()
+{
+	if (Num_files == 0) {
+		return;
+	}
+
+	// A spread of names from the list, plus some which don't exist since failed lookups are common too
+	const uint num_names = MIN(Num_files, 1000u);
+	SCP_vector<SCP_string> names;
+
+	for (uint i = 0; i < num_names; ++i) {
+		names.push_back(cf_get_file(static_cast<int>(static_cast<uint64_t>(i) * Num_files / num_names))->name_ext);
+
+		if (i % 4 == 0) {
+			names.push_back("cf_benchmark_missing_" + std::to_string(i) + ".dds");
+		}
+	}
+
+	size_t found_linear = 0;
+	auto start = timer_get_microseconds();
+
+	for (const auto &name : names) {
+		for (uint i = 0; i < Num_files; ++i) {
+			if ( !stricmp(name.c_str(), cf_get_file(i)->name_ext.c_str()) ) {
+				++found_linear;
+				break;
+			}
+		}
+	}
+
+	auto linear_time = timer_get_microseconds() - start;
+
+	// indexed lookups are too fast to time them just once
+	const int INDEXED_ROUNDS = 100;
+	size_t found_indexed = 0;
+	start = timer_get_microseconds();
+
+	for (int round = 0; round < INDEXED_ROUNDS; ++round) {
+		for (const auto &name : names) {
+			if (cf_find_file_indices(name) != nullptr) {
+				++found_indexed;
+			}
+		}
+	}
+
+	auto indexed_time = timer_get_microseconds() - start;
+
+	Assertion(found_indexed == found_linear * INDEXED_ROUNDS, "File index found " SIZE_T_ARG " files, but the file list has " SIZE_T_ARG "!", found_indexed / INDEXED_ROUNDS, found_linear);
+
+	auto lookups_per_second = [](size_t lookups, uint64_t microseconds) {
+		return static_cast<double>(lookups) * MICROSECONDS_PER_SECOND / static_cast<double>(MAX(microseconds, (uint64_t)1));
+	};
+
+	mprintf(("File lookup benchmark (%u files): linear scan %.0f lookups/sec, file index %.0f lookups/sec\n", Num_files,
+		lookups_per_second(names.size(), linear_time), lookups_per_second(names.size() * INDEXED_ROUNDS, indexed_time)));
+}
+
 // Returns true if filename matches filespec, else zero if not
 int cf_matches_spec(const char *filespec, const char *filename)
 {
@@ -18,6 +18,35 @@
 void cf_build_secondary_filelist( const char *cdrom_path );
 void cf_free_secondary_filelist();
 
+// A file mapped into memory as a whole, read only
+class cf_file_mapping {
+	const ubyte *m_data = nullptr;
+	size_t m_size = 0;
+
+#ifdef _WIN32
+	// the file and mapping handles, nullptr if not open
+	void *m_file = nullptr;
+	void *m_mapping = nullptr;
+#endif
+
+  public:
+	cf_file_mapping() = default;
+	~cf_file_mapping();
+
+	cf_file_mapping(const cf_file_mapping &) = delete;
+	cf_file_mapping &operator=(const cf_file_mapping &) = delete;
+
+	// Maps the file with the given full path, returns false if it doesn't exist, is empty or can't be mapped
+	bool map(const char *path);
+
+	const ubyte *data() const { return m_data; }
+	size_t size() const { return m_size; }
+};
+
+// Returns the contents of the pack file of the given root mapped into memory and stores its size in size, or returns nullptr
+// if the pack can't be mapped. A pack is mapped the first time it is asked for and stays mapped until the file list is freed.
+const ubyte *cf_get_pack_mapping(int root_index, size_t *size);
+
 // Internal stuff
 typedef struct cf_pathtype {
 	int			index;					// To verify that the CF_TYPE define is correctly indexed into this array
@@ -49,8 +49,9 @@ void SpawnShipCheat::runCheat() {
 			if (objnum < 0)
 				return;
 			
-			ship *shipp = &Ships[Objects[objnum].instance];
-			shipp->ship_name[0] = '\0';
+			int shipnum = Objects[objnum].instance;
+			ship *shipp = &Ships[shipnum];
+			ship_rename(shipnum, "");
 			shipp->display_name.clear();
 			for (size_t j = 0; j < Player_orders.size(); j++)
 				shipp->orders_accepted.insert(j);
@@ -62,7 +63,7 @@ void SpawnShipCheat::runCheat() {
 				sprintf(name, "%s %d", shipName.c_str(), ship_idx);
 				if ( (ship_name_lookup(name) == -1) && (ship_find_exited_ship_by_name(name) == -1) )
 				{
-					strcpy_s(shipp->ship_name, name);
+					ship_rename(shipnum, name);
 					break;
 				}
 
@@ -200,6 +200,7 @@ Flag exe_params[] =
 	{ "-nosound",			"Disable all sound",						false,	0,									EASY_DEFAULT,					"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nosound", },
 	{ "-nomusic",			"Disable music",							false,	0,									EASY_DEFAULT,					"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-nomusic", },
 	{ "-no_enhanced_sound",	"Disable enhanced sound",					false,	0,									EASY_DEFAULT,					"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-no_enhanced_sound", },
+	{ "-sound_cache",		"Cache decoded sounds on disk",				true,	0,									EASY_DEFAULT,					"Audio",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-sound_cache", },
 
 	//flag					launcher text								FSO		on_flags							off_flags						category		reference URL
 	{ "-portable_mode",		"Store config in portable location",		false,	0,									EASY_DEFAULT,					"Launcher",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-portable_mode", },
@@ -245,6 +246,8 @@ Flag exe_params[] =
 
 	//flag					launcher text								FSO		on_flags							off_flags						category		reference URL
 	{ "-voicer",			"Enable voice recognition",					true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-voicer", },
+	{ "-parallel_particles",	"Process particle sources on all threads",	true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-parallel_particles", },
+	{ "-parallel_ai",		"Decide AI targets on all threads",			true,	0,									EASY_DEFAULT,					"Experimental",	"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-parallel_ai", },
 
 	//flag					launcher text								FSO		on_flags							off_flags						category		reference URL
 	{ "-override_data",		"Enable override directory",				false,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-override_data", },
@@ -265,12 +268,15 @@ Flag exe_params[] =
 	{ "-controlconfig_tbl",	"Save control presets to table",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-controlconfig_tbl", },
 	{ "-save_render_target",	"Save render targets to file",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-save_render_target", },
 	{ "-verify_vps",		"Spew VP CRCs to vp_crcs.txt",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-verify_vps", },
+	{ "-rebuild_file_cache",	"Rebuild the cached VP file index",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-rebuild_file_cache", },
 	{ "-reparse_mainhall",	"Reparse mainhall.tbl when loading halls",	false,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-reparse_mainhall", },
 	{ "-noninteractive",	"Disables interactive dialogs",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-noninteractive", },
 	{ "-benchmark_mode",	"Puts the game into benchmark mode",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-benchmark_mode", },
 	{ "-profile_frame_time","Profile frame time",						true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_frame_time", },
 	{ "-profile_write_file", "Write profiling information to file",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-profile_write_file", },
 	{ "-json_profiling",	"Generate JSON profiling output",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-json_profiling", },
+	{ "-frame_telemetry",	"Write frame time percentiles to file",		true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-frame_telemetry", },
+	{ "-check_ai_targets", "Check targets chosen with -parallel_ai",	true,	0,								EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-check_ai_targets", },
 	{ "-debug_window",		"Enable the debug window",					true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-debug_window", },
 	{ "-gr_debug",		"Output graphics debug information",			true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-gr_debug", },
 	{ "-stdout_log",		"Output log file to stdout",				true,	0,									EASY_DEFAULT,					"Dev Tool",		"http://www.hard-light.net/wiki/index.php/Command-Line_Reference#-stdout_log", },
@@ -412,9 +418,11 @@ bool Cmdline_enable_vr = false;
 
 // Audio related
 cmdline_parm voice_recognition_arg("-voicer", NULL, AT_NONE);	// Cmdline_voice_recognition
+cmdline_parm sound_cache_arg("-sound_cache", NULL, AT_NONE);	// Cmdline_sound_cache
 
 int Cmdline_voice_recognition = 0;
 int Cmdline_no_enhanced_sound = 0;
+bool Cmdline_sound_cache = false;
 
 // MOD related
 cmdline_parm mod_arg("-mod", "List of folders to overwrite/add-to the default data", AT_STRING, true);	// Cmdline_mod  -- DTP modsupport
@@ -514,6 +522,7 @@ cmdline_parm render_res_arg("-render_res", "Resolution, formatted like 1600x900"
 cmdline_parm window_res_arg("-window_res", "Window resolution, formatted like 1600x900.", AT_STRING);
 cmdline_parm center_res_arg("-center_res", "Resolution of center monitor, formatted like 1600x900", AT_STRING);
 cmdline_parm verify_vps_arg("-verify_vps", NULL, AT_NONE);	// Cmdline_verify_vps  -- spew VP crcs to vp_crcs.txt
+cmdline_parm rebuild_file_cache_arg("-rebuild_file_cache", NULL, AT_NONE);	// Cmdline_rebuild_file_cache
 cmdline_parm parse_cmdline_only(PARSE_COMMAND_LINE_STRING, "Ignore any cmdline_fso.cfg files", AT_NONE);
 cmdline_parm reparse_mainhall_arg("-reparse_mainhall", NULL, AT_NONE); //Cmdline_reparse_mainhall
 cmdline_parm frame_profile_write_file("-profile_write_file", NULL, AT_NONE); // Cmdline_profile_write_file
@@ -523,6 +532,7 @@ cmdline_parm benchmark_mode_arg("-benchmark_mode", NULL, AT_NONE); //Cmdline_ben
 cmdline_parm pilot_arg("-pilot", nullptr, AT_STRING); //Cmdline_pilot
 cmdline_parm noninteractive_arg("-noninteractive", NULL, AT_NONE); //Cmdline_noninteractive
 cmdline_parm json_profiling("-json_profiling", NULL, AT_NONE); //Cmdline_json_profiling
+cmdline_parm frame_telemetry_arg("-frame_telemetry", NULL, AT_NONE); //Cmdline_frame_telemetry
 cmdline_parm show_video_info("-show_video_info", NULL, AT_NONE); //Cmdline_show_video_info
 cmdline_parm frame_profile_arg("-profile_frame_time", NULL, AT_NONE); //Cmdline_frame_profile
 cmdline_parm debug_window_arg("-debug_window", NULL, AT_NONE);	// Cmdline_debug_window
@@ -535,6 +545,9 @@ cmdline_parm override_arg("-override_data", "Enable override directory", AT_NONE
 cmdline_parm imgui_debug_arg("-imgui_debug", nullptr, AT_NONE);
 cmdline_parm vulkan("-vulkan", nullptr, AT_NONE);
 cmdline_parm multithreading("-threads", nullptr, AT_INT);
+cmdline_parm parallel_particles_arg("-parallel_particles", nullptr, AT_NONE);	// Cmdline_parallel_particles
+cmdline_parm parallel_ai_arg("-parallel_ai", nullptr, AT_NONE);	// Cmdline_parallel_ai
+cmdline_parm check_ai_targets_arg("-check_ai_targets", nullptr, AT_NONE);	// Cmdline_check_ai_targets
 
 char *Cmdline_start_mission = NULL;
 int Cmdline_dis_collisions = 0;
@@ -555,6 +568,7 @@ std::optional<std::pair<uint16_t, uint16_t>>Cmdline_window_res = std::nullopt;
 char *Cmdline_res = 0;
 char *Cmdline_center_res = 0;
 int Cmdline_verify_vps = 0;
+bool Cmdline_rebuild_file_cache = false;
 int Cmdline_reparse_mainhall = 0;
 bool Cmdline_profile_write_file = false;
 bool Cmdline_no_unfocus_pause = false;
@@ -563,6 +577,7 @@ bool Cmdline_benchmark_mode = false;
 const char *Cmdline_pilot = nullptr;
 bool Cmdline_noninteractive = false;
 bool Cmdline_json_profiling = false;
+bool Cmdline_frame_telemetry = false;
 bool Cmdline_frame_profile = false;
 bool Cmdline_show_video_info = false;
 bool Cmdline_debug_window = false;
@@ -574,6 +589,9 @@ bool Cmdline_override_data = false;
 bool Cmdline_show_imgui_debug = false;
 bool Cmdline_vulkan = false;
 int Cmdline_multithreading = 1;
+bool Cmdline_parallel_particles = false;
+bool Cmdline_parallel_ai = false;
+bool Cmdline_check_ai_targets = false;
 
 // Other
 cmdline_parm get_flags_arg(GET_FLAGS_STRING, "Output the launcher flags file", AT_STRING);
@@ -1681,6 +1699,11 @@ bool SetCmdlineParams()
 		Cmdline_no_enhanced_sound = 1;
 	}
 
+	// keep the decoded game sounds in the cache directory
+	if (sound_cache_arg.found()) {
+		Cmdline_sound_cache = true;
+	}
+
 	// should we start a network game
 	if ( startgame_arg.found() ) {
 		Cmdline_use_last_pilot = 1;
@@ -2175,6 +2198,9 @@ bool SetCmdlineParams()
 	if ( verify_vps_arg.found() )
 		Cmdline_verify_vps = 1;
 
+	if ( rebuild_file_cache_arg.found() )
+		Cmdline_rebuild_file_cache = true;
+
 	if ( no3dsound_arg.found() )
 		Cmdline_no_3d_sound = 1;
 
@@ -2294,6 +2320,11 @@ bool SetCmdlineParams()
 		Cmdline_json_profiling = true;
 	}
 
+	if (frame_telemetry_arg.found())
+	{
+		Cmdline_frame_telemetry = true;
+	}
+
 	if (frame_profile_arg.found() )
 	{
 		Cmdline_frame_profile = true;
@@ -2413,6 +2444,18 @@ bool SetCmdlineParams()
 		Cmdline_multithreading = abs(multithreading.get_int());
 	}
 
+	if (parallel_particles_arg.found()) {
+		Cmdline_parallel_particles = true;
+	}
+
+	if (parallel_ai_arg.found()) {
+		Cmdline_parallel_ai = true;
+	}
+
+	if (check_ai_targets_arg.found()) {
+		Cmdline_check_ai_targets = true;
+	}
+
 	return true; 
 }
 
@@ -89,6 +89,7 @@ extern bool Cmdline_enable_vr;
 // Audio related
 extern int Cmdline_voice_recognition;
 extern int Cmdline_no_enhanced_sound;
+extern bool Cmdline_sound_cache;
 
 // MOD related
 extern char *Cmdline_mod;	 // DTP for mod support
@@ -141,6 +142,7 @@ extern int Cmdline_show_pos;
 extern int Cmdline_show_stats;
 extern int Cmdline_save_render_targets;
 extern int Cmdline_verify_vps;
+extern bool Cmdline_rebuild_file_cache;
 extern int Cmdline_reparse_mainhall;
 extern bool Cmdline_profile_write_file;
 extern bool Cmdline_no_unfocus_pause;
@@ -149,6 +151,7 @@ extern bool Cmdline_benchmark_mode;
 extern const char *Cmdline_pilot;
 extern bool Cmdline_noninteractive;
 extern bool Cmdline_json_profiling;
+extern bool Cmdline_frame_telemetry;
 extern bool Cmdline_frame_profile;
 extern bool Cmdline_show_video_info;
 extern bool Cmdline_debug_window;
@@ -160,6 +163,9 @@ extern bool Cmdline_override_data;
 extern bool Cmdline_show_imgui_debug;
 extern bool Cmdline_vulkan;
 extern int Cmdline_multithreading;
+extern bool Cmdline_parallel_particles;
+extern bool Cmdline_parallel_ai;
+extern bool Cmdline_check_ai_targets;
 
 enum class WeaponSpewType { NONE = 0, STANDARD, ALL };
 extern WeaponSpewType Cmdline_spew_weapon_stats;
@@ -406,9 +406,6 @@ Done:
 	return retval;
 }
 
-static void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
-static uint32_t BLOCK_SIZE = 0;
-
 //reads pixel info from a dds file
 int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 {
@@ -453,11 +450,16 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		cfread(data, 1, (int)size, cfp);
 	} else {
 		// Compression format not supported, convert to BGRA
-		ubyte *comp_data = (ubyte*)vm_malloc(size);
-
-		cfread(comp_data, 1, (int)size, cfp);
+		// If the file is in memory (e.g. in a mapped pack file) it can be decoded from there, otherwise read it in first
+		ubyte *comp_data = nullptr;
+		auto src = reinterpret_cast<const ubyte*>(cf_borrow_data(cfp, size));
+
+		if (src == nullptr) {
+			comp_data = (ubyte*)vm_malloc(size);
+			cfread(comp_data, 1, (int)size, cfp);
+			src = comp_data;
+		}
 
-		ubyte *src = comp_data;
 		ubyte *dst = data;
 
 		uint d_width, d_height, d_depth;
@@ -470,6 +472,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 		const int num_faces = (dds_header.dwCaps2 & DDSCAPS2_CUBEMAP) ? 6 : 1;
 		const bool has_depth = (dds_header.dwFlags & DDSD_DEPTH) == DDSD_DEPTH;
 
+		// kept local since bitmaps may be read on several threads at once
+		void (*decompress_dds)(const void *in, void *out, int pitch) = nullptr;
+		uint32_t BLOCK_SIZE = 0;
+
 		switch (dds_header.ddspf.dwFourCC) {
 			case FOURCC_DX10:
 				decompress_dds = bcdec_bc7;
@@ -488,8 +494,15 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 				BLOCK_SIZE = BCDEC_BC2_BLOCK_SIZE;
 				break;
 			default:
-				Error(LOCATION, "Invalid FourCC (%d) for DDS decompression!", dds_header.ddspf.dwFourCC);
-				break;
+				// may be called on a worker thread, so leave the error to the caller
+				mprintf(("DDS ERROR: Invalid FourCC (%d) for decompression of '%s'!\n", dds_header.ddspf.dwFourCC, real_name));
+
+				if (comp_data != nullptr) {
+					vm_free(comp_data);
+				}
+
+				cfclose(cfp);
+				return DDS_ERROR_INVALID_FORMAT;
 		}
 
 		for (int f = 0; f < num_faces; ++f) {
@@ -531,8 +544,10 @@ int dds_read_bitmap(const char *filename, ubyte *data, ubyte *bpp, int cf_type)
 			}
 		}
 
-		vm_free(comp_data);
-		comp_data = nullptr;
+		if (comp_data != nullptr) {
+			vm_free(comp_data);
+			comp_data = nullptr;
+		}
 
 		// switch to uncompressed format and reset vars (needed below to get correct bit count)
 		dds_header.ddspf.dwFlags &= ~DDPF_FOURCC;
@@ -585,6 +585,27 @@ void gamesnd_load_gameplay_sounds()
 			}
 		}
 	}
+
+	// everything which has been queued is either loaded now or not needed
+	snd_discard_queued_loads();
+}
+
+/**
+ * Start decoding the sounds loaded by gamesnd_preload_common_sounds() and gamesnd_load_gameplay_sounds() on the worker
+ * threads, so that the mission can be loaded in the meantime
+ */
+void gamesnd_queue_mission_sounds()
+{
+	if ( !Sound_enabled )
+		return;
+
+	for (auto& gs: Snds) {
+		for (auto& entry : gs.sound_entries) {
+			if (entry.filename[0] != 0 && strnicmp(entry.filename, NOX("none.wav"), 4) != 0) {
+				snd_queue_load(&entry, gs.flags);
+			}
+		}
+	}
 }
 
 /**
@@ -592,6 +613,9 @@ void gamesnd_load_gameplay_sounds()
  */
 void gamesnd_unload_gameplay_sounds()
 {
+	// in case the mission is closed before its sounds have been loaded
+	snd_discard_queued_loads();
+
 	Assert( Snds.size() <= INT_MAX );
 	for (auto& gs: Snds) {
 		for (auto& entry : gs.sound_entries) {
@@ -365,6 +365,7 @@ void gamesnd_load_gameplay_sounds();
 void gamesnd_unload_gameplay_sounds();
 void gamesnd_load_interface_sounds();
 void gamesnd_unload_interface_sounds();
+void gamesnd_queue_mission_sounds();
 void gamesnd_preload_common_sounds();
 void gamesnd_load_gameplay_sounds();
 void gamesnd_unload_gameplay_sounds();
@@ -45,12 +45,13 @@ typedef struct {
 } cfile_source_mgr;
 
 typedef cfile_source_mgr *cfile_src_ptr;
-struct jpeg_decompress_struct jpeg_info;
-struct jpeg_error_mgr jpeg_err;
+// per thread, so that bmpman can decode several images at once
+static thread_local struct jpeg_decompress_struct jpeg_info;
+static thread_local struct jpeg_error_mgr jpeg_err;
 
 #define INPUT_BUF_SIZE  4096	// choose an efficiently read'able size
 
-static int jpeg_error_code;
+static thread_local int jpeg_error_code;
 
 // set current error
 #define Jpeg_Set_Error(x)	{ jpeg_error_code = x; }
@@ -91,6 +92,16 @@ void jpg_output_message(j_common_ptr cinfo)
 #endif
 }
 
+// message handler for reads which must not pop up dialogs, e.g. on worker threads
+void jpg_log_message(j_common_ptr cinfo)
+{
+	char buffer[JMSG_LENGTH_MAX];
+
+	(*cinfo->err->format_message) (cinfo, buffer);
+
+	mprintf(("JPEG Error: %s\n", buffer));
+}
+
 
 
 // Reads header information from the JPEG file into the bitmap pointer
@@ -162,10 +173,11 @@ int jpeg_read_header(const char *real_filename, CFILE *img_cfp, int *w, int *h,
 // 
 // filename - name of the targa file to load
 // image_data - allocated storage for the bitmap
+// quiet - only log errors instead of warning about them
 //
 // returns - true if succesful, false otherwise
 //
-int jpeg_read_bitmap(const char *real_filename, ubyte *image_data, ubyte * /*palette*/, int dest_size, int cf_type)
+int jpeg_read_bitmap(const char *real_filename, ubyte *image_data, ubyte * /*palette*/, int dest_size, int cf_type, bool quiet)
 {
 	char filename[MAX_FILENAME_LEN];
 	CFILE *img_cfp = NULL;
@@ -188,7 +200,7 @@ int jpeg_read_bitmap(const char *real_filename, ubyte *image_data, ubyte * /*pal
 	// initialize error message handler
 	jpeg_info.err = jpeg_std_error(&jpeg_err);
 	jpeg_err.error_exit = jpg_error_exit;
-	jpeg_err.output_message = jpg_output_message;
+	jpeg_err.output_message = quiet ? jpg_log_message : jpg_output_message;
 
 	// SPECIAL NOTE: we've already allocated memory on the basis of original height, width and bpp
 	// of the image from the header.  DO NOT change any settings that affect output variables here
@@ -0,0 +1,345 @@
+#include "math/fvi_simd.h"
+#include "math/vecmat.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define FVI_SIMD_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FVI_SIMD_SSE
+#endif
+
+#include <cmath>
+
+namespace {
+
+// Triangles are marked if the hit point is at most this far outside of them, in barycentric coordinates
+const float BARYCENTRIC_TOLERANCE = 1e-3f;
+
+// Triangles this close to degenerate (relative to their size) are always marked, since the exact test may still hit
+// them if it happens to take its other code path.
+const float DEGENERATE_TOLERANCE = 1e-6f;
+
+// Ray parameters this far outside of the allowed range are still marked
+const float RAY_T_TOLERANCE = 1e-4f;
+
+// fvi_polyedge_sphereline() treats edge hits up to 0.05 before the start of the sphere's path as hits at the start,
+// so the path gets extended backwards by a bit more than that.
+const float SPHERE_START_EXTENSION = 0.06f;
+
+// Extra distance added to the sphere radius on top of the polygon's non-planarity
+const float SPHERE_RADIUS_TOLERANCE = 1e-3f;
+
+// Each of these provides the same set of operations on a number of float lanes. The kernels below are written once
+// against this interface, so the vectorized and scalar versions perform the same operations in the same order.
+
+struct scalar_lanes {
+	using vec = float;
+	using mask = bool;
+	static constexpr size_t width = 1;
+
+	static vec load(const float *p) { return *p; }
+	static vec set1(float f) { return f; }
+	static vec add(vec a, vec b) { return a + b; }
+	static vec sub(vec a, vec b) { return a - b; }
+	static vec mul(vec a, vec b) { return a * b; }
+	static vec div(vec a, vec b) { return a / b; }
+	static vec min(vec a, vec b) { return a < b ? a : b; }
+	static vec max(vec a, vec b) { return a > b ? a : b; }
+	static vec abs(vec a) { return std::fabs(a); }
+	static mask lt(vec a, vec b) { return a < b; }
+	static mask le(vec a, vec b) { return a <= b; }
+	static mask gt(vec a, vec b) { return a > b; }
+	static mask ge(vec a, vec b) { return a >= b; }
+	static mask mask_and(mask a, mask b) { return a && b; }
+	static mask mask_or(mask a, mask b) { return a || b; }
+	static mask mask_not(mask a) { return !a; }
+	static int bits(mask m) { return m ? 1 : 0; }
+};
+
+#if defined(FVI_SIMD_SSE)
+struct sse_lanes {
+	using vec = __m128;
+	using mask = __m128;
+	static constexpr size_t width = 4;
+
+	static vec load(const float *p) { return _mm_loadu_ps(p); }
+	static vec set1(float f) { return _mm_set1_ps(f); }
+	static vec add(vec a, vec b) { return _mm_add_ps(a, b); }
+	static vec sub(vec a, vec b) { return _mm_sub_ps(a, b); }
+	static vec mul(vec a, vec b) { return _mm_mul_ps(a, b); }
+	static vec div(vec a, vec b) { return _mm_div_ps(a, b); }
+	static vec min(vec a, vec b) { return _mm_min_ps(a, b); }
+	static vec max(vec a, vec b) { return _mm_max_ps(a, b); }
+	static vec abs(vec a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+	static mask lt(vec a, vec b) { return _mm_cmplt_ps(a, b); }
+	static mask le(vec a, vec b) { return _mm_cmple_ps(a, b); }
+	static mask gt(vec a, vec b) { return _mm_cmpgt_ps(a, b); }
+	static mask ge(vec a, vec b) { return _mm_cmpge_ps(a, b); }
+	static mask mask_and(mask a, mask b) { return _mm_and_ps(a, b); }
+	static mask mask_or(mask a, mask b) { return _mm_or_ps(a, b); }
+	static mask mask_not(mask a) { return _mm_xor_ps(a, _mm_castsi128_ps(_mm_set1_epi32(-1))); }
+	static int bits(mask m) { return _mm_movemask_ps(m); }
+};
+using simd_lanes = sse_lanes;
+#elif defined(FVI_SIMD_AVX)
+struct avx_lanes {
+	using vec = __m256;
+	using mask = __m256;
+	static constexpr size_t width = 8;
+
+	static vec load(const float *p) { return _mm256_loadu_ps(p); }
+	static vec set1(float f) { return _mm256_set1_ps(f); }
+	static vec add(vec a, vec b) { return _mm256_add_ps(a, b); }
+	static vec sub(vec a, vec b) { return _mm256_sub_ps(a, b); }
+	static vec mul(vec a, vec b) { return _mm256_mul_ps(a, b); }
+	static vec div(vec a, vec b) { return _mm256_div_ps(a, b); }
+	static vec min(vec a, vec b) { return _mm256_min_ps(a, b); }
+	static vec max(vec a, vec b) { return _mm256_max_ps(a, b); }
+	static vec abs(vec a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+	static mask lt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+	static mask le(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+	static mask gt(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+	static mask ge(vec a, vec b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+	static mask mask_and(mask a, mask b) { return _mm256_and_ps(a, b); }
+	static mask mask_or(mask a, mask b) { return _mm256_or_ps(a, b); }
+	static mask mask_not(mask a) { return _mm256_xor_ps(a, _mm256_castsi256_ps(_mm256_set1_epi32(-1))); }
+	static int bits(mask m) { return _mm256_movemask_ps(m); }
+};
+using simd_lanes = avx_lanes;
+#else
+using simd_lanes = scalar_lanes;
+#endif
+
+static_assert(simd_lanes::width <= FVI_SIMD_MAX_WIDTH, "The triangle arrays aren't padded enough for this instruction set!");
+
+template <typename L>
+struct lane_vec3 {
+	typename L::vec x, y, z;
+
+	static lane_vec3 load(const SCP_vector<float> (&v)[3], size_t i) { return {L::load(&v[0][i]), L::load(&v[1][i]), L::load(&v[2][i])}; }
+	static lane_vec3 set1(const vec3d *v) { return {L::set1(v->xyz.x), L::set1(v->xyz.y), L::set1(v->xyz.z)}; }
+
+	lane_vec3 operator-(const lane_vec3 &other) const { return {L::sub(x, other.x), L::sub(y, other.y), L::sub(z, other.z)}; }
+	lane_vec3 operator+(const lane_vec3 &other) const { return {L::add(x, other.x), L::add(y, other.y), L::add(z, other.z)}; }
+	lane_vec3 scale(typename L::vec s) const { return {L::mul(x, s), L::mul(y, s), L::mul(z, s)}; }
+
+	typename L::vec dot(const lane_vec3 &other) const
+	{
+		return L::add(L::add(L::mul(x, other.x), L::mul(y, other.y)), L::mul(z, other.z));
+	}
+};
+
+template <typename L>
+void store_hits(typename L::mask hit, size_t i, size_t first, size_t last, ubyte *hits)
+{
+	int bits = L::bits(hit);
+	for (size_t lane = 0; lane < L::width && i + lane < last; ++lane) {
+		hits[i + lane - first] = (ubyte)((bits >> lane) & 1);
+	}
+}
+
+template <typename L>
+void ray_tris_kernel(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float max_dist, ubyte *hits)
+{
+	using vec = typename L::vec;
+	using mask = typename L::mask;
+	using vec3 = lane_vec3<L>;
+
+	const vec3 origin = vec3::set1(p0);
+	const vec3 dir = vec3::set1(pdir);
+
+	const vec t_min = L::set1(-RAY_T_TOLERANCE);
+	const vec t_max = L::set1(max_dist + RAY_T_TOLERANCE * (1.0f + max_dist));
+	const vec bary_min = L::set1(-BARYCENTRIC_TOLERANCE);
+	const vec bary_max = L::set1(1.0f + BARYCENTRIC_TOLERANCE);
+	const vec degenerate = L::set1(DEGENERATE_TOLERANCE);
+
+	for (size_t i = first; i < last; i += L::width) {
+		const vec3 v0 = vec3::load(tris.v0, i);
+		const vec3 norm = vec3::load(tris.norm, i);
+		const vec3 axis_u = vec3::load(tris.axis_u, i);
+		const vec3 axis_v = vec3::load(tris.axis_v, i);
+
+		// Intersect with the polygon's plane, the same way fvi_ray_plane() does
+		vec t = L::div(norm.dot(v0 - origin), norm.dot(dir));
+		mask in_range = L::mask_and(L::ge(t, t_min), L::le(t, t_max));
+
+		// Project everything relative to v0 into 2d, the same way fvi_point_face() does
+		const vec3 hit = (origin + dir.scale(t)) - v0;
+		const vec3 e1 = vec3::load(tris.v1, i) - v0;
+		const vec3 e2 = vec3::load(tris.v2, i) - v0;
+
+		vec hit_u = hit.dot(axis_u);
+		vec hit_v = hit.dot(axis_v);
+		vec u1 = e1.dot(axis_u);
+		vec v1 = e1.dot(axis_v);
+		vec u2 = e2.dot(axis_u);
+		vec v2 = e2.dot(axis_v);
+
+		vec cross_a = L::mul(u1, v2);
+		vec cross_b = L::mul(u2, v1);
+		vec det = L::sub(cross_a, cross_b);
+
+		vec alpha = L::div(L::sub(L::mul(hit_u, v2), L::mul(u2, hit_v)), det);
+		vec beta = L::div(L::sub(L::mul(u1, hit_v), L::mul(hit_u, v1)), det);
+
+		mask inside = L::mask_and(L::mask_and(L::ge(alpha, bary_min), L::ge(beta, bary_min)), L::le(L::add(alpha, beta), bary_max));
+		mask is_degenerate = L::le(L::abs(det), L::mul(degenerate, L::add(L::abs(cross_a), L::abs(cross_b))));
+
+		store_hits<L>(L::mask_and(in_range, L::mask_or(inside, is_degenerate)), i, first, last, hits);
+	}
+}
+
+template <typename L>
+void sphereline_tris_kernel(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float radius, ubyte *hits)
+{
+	using vec = typename L::vec;
+	using mask = typename L::mask;
+	using vec3 = lane_vec3<L>;
+
+	vec3d start_pos, end_pos;
+	vm_vec_scale_add(&start_pos, p0, pdir, -SPHERE_START_EXTENSION);
+	vm_vec_add(&end_pos, p0, pdir);
+
+	const vec3 start = vec3::set1(&start_pos);
+	const vec3 end = vec3::set1(&end_pos);
+
+	const vec3 path_min = {L::min(start.x, end.x), L::min(start.y, end.y), L::min(start.z, end.z)};
+	const vec3 path_max = {L::max(start.x, end.x), L::max(start.y, end.y), L::max(start.z, end.z)};
+
+	const vec base_radius = L::set1(radius * (1.0f + SPHERE_RADIUS_TOLERANCE) + SPHERE_RADIUS_TOLERANCE);
+	const vec two = L::set1(2.0f);
+
+	for (size_t i = first; i < last; i += L::width) {
+		const vec3 v0 = vec3::load(tris.v0, i);
+		const vec3 v1 = vec3::load(tris.v1, i);
+		const vec3 v2 = vec3::load(tris.v2, i);
+		const vec3 norm = vec3::load(tris.norm, i);
+
+		// Face hits are found on the polygon's plane rather than the triangle's, so account for the difference twice
+		vec r = L::add(base_radius, L::mul(two, L::load(&tris.slack[i])));
+		vec neg_r = L::sub(L::set1(0.0f), r);
+
+		// Both ends of the path on the same side of the plane and further away than the radius means no contact
+		vec dist_start = norm.dot(start - v0);
+		vec dist_end = norm.dot(end - v0);
+		mask separated = L::mask_or(L::mask_and(L::gt(dist_start, r), L::gt(dist_end, r)),
+		                           L::mask_and(L::lt(dist_start, neg_r), L::lt(dist_end, neg_r)));
+
+		// Same for the bounding box of the path grown by the radius against the triangle's bounding box
+		const vec3 tri_min = {L::min(L::min(v0.x, v1.x), v2.x), L::min(L::min(v0.y, v1.y), v2.y), L::min(L::min(v0.z, v1.z), v2.z)};
+		const vec3 tri_max = {L::max(L::max(v0.x, v1.x), v2.x), L::max(L::max(v0.y, v1.y), v2.y), L::max(L::max(v0.z, v1.z), v2.z)};
+
+		separated = L::mask_or(separated, L::lt(L::add(path_max.x, r), tri_min.x));
+		separated = L::mask_or(separated, L::lt(L::add(path_max.y, r), tri_min.y));
+		separated = L::mask_or(separated, L::lt(L::add(path_max.z, r), tri_min.z));
+		separated = L::mask_or(separated, L::gt(L::sub(path_min.x, r), tri_max.x));
+		separated = L::mask_or(separated, L::gt(L::sub(path_min.y, r), tri_max.y));
+		separated = L::mask_or(separated, L::gt(L::sub(path_min.z, r), tri_max.z));
+
+		// Inverted, so that NaNs from broken geometry end up as possible hits
+		store_hits<L>(L::mask_not(separated), i, first, last, hits);
+	}
+}
+
+} // namespace
+
+void fvi_tri_soa::clear()
+{
+	for (int i = 0; i < 3; ++i) {
+		v0[i].clear();
+		v1[i].clear();
+		v2[i].clear();
+		norm[i].clear();
+		axis_u[i].clear();
+		axis_v[i].clear();
+	}
+	slack.clear();
+
+	count = 0;
+}
+
+size_t fvi_tri_soa::add(const vec3d *p0, const vec3d *p1, const vec3d *p2, const vec3d *plane_norm)
+{
+	// Pick the same projection as fvi_point_face(), by dropping the largest component of the normal. The order of the
+	// remaining two doesn't matter, since barycentric coordinates don't depend on it.
+	float x = fl_abs(plane_norm->xyz.x);
+	float y = fl_abs(plane_norm->xyz.y);
+	float z = fl_abs(plane_norm->xyz.z);
+
+	int dropped;
+	if (x > y) {
+		dropped = (x > z) ? 0 : 2;
+	} else {
+		dropped = (y > z) ? 1 : 2;
+	}
+
+	for (int i = 0; i < 3; ++i) {
+		v0[i].push_back(p0->a1d[i]);
+		v1[i].push_back(p1->a1d[i]);
+		v2[i].push_back(p2->a1d[i]);
+		norm[i].push_back(plane_norm->a1d[i]);
+		axis_u[i].push_back(i == (dropped + 1) % 3 ? 1.0f : 0.0f);
+		axis_v[i].push_back(i == (dropped + 2) % 3 ? 1.0f : 0.0f);
+	}
+
+	vec3d e1, e2;
+	vm_vec_sub(&e1, p1, p0);
+	vm_vec_sub(&e2, p2, p0);
+	slack.push_back(std::max(fl_abs(vm_vec_dot(&e1, plane_norm)), fl_abs(vm_vec_dot(&e2, plane_norm))));
+
+	return count++;
+}
+
+void fvi_tri_soa::finish()
+{
+	// Pad with zeroes so that a full width load starting at any triangle stays inside the arrays. The kernels ignore
+	// everything past the last triangle they were asked about.
+	size_t padded = count + FVI_SIMD_MAX_WIDTH;
+
+	for (int i = 0; i < 3; ++i) {
+		v0[i].resize(padded, 0.0f);
+		v1[i].resize(padded, 0.0f);
+		v2[i].resize(padded, 0.0f);
+		norm[i].resize(padded, 0.0f);
+		axis_u[i].resize(padded, 0.0f);
+		axis_v[i].resize(padded, 0.0f);
+	}
+	slack.resize(padded, 0.0f);
+}
+
+void fvi_ray_tris(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float max_dist, ubyte *hits)
+{
+	Assertion(last <= tris.count && tris.slack.size() >= tris.count + FVI_SIMD_MAX_WIDTH, "fvi_tri_soa::finish() has not been called, or the triangle range is invalid!");
+
+	ray_tris_kernel<simd_lanes>(tris, first, last, p0, pdir, max_dist, hits);
+}
+
+void fvi_sphereline_tris(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float radius, ubyte *hits)
+{
+	Assertion(last <= tris.count && tris.slack.size() >= tris.count + FVI_SIMD_MAX_WIDTH, "fvi_tri_soa::finish() has not been called, or the triangle range is invalid!");
+
+	sphereline_tris_kernel<simd_lanes>(tris, first, last, p0, pdir, radius, hits);
+}
+
+void fvi_ray_tris_scalar(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float max_dist, ubyte *hits)
+{
+	ray_tris_kernel<scalar_lanes>(tris, first, last, p0, pdir, max_dist, hits);
+}
+
+void fvi_sphereline_tris_scalar(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float radius, ubyte *hits)
+{
+	sphereline_tris_kernel<scalar_lanes>(tris, first, last, p0, pdir, radius, hits);
+}
+
+const char *fvi_simd_instruction_set()
+{
+#if defined(FVI_SIMD_AVX)
+	return "AVX";
+#elif defined(FVI_SIMD_SSE)
+	return "SSE2";
+#else
+	return "none";
+#endif
+}
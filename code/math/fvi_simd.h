@@ -0,0 +1,53 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+// Bulk versions of the ray/face and sphere/face tests in fvi.h.
+//
+// These test a whole run of triangles at once, using SSE or AVX if the build targets those instruction sets and plain
+// floats otherwise. They are meant as a conservative first pass: a triangle which is not marked can't possibly be
+// hit, while a marked triangle still has to go through the exact tests (fvi_ray_plane()/fvi_point_face() and
+// fvi_sphere_plane()/fvi_polyedge_sphereline()). Because of this, all tolerances err on the side of marking too much.
+
+// The largest number of triangles tested in one go, the triangle arrays are padded to allow loads of this size
+constexpr size_t FVI_SIMD_MAX_WIDTH = 8;
+
+// A list of triangles in structure of arrays layout.
+//
+// Each triangle belongs to a (possibly non-planar) polygon which has been split into a fan, and is tested the same way
+// fvi_point_face() tests the polygon: against the polygon's plane, projected onto the polygon's dominant axis.
+struct fvi_tri_soa {
+	SCP_vector<float> v0[3];		// The first vertex of the polygon. All triangles of a fan share this.
+	SCP_vector<float> v1[3];
+	SCP_vector<float> v2[3];
+	SCP_vector<float> norm[3];		// The plane normal of the polygon
+	SCP_vector<float> axis_u[3];	// Unit vectors picking the two coordinates fvi_point_face() projects onto
+	SCP_vector<float> axis_v[3];
+	SCP_vector<float> slack;		// How far v1 and v2 are off the polygon's plane
+
+	size_t count = 0;
+
+	void clear();
+
+	// Adds the triangle v0, v1, v2 of a polygon with the given plane normal. Returns the index of the triangle.
+	size_t add(const vec3d *v0, const vec3d *v1, const vec3d *v2, const vec3d *norm);
+
+	// Needs to be called once all triangles have been added, and before the triangles are tested
+	void finish();
+};
+
+// Marks the triangles in [first, last) which the ray starting at p0 in direction pdir may hit.
+// The ray parameter is only considered up to max_dist, so pass 1.0f for the segment p0 to p0 + pdir and FLT_MAX for an
+// infinite ray. hits[i - first] is set to 1 for triangles which may be hit and 0 for all others.
+void fvi_ray_tris(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float max_dist, ubyte *hits);
+
+// Marks the triangles in [first, last) which a sphere of the given radius moving from p0 to p0 + pdir may touch.
+// hits[i - first] is set to 1 for triangles which may be touched and 0 for all others.
+void fvi_sphereline_tris(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float radius, ubyte *hits);
+
+// Same as above, but always one triangle at a time. These are what the vectorized versions are checked against.
+void fvi_ray_tris_scalar(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float max_dist, ubyte *hits);
+void fvi_sphereline_tris_scalar(const fvi_tri_soa &tris, size_t first, size_t last, const vec3d *p0, const vec3d *pdir, float radius, ubyte *hits);
+
+// The name of the instruction set the bulk tests have been compiled for
+const char *fvi_simd_instruction_set();
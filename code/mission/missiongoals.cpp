@@ -32,8 +32,10 @@
 #include "network/stand_gui.h"
 #include "parse/parselo.h"
 #include "parse/sexp.h"
+#include "parse/sexp/sexp_program.h"
 #include "playerman/player.h"
 #include "scripting/global_hooks.h"
+#include "ship/ship.h"
 #include "tracing/tracing.h"
 #include "ui/ui.h"
 
@@ -178,6 +180,49 @@ TIMESTAMP Mission_goal_timestamp;
 
 SCP_vector<mission_event> Mission_events;
 SCP_vector<mission_goal> Mission_goals;		// structure for the goals of this mission
+static SCP_vector<sexp::SEXPProgram> Mission_event_programs;	// compiled formulas, in the same order as Mission_events
+
+using event_dependency = sexp::SEXPProgram::Dependency;
+
+// the part of a wing the objective operators look at
+struct event_wing_state {
+	int num_waves;
+	int current_wave;
+	int total_arrived_count;
+	int current_count;
+	bool gone;
+
+	bool operator==(const event_wing_state &other) const
+	{
+		return num_waves == other.num_waves && current_wave == other.current_wave && total_arrived_count == other.total_arrived_count
+			&& current_count == other.current_count && gone == other.gone;
+	}
+};
+
+// What the condition of a schedulable event read the last time it was evaluated to false, see mission_event_is_unchanged.
+// Only the ships, wings, variables and events named in the condition are kept, so checking whether an idle event has to
+// run again doesn't depend on how big the mission is.
+struct event_schedule {
+	bool valid = false;
+	int result = 0;
+	int root_value = SEXP_UNKNOWN;
+	int directive_count = 0;
+	bool assume_current = true;
+	fix next_time_change = INT_MAX;
+
+	size_t log_entries = 0;
+	size_t num_registry_entries = 0;
+	int num_wings = 0;
+	SCP_vector<std::pair<int, ShipStatus>> ships;			// registry index, status
+	SCP_vector<std::pair<int, event_wing_state>> wings;		// wing index, state
+	SCP_vector<std::pair<int, SCP_string>> variables;		// variable index, value
+	SCP_vector<std::pair<int, std::pair<int, bool>>> events;	// event index, result and whether it is done
+};
+static SCP_vector<event_schedule> Mission_event_schedules;	// in the same order as Mission_events
+
+bool Mission_event_scheduling = true;	// whether idle events are skipped until what their condition reads changes
+DCF_BOOL(mission_event_scheduling, Mission_event_scheduling);
+
 static goal_text Goal_text;
 
 SCP_vector<event_annotation> Event_annotations;
@@ -367,12 +412,180 @@ void mission_goals_and_events_init()
 {
 	Mission_goals.clear();
 	Mission_events.clear();
+	Mission_event_programs.clear();
+	Mission_event_schedules.clear();
 
 	Mission_goal_timestamp = _timestamp(GOAL_TIMESTAMP);
 	Mission_directive_sound_timestamp = TIMESTAMP::invalid();
 	Mission_directive_special_timestamp = TIMESTAMP::invalid();		// need to make invalid right away
 }
 
+// compiles the formulas of all events, called once the mission has been loaded and its sexps have been checked
+void mission_events_compile()
+{
+	size_t num_instructions = 0, num_tree_instructions = 0;
+
+	Mission_event_programs.clear();
+	Mission_event_programs.reserve(Mission_events.size());
+
+	for (const auto &mevent : Mission_events) {
+		Mission_event_programs.push_back(sexp::SEXPProgram::compile(mevent.formula));
+
+		num_instructions += Mission_event_programs.back().getNumInstructions();
+		num_tree_instructions += Mission_event_programs.back().getNumTreeInstructions();
+	}
+
+	nprintf(("SEXP", "Compiled %d event formulas into " SIZE_T_ARG " instructions, " SIZE_T_ARG " of which are evaluated by eval_sexp\n",
+		(int)Mission_events.size(), num_instructions, num_tree_instructions));
+
+	Mission_event_schedules.clear();
+	Mission_event_schedules.resize(Mission_events.size());
+}
+
+static event_wing_state mission_event_get_wing_state(int wingnum)
+{
+	auto wingp = &Wings[wingnum];
+	return { wingp->num_waves, wingp->current_wave, wingp->total_arrived_count, wingp->current_count, wingp->flags[Ship::Wing_Flags::Gone] };
+}
+
+// remembers the entries of the state the condition of an event has just read
+static void mission_event_store_state(const sexp::SEXPProgram &program, event_schedule &schedule)
+{
+	const auto &dependencies = program.getDependencies();
+
+	schedule.ships.clear();
+	schedule.wings.clear();
+	schedule.variables.clear();
+	schedule.events.clear();
+
+	if (dependencies[event_dependency::MissionLog]) {
+		schedule.log_entries = mission_log_get_num_entries();
+	}
+
+	if (dependencies[event_dependency::Ships]) {
+		// ships and wings which don't exist yet can only turn up in a bigger registry or wing list
+		schedule.num_registry_entries = Ship_registry.size();
+		schedule.num_wings = Num_wings;
+
+		for (int node : program.getDependencyNodes(event_dependency::Ships)) {
+			auto name = CTEXT(node);
+
+			int entry = ship_registry_get_index(name);
+			if (entry >= 0) {
+				schedule.ships.emplace_back(entry, Ship_registry[entry].status);
+			}
+
+			int wingnum = wing_name_lookup(name, 1);
+			if (wingnum >= 0) {
+				schedule.wings.emplace_back(wingnum, mission_event_get_wing_state(wingnum));
+			}
+		}
+	}
+
+	if (dependencies[event_dependency::Variables]) {
+		for (int node : program.getDependencyNodes(event_dependency::Variables)) {
+			int index = sexp_get_variable_index(node);
+			if (index >= 0) {
+				schedule.variables.emplace_back(index, Sexp_variables[index].text);
+			}
+		}
+	}
+
+	if (dependencies[event_dependency::Events]) {
+		for (int node : program.getDependencyNodes(event_dependency::Events)) {
+			int index = mission_event_lookup(CTEXT(node));
+			if (index >= 0) {
+				schedule.events.emplace_back(index, std::make_pair(Mission_events[index].result, (Mission_events[index].flags & MEF_EVENT_IS_DONE) != 0));
+			}
+		}
+	}
+}
+
+// evaluates the formula of a schedulable event and remembers what it read if it turned out false
+static int mission_event_evaluate_scheduled(int event)
+{
+	const auto &program = Mission_event_programs[event];
+	auto &schedule = Mission_event_schedules[event];
+
+	Sexp_next_time_change = INT_MAX;
+	int result = program.evaluate();
+
+	if (result == SEXP_TRUE) {
+		schedule.valid = false;
+		return result;
+	}
+
+	schedule.valid = true;
+	schedule.result = result;
+	schedule.root_value = Sexp_nodes[program.getRoot()].value;
+	schedule.directive_count = Directive_count;
+	schedule.assume_current = Assume_event_is_current;
+	schedule.next_time_change = Sexp_next_time_change;
+
+	// a false condition doesn't run the actions, so this is still the state it has read
+	mission_event_store_state(program, schedule);
+
+	return result;
+}
+
+// whether nothing the condition of a schedulable event depends on has changed since it was evaluated to false, in
+// which case evaluating it again would give the same result and have the same effects
+static bool mission_event_is_unchanged(int event)
+{
+	const auto &program = Mission_event_programs[event];
+	const auto &dependencies = program.getDependencies();
+	const auto &schedule = Mission_event_schedules[event];
+
+	if (!schedule.valid) {
+		return false;
+	}
+
+	// e.g. reset-event flushes the tree
+	if (Sexp_nodes[program.getRoot()].value != schedule.root_value) {
+		return false;
+	}
+
+	if (dependencies[event_dependency::Time] && (Missiontime >= schedule.next_time_change)) {
+		return false;
+	}
+
+	if (dependencies[event_dependency::MissionLog] && (mission_log_get_num_entries() != schedule.log_entries)) {
+		return false;
+	}
+
+	if (dependencies[event_dependency::Ships]) {
+		if ((Ship_registry.size() != schedule.num_registry_entries) || (Num_wings != schedule.num_wings)) {
+			return false;
+		}
+		for (const auto &ship : schedule.ships) {
+			if (Ship_registry[ship.first].status != ship.second) {
+				return false;
+			}
+		}
+		for (const auto &wing : schedule.wings) {
+			if (!(mission_event_get_wing_state(wing.first) == wing.second)) {
+				return false;
+			}
+		}
+	}
+
+	// a variable which names a ship or event would also change which entries the condition reads
+	for (const auto &variable : schedule.variables) {
+		if (variable.second != Sexp_variables[variable.first].text) {
+			return false;
+		}
+	}
+
+	for (const auto &evt : schedule.events) {
+		const auto &other = Mission_events[evt.first];
+		if ((other.result != evt.second.first) || (((other.flags & MEF_EVENT_IS_DONE) != 0) != evt.second.second)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 // called once right before entering the show goals screen to do initializations.
 void mission_show_goals_init()
 {
@@ -973,7 +1186,25 @@ void mission_process_event( int event )
 			Current_event_log_container_buffer = &Mission_events[event].event_log_container_buffer;
 			Current_event_log_argument_buffer = &Mission_events[event].event_log_argument_buffer;
 		}
-		result = eval_sexp(sindex);
+		// the compiled formula is equivalent to the tree, but skips most of the work of finding the operators
+		if (event < (int)Mission_event_programs.size() && Mission_event_programs[event].getRoot() == sindex) {
+			// an event which is waiting for something to happen only has to be evaluated again once it has
+			if (Mission_event_scheduling && Mission_event_programs[event].isSchedulable() && !Log_event) {
+				if (mission_event_is_unchanged(event)) {
+					const auto &schedule = Mission_event_schedules[event];
+					result = schedule.result;
+					Directive_count = schedule.directive_count;
+					Assume_event_is_current = schedule.assume_current;
+				} else {
+					result = mission_event_evaluate_scheduled(event);
+				}
+			} else {
+				Mission_event_schedules[event].valid = false;
+				result = Mission_event_programs[event].evaluate();
+			}
+		} else {
+			result = eval_sexp(sindex);
+		}
 
 		// if the directive count is a special value, deal with that first.  Mark the event as a special
 		// event, and unmark it when the directive is true again.
@@ -131,6 +131,7 @@ extern TIMESTAMP Mission_goal_timestamp;
 extern int Event_index;  // used by sexp code to tell what event it came from
 extern bool Log_event;
 extern bool Snapshot_all_events;
+extern bool Mission_event_scheduling;
 
 
 // only used in FRED
@@ -150,6 +151,7 @@ extern SCP_vector<event_annotation> Event_annotations;
 
 // prototypes
 void mission_goals_and_events_init( void );
+void mission_events_compile();
 void	mission_show_goals_init();
 void	mission_show_goals_close();
 void	mission_show_goals_do_frame(float frametime);	// displays goals on screen
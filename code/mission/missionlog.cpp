@@ -393,6 +393,11 @@ int mission_log_get_time( LogType type, const char *pname, const char *sname, fi
 	return mission_log_get_time_indexed( type, pname, sname, 1, time );
 }
 
+size_t mission_log_get_num_entries()
+{
+	return Log_entries.size();
+}
+
 // determines the number of times the given type of event takes place
 
 int mission_log_get_count( LogType type, const char *pname, const char *sname )
@@ -107,6 +107,9 @@ extern int mission_log_get_time_indexed(LogType type, const char *name, const ch
 // get the number of times an event happened
 extern int mission_log_get_count(LogType type, const char *pname, const char *sname);
 
+// get the number of entries in the log, which only grows during a mission
+extern size_t mission_log_get_num_entries();
+
 // get the team for a log item
 extern int mission_log_color_get_team(int msg_color);
 
@@ -4351,19 +4351,6 @@ p_object *mission_parse_find_parse_object(const char *name)
 	return NULL;
 }
 
-int find_wing_name(char *name)
-{
-	int	i;
-
-	for (i = 0; i < Num_wings; i++)
-	{
-		if (!stricmp(name, Wings[i].name))
-			return i;
-	}
-
-	return -1;
-}
-
 /**
 * @brief						Tries to create a wing of ships
 * @param[inout]	wingp			Pointer to the wing structure of the wing to be created
@@ -4772,7 +4759,7 @@ void parse_wing(mission *pm)
 	required_string("$Name:");
 	stuff_string(wingp->name, F_NAME, NAME_LENGTH);
 
-	wingnum = find_wing_name(wingp->name);
+	wingnum = wing_lookup(wingp->name);
 	if (wingnum != -1)
 		error_display(0, NOX("Redundant wing name: %s\n"), wingp->name);
 	wingnum = Num_wings;
@@ -5113,6 +5100,7 @@ void parse_wings(mission* pm)
 	{
 		Assert(Num_wings < MAX_WINGS);
 		parse_wing(pm);
+		wing_name_index_add(Num_wings);
 		Num_wings++;
 	}
 }
@@ -6733,6 +6721,11 @@ bool post_process_mission(mission *pm)
 		}
 	}
 
+	// events are evaluated every frame, so compile their formulas now that they are known to be valid
+	if (!Fred_running) {
+		mission_events_compile();
+	}
+
 	// multiplayer missions are handled just before mission start
 	if (!(Game_mode & GM_MULTIPLAYER) ){	
 		ai_post_process_mission();
@@ -7064,6 +7057,7 @@ void mission_init(mission *pm)
 	Num_wings = 0;
 	for (int i = 0; i < MAX_WINGS; i++)
 		Wings[i].clear();
+	wing_name_index_clear();
 	
 	Num_reinforcements = 0;
 
@@ -462,6 +462,8 @@ namespace animation {
 
 		float deltaMag = sign * vm_vec_mag(&delta_vec);
 		submodel->current_shift_rate = deltaMag / flFrametime;
+
+		submodel_invalidate_transform(submodel);
 	}
 
 	void ModelAnimationSubmodel::resetPhysicsData(polymodel_instance* pmi) {
@@ -636,6 +638,8 @@ namespace animation {
 		int sign = (vm_vec_dot(&submodel->canonical_offset, &submodel->translation_axis) < 0.0f) ? -1 : 1;
 
 		submodel->cur_offset = sign * vm_vec_mag(&submodel->canonical_offset);
+
+		submodel_invalidate_transform(submodel);
 	}
 
 
@@ -20,11 +20,14 @@
 #include "gamesnd/gamesnd.h"
 #include "graphics/2d.h"
 #include "io/timer.h"
+#include "math/fvi_simd.h"
 #include "model/model_flags.h"
 #include "object/object.h"
 #include "ship/ship_flags.h"
 #include "particle/particle.h"
 
+#include <mutex>
+
 class object;
 class ship_info;
 class model_render_params;
@@ -146,6 +149,8 @@ struct submodel_instance
 	// similarly for translation
 	vec3d	canonical_offset = vmd_zero_vector;
 	vec3d	canonical_prev_offset = vmd_zero_vector;
+	// Bumped by submodel_invalidate_transform() whenever canonical_orient or canonical_offset change
+	uint	transform_version = 0;
 
 	SCP_vector<model_electrical_arc> electrical_arcs;
 
@@ -179,6 +184,19 @@ public:
 	}
 };
 
+// The transform from a submodel's frame into the frame of the whole model, i.e. everything model_instance_local_to_global_point()
+// does before the object's orientation and position are applied: model_pnt = unrotate(submodel_pnt, orient) + offset
+struct submodel_transform
+{
+	matrix	orient = vmd_identity_matrix;
+	vec3d	offset = vmd_zero_vector;
+
+	bool	valid = false;
+	uint	version = 0;			// the transform_version of the submodel instance this was computed from
+	uint	parent_stamp = 0;		// the stamp of the parent's transform this was composed with
+	uint	stamp = 0;				// bumped every time this is recomputed, which invalidates the transforms of the children
+};
+
 // Data specific to a particular instance of a model.
 struct polymodel_instance
 {
@@ -186,6 +204,10 @@ struct polymodel_instance
 	int model_num = -1;						// global model num index, same as polymodel->id
 	submodel_instance *submodel = nullptr;	// array of submodel instances; mirrors the polymodel->submodel array
 
+	// Filled in lazily by model_instance_get_submodel_transform(), which may be called from several threads at once
+	mutable SCP_vector<submodel_transform> submodel_transforms;
+	mutable std::mutex submodel_transforms_mutex;
+
 	std::shared_ptr<model_texture_replace> texture_replace = nullptr;
 
 	int objnum;								// id of the object using this pmi, or -1 if no object (e.g. skybox) 
@@ -405,6 +427,9 @@ struct bsp_collision_tree {
 	vec3d *point_list;
 	SCP_vector<vec3d> poly_centers;
 
+	fvi_tri_soa tris;			// The polygons of all leaves split into triangles, for testing many of them at once
+	SCP_vector<int> leaf_tris;	// The index of the first triangle of each leaf, plus one past the last triangle at the end
+
 	int n_verts;
 	bool used;
 };
@@ -1146,12 +1171,23 @@ extern void submodel_translate(bsp_info *sm, submodel_instance *smi);
 
 void submodel_stepped_translate(model_subsystem *psub, submodel_instance *smi);
 
+// Marks the cached transforms of a submodel and its children as out of date.  The functions above do this already,
+// anything else which writes canonical_orient or canonical_offset has to call it.
+inline void submodel_invalidate_transform(submodel_instance *smi)
+{
+	++smi->transform_version;
+}
+
 // ------- submodel transformations -------
 
 // Goober5000
 // For a submodel, return its overall offset from the main model.
 extern void model_find_submodel_offset(vec3d *outpnt, const polymodel *pm, int sub_model_num);
 
+// Gets the transform from a submodel's frame of reference into the model's, taking into account submodel rotations.
+// The transforms are cached per model instance and only recomputed after the submodel or one of its parents has moved.
+extern void model_instance_get_submodel_transform(matrix *orient, vec3d *offset, const polymodel *pm, const polymodel_instance *pmi, int submodel_num);
+
 // Given a point in a submodel's local frame of reference, transform it to a global frame of reference.
 // If objorient and objpos are supplied, this will be world space; otherwise it will be the model's space.
 extern void model_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, int model_num, int submodel_num, const matrix *objorient = nullptr, const vec3d *objpos = nullptr);
@@ -1372,6 +1408,7 @@ typedef struct mc_info {
 */
 
 int model_collide(mc_info *mc_info_obj);
+
 void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int version);
 
 bsp_collision_tree *model_get_bsp_collision_tree(int tree_index);
@@ -13,8 +13,10 @@
 #define MODEL_LIB
 
 #include "cmdline/cmdline.h"
+#include "debugconsole/console.h"
 #include "graphics/tmapper.h"
 #include "math/fvi.h"
+#include "math/fvi_simd.h"
 #include "math/vecmat.h"
 #include "model/model.h"
 #include "model/modelrender.h"
@@ -26,26 +28,51 @@
 #define TOL		1E-4
 #define DIST_TOL	1.0
 
-// Some global variables that get set by model_collide and are used internally for
-// checking a collision rather than passing a bunch of parameters around. These are
-// not persistant between calls to model_collide
+// Whether the polygons of a BSP leaf are culled in bulk with the fvi_simd.h tests before being checked one by one
+bool Model_collide_bulk_tests = true;
+DCF_BOOL(model_collide_bulk_tests, Model_collide_bulk_tests);
 
-thread_local static mc_info		*Mc;				// The mc_info passed into model_collide
+namespace {
 
-thread_local static polymodel	*Mc_pm;			// The polygon model we're checking
-thread_local static int			Mc_submodel;	// The current submodel we're checking
+// The state of a single model_collide() query. This gets passed around internally instead of a bunch of parameters,
+// and isn't persistant between queries. Since nothing here is global, each thread can reuse its own object for all of
+// its queries, see model_collide().
+class mc_query {
+	mc_info		*m_mc = nullptr;		// The mc_info passed into model_collide
 
-thread_local static polymodel_instance *Mc_pmi;
+	polymodel	*m_pm = nullptr;		// The polygon model we're checking
+	int			m_submodel = -1;		// The current submodel we're checking
 
-thread_local static matrix		Mc_orient;		// A matrix to rotate a world point into the current
-											// submodel's frame of reference.
-thread_local static vec3d		Mc_base;			// A point used along with Mc_orient.
+	polymodel_instance *m_pmi = nullptr;
 
-thread_local static vec3d		Mc_p0;			// The ray origin rotated into the current submodel's frame of reference
-thread_local static vec3d		Mc_p1;			// The ray end rotated into the current submodel's frame of reference
-thread_local static float		Mc_mag;			// The length of the ray
-thread_local static vec3d		Mc_direction;	// A vector from the ray's origin to its end, in the current submodel's frame of reference
+	matrix		m_orient;				// A matrix to rotate a world point into the current
+										// submodel's frame of reference.
+	vec3d		m_base;					// A point used along with m_orient.
 
+	vec3d		m_p0;					// The ray origin rotated into the current submodel's frame of reference
+	vec3d		m_p1;					// The ray end rotated into the current submodel's frame of reference
+	float		m_mag = 0.0f;			// The length of the ray
+	vec3d		m_direction;			// A vector from the ray's origin to its end, in the current submodel's frame of reference
+
+	SCP_vector<ubyte> m_tri_hits;		// Results of the bulk triangle tests for the leaves currently being checked
+
+	int mc_ray_boundingbox(vec3d *min, vec3d *max, vec3d *p0, vec3d *pdir, vec3d *hitpos);
+	void mc_check_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_norm, uv_pair *uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf* bsp_leaf);
+	void mc_check_sphereline_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_norm, uv_pair *uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf *bsp_leaf);
+	void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index);
+	void model_collide_bsp(bsp_collision_tree *tree, int node_index);
+	bool mc_shield_check_common(shield_tri *tri);
+	bool mc_check_sldc(int offset);
+	void mc_check_shield();
+	void mc_check_subobj(int mn);
+
+  public:
+	int collide(mc_info *mc_info_obj);
+};
+
+} // anonymous namespace
+
+// Only used while parsing the collision trees of a model
 thread_local static vec3d 		**Mc_point_list = nullptr;		// A pointer to the current submodel's vertex list
 
 
@@ -77,7 +104,7 @@ void model_collide_allocate_point_list(int n_points)
 // Returns non-zero if vector from p0 to pdir 
 // intersects the bounding box.
 // hitpos could be NULL, so don't fill it if it is.
-int mc_ray_boundingbox( vec3d *min, vec3d *max, vec3d * p0, vec3d *pdir, vec3d *hitpos )
+int mc_query::mc_ray_boundingbox( vec3d *min, vec3d *max, vec3d * p0, vec3d *pdir, vec3d *hitpos )
 {
 
 	vec3d tmp_hitpos;
@@ -86,19 +113,19 @@ int mc_ray_boundingbox( vec3d *min, vec3d *max, vec3d * p0, vec3d *pdir, vec3d *
 	}
 
 
-	if ( Mc->flags & MC_CHECK_SPHERELINE )	{
+	if ( m_mc->flags & MC_CHECK_SPHERELINE )	{
 
 		// In the case of a sphere, just increase the size of the box by the radius 
 		// of the sphere in all directions.
 
 		vec3d sphere_mod_min, sphere_mod_max;
 
-		sphere_mod_min.xyz.x = min->xyz.x - Mc->radius;
-		sphere_mod_max.xyz.x = max->xyz.x + Mc->radius;
-		sphere_mod_min.xyz.y = min->xyz.y - Mc->radius;
-		sphere_mod_max.xyz.y = max->xyz.y + Mc->radius;
-		sphere_mod_min.xyz.z = min->xyz.z - Mc->radius;
-		sphere_mod_max.xyz.z = max->xyz.z + Mc->radius;
+		sphere_mod_min.xyz.x = min->xyz.x - m_mc->radius;
+		sphere_mod_max.xyz.x = max->xyz.x + m_mc->radius;
+		sphere_mod_min.xyz.y = min->xyz.y - m_mc->radius;
+		sphere_mod_max.xyz.y = max->xyz.y + m_mc->radius;
+		sphere_mod_min.xyz.z = min->xyz.z - m_mc->radius;
+		sphere_mod_max.xyz.z = max->xyz.z + m_mc->radius;
 
 		return fvi_ray_boundingbox( &sphere_mod_min, &sphere_mod_max, p0, pdir, hitpos );
 	} else {
@@ -118,9 +145,9 @@ int mc_ray_boundingbox( vec3d *min, vec3d *max, vec3d * p0, vec3d *pdir, vec3d *
 // ntmap -- The tmap index into the model's textures array.
 //
 // detects whether or not a vector has collided with a polygon.  vector points stored in global
-// Mc_p0 and Mc_p1.  Results stored in global mc_info * Mc.
+// m_p0 and m_p1.  Results stored in m_mc.
 
-static void mc_check_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_norm, uv_pair *uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf* bsp_leaf)
+void mc_query::mc_check_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_norm, uv_pair *uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf* bsp_leaf)
 {
 	vec3d	hit_point;
 	float		dist;
@@ -128,60 +155,60 @@ static void mc_check_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_
 
 	// Check to see if poly is facing away from ray.  If so, don't bother
 	// checking it.
-	if (!(Mc->flags & MC_COLLIDE_ALL) && vm_vec_dot(&Mc_direction,plane_norm) > 0.0f)	{
+	if (!(m_mc->flags & MC_COLLIDE_ALL) && vm_vec_dot(&m_direction,plane_norm) > 0.0f)	{
 		return;
 	}
 
 	// Find the intersection of this ray with the plane that the poly
-	dist = fvi_ray_plane(NULL, plane_pnt, plane_norm, &Mc_p0, &Mc_direction, 0.0f);
+	dist = fvi_ray_plane(NULL, plane_pnt, plane_norm, &m_p0, &m_direction, 0.0f);
 
 	if ( dist < 0.0f ) return; // If the ray is behind the plane there is no collision
-	if ( !(Mc->flags & MC_CHECK_RAY) && (dist > 1.0f) ) return; // The ray isn't long enough to intersect the plane
+	if ( !(m_mc->flags & MC_CHECK_RAY) && (dist > 1.0f) ) return; // The ray isn't long enough to intersect the plane
 
 	// If the ray hits, but a closer intersection has already been found, return
-	if (!(Mc->flags & MC_COLLIDE_ALL) && Mc->num_hits && (dist >= Mc->hit_dist ) ) return;
+	if (!(m_mc->flags & MC_COLLIDE_ALL) && m_mc->num_hits && (dist >= m_mc->hit_dist ) ) return;
 
 	// Find the hit point
-	vm_vec_scale_add( &hit_point, &Mc_p0, &Mc_direction, dist );
+	vm_vec_scale_add( &hit_point, &m_p0, &m_direction, dist );
 	
 	// Check to see if the point of intersection is on the plane.  If so, this
 	// also finds the uv's where the ray hit.
 	if ( fvi_point_face(&hit_point, nv, verts, plane_norm, &u,&v, uvl_list ) )	{
-		Mc->hit_dist = dist;
+		m_mc->hit_dist = dist;
 
-		Mc->hit_point = hit_point;
-		Mc->hit_submodel = Mc_submodel;
-		Mc->hit_normal = *plane_norm;
+		m_mc->hit_point = hit_point;
+		m_mc->hit_submodel = m_submodel;
+		m_mc->hit_normal = *plane_norm;
 
-		if (Mc->flags & MC_COLLIDE_ALL) {
-			Mc->hit_points_all.push_back(hit_point);
-			Mc->hit_submodels_all.push_back(Mc_submodel);
+		if (m_mc->flags & MC_COLLIDE_ALL) {
+			m_mc->hit_points_all.push_back(hit_point);
+			m_mc->hit_submodels_all.push_back(m_submodel);
 		}
 
 
 		if ( uvl_list )	{
-			Mc->hit_u = u;
-			Mc->hit_v = v;
+			m_mc->hit_u = u;
+			m_mc->hit_v = v;
 			if ( ntmap < 0 ) {
-				Mc->hit_bitmap = -1;
+				m_mc->hit_bitmap = -1;
 			} else {
-				Mc->hit_bitmap = Mc_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
+				m_mc->hit_bitmap = m_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
 			}
 		}
 		
 		if(ntmap >= 0){
-			Mc->t_poly = poly;
-			Mc->f_poly = NULL;
+			m_mc->t_poly = poly;
+			m_mc->f_poly = NULL;
 		} else {
-			Mc->t_poly = NULL;
-			Mc->f_poly = poly;
+			m_mc->t_poly = NULL;
+			m_mc->f_poly = poly;
 		}
 
-		Mc->bsp_leaf = bsp_leaf;
+		m_mc->bsp_leaf = bsp_leaf;
 
 //		mprintf(( "Bing!\n" ));
 
-		Mc->num_hits++;
+		m_mc->num_hits++;
 	}
 }
 
@@ -193,7 +220,7 @@ static void mc_check_face(int nv, vec3d **verts, vec3d *plane_pnt, vec3d *plane_
 //				plane_pnt	=>		center point in plane (about which radius is measured)
 //				face_rad		=>		radius of face 
 //				plane_norm	=>		normal of face
-static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt, vec3d * plane_norm, uv_pair * uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf *bsp_leaf)
+void mc_query::mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt, vec3d * plane_norm, uv_pair * uvl_list, int ntmap, ubyte *poly, bsp_collision_leaf *bsp_leaf)
 {
 	vec3d	hit_point;
 	float		u, v;
@@ -206,12 +233,12 @@ static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt,
 	// Check to see if poly is facing away from ray.  If so, don't bother
 	// checking it.
 
-	if (!(Mc->flags & MC_COLLIDE_ALL) && vm_vec_dot(&Mc_direction,plane_norm) > 0.0f)	{
+	if (!(m_mc->flags & MC_COLLIDE_ALL) && vm_vec_dot(&m_direction,plane_norm) > 0.0f)	{
 		return;
 	}
 
 	// Find the intersection of this sphere with the plane of the poly
-	if ( !fvi_sphere_plane( &hit_point, &Mc_p0, &Mc_direction, Mc->radius, plane_norm, plane_pnt, &face_t, &delta_t ) ) {
+	if ( !fvi_sphere_plane( &hit_point, &m_p0, &m_direction, m_mc->radius, plane_norm, plane_pnt, &face_t, &delta_t ) ) {
 		return;
 	}
 
@@ -228,7 +255,7 @@ static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt,
 	}
 
 	// If the ray hits, but a closer intersection has already been found, don't check face
-	if (!(Mc->flags & MC_COLLIDE_ALL) && Mc->num_hits && (face_t >= Mc->hit_dist ) ) {
+	if (!(m_mc->flags & MC_COLLIDE_ALL) && m_mc->num_hits && (face_t >= m_mc->hit_dist ) ) {
 		check_face = 0;		// The ray isn't long enough to intersect the plane
 	}
 
@@ -247,43 +274,43 @@ static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt,
 		// If this is within the collision window, check to see if we hit a face
 		if ( fvi_point_face(&hit_point, nv, verts, plane_norm, &u, &v, uvl_list) ) {
 
-			Mc->hit_dist = face_t;		
-			Mc->hit_point = hit_point;
-			Mc->hit_normal = *plane_norm;
-			Mc->hit_submodel = Mc_submodel;			
-			Mc->edge_hit = false;
+			m_mc->hit_dist = face_t;		
+			m_mc->hit_point = hit_point;
+			m_mc->hit_normal = *plane_norm;
+			m_mc->hit_submodel = m_submodel;			
+			m_mc->edge_hit = false;
 
-			if (Mc->flags & MC_COLLIDE_ALL) {
-				Mc->hit_points_all.push_back(hit_point);
-				Mc->hit_submodels_all.push_back(Mc_submodel);
+			if (m_mc->flags & MC_COLLIDE_ALL) {
+				m_mc->hit_points_all.push_back(hit_point);
+				m_mc->hit_submodels_all.push_back(m_submodel);
 			}
 
 			if ( uvl_list )	{
-				Mc->hit_u = u;
-				Mc->hit_v = v;
+				m_mc->hit_u = u;
+				m_mc->hit_v = v;
 				if ( ntmap < 0 ) {
-					Mc->hit_bitmap = -1;
+					m_mc->hit_bitmap = -1;
 				} else {
-					Mc->hit_bitmap = Mc_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
+					m_mc->hit_bitmap = m_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
 				}
 			}
 
 			if(ntmap >= 0){
-				Mc->t_poly = poly;
-				Mc->f_poly = NULL;
+				m_mc->t_poly = poly;
+				m_mc->f_poly = NULL;
 			} else {
-				Mc->t_poly = NULL;
-				Mc->f_poly = poly;
+				m_mc->t_poly = NULL;
+				m_mc->f_poly = poly;
 			}
 
-			Mc->bsp_leaf = bsp_leaf;
+			m_mc->bsp_leaf = bsp_leaf;
 
-			Mc->num_hits++;
+			m_mc->num_hits++;
 			check_edges = 0;
 			/*
-			vm_vec_scale_add( &temp_sphere, &Mc_p0, &Mc_direction, Mc->hit_dist );
+			vm_vec_scale_add( &temp_sphere, &m_p0, &m_direction, m_mc->hit_dist );
 			temp_dist = vm_vec_dist( &temp_sphere, &hit_point );
-			if ( (temp_dist - DIST_TOL > Mc->radius) || (temp_dist + DIST_TOL < Mc->radius) ) {
+			if ( (temp_dist - DIST_TOL > m_mc->radius) || (temp_dist + DIST_TOL < m_mc->radius) ) {
 				// get Andsager
 				//mprintf(("Estimated radius error: Estimate %f, actual %f Mc->radius\n", temp_dist, Mc->radius));
 			}
@@ -304,14 +331,14 @@ static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt,
 		// PUT TEST HERE
 
 		// check each edge to see if we hit, find the closest edge
-		// Mc->hit_dist stores the best edge time of *all* faces
+		// m_mc->hit_dist stores the best edge time of *all* faces
 		float sphere_time;
-		if ( fvi_polyedge_sphereline(&hit_point, &Mc_p0, &Mc_direction, Mc->radius, nv, verts, &sphere_time)) {
+		if ( fvi_polyedge_sphereline(&hit_point, &m_p0, &m_direction, m_mc->radius, nv, verts, &sphere_time)) {
 			Assert( sphere_time >= 0.0f );
 			/*
-			vm_vec_scale_add( &temp_sphere, &Mc_p0, &Mc_direction, sphere_time );
+			vm_vec_scale_add( &temp_sphere, &m_p0, &m_direction, sphere_time );
 			temp_dist = vm_vec_dist( &temp_sphere, &hit_point );
-			if ( (temp_dist - DIST_TOL > Mc->radius) || (temp_dist + DIST_TOL < Mc->radius) ) {
+			if ( (temp_dist - DIST_TOL > m_mc->radius) || (temp_dist + DIST_TOL < m_mc->radius) ) {
 				// get Andsager
 				//mprintf(("Estimated radius error: Estimate %f, actual %f Mc->radius\n", temp_dist, Mc->radius));
 			}
@@ -319,41 +346,41 @@ static void mc_check_sphereline_face( int nv, vec3d ** verts, vec3d * plane_pnt,
 //			Assert( vm_vec_dot( &temp_dir, &Mc_direction ) > 0 );
 			*/
 
-			if ((Mc->flags & MC_COLLIDE_ALL) || (Mc->num_hits==0) || (sphere_time < Mc->hit_dist) ) {
+			if ((m_mc->flags & MC_COLLIDE_ALL) || (m_mc->num_hits==0) || (sphere_time < m_mc->hit_dist) ) {
 				// This is closer than best so far
-				Mc->hit_dist = sphere_time;
-				Mc->hit_point = hit_point;
-				Mc->hit_normal = *plane_norm;
-				Mc->hit_submodel = Mc_submodel;
-				Mc->edge_hit = true;
-
-				if (Mc->flags & MC_COLLIDE_ALL) {
-					Mc->hit_points_all.push_back(hit_point);
-					Mc->hit_submodels_all.push_back(Mc_submodel);
+				m_mc->hit_dist = sphere_time;
+				m_mc->hit_point = hit_point;
+				m_mc->hit_normal = *plane_norm;
+				m_mc->hit_submodel = m_submodel;
+				m_mc->edge_hit = true;
+
+				if (m_mc->flags & MC_COLLIDE_ALL) {
+					m_mc->hit_points_all.push_back(hit_point);
+					m_mc->hit_submodels_all.push_back(m_submodel);
 				}
 
 				if ( ntmap < 0 ) {
-					Mc->hit_bitmap = -1;
+					m_mc->hit_bitmap = -1;
 				} else {
-					Mc->hit_bitmap = Mc_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
+					m_mc->hit_bitmap = m_pm->maps[ntmap].textures[TM_BASE_TYPE].GetTexture();			
 				}
 
 				if(ntmap >= 0){
-					Mc->t_poly = poly;
-					Mc->f_poly = NULL;
+					m_mc->t_poly = poly;
+					m_mc->f_poly = NULL;
 				} else {
-					Mc->t_poly = NULL;
-					Mc->f_poly = poly;
+					m_mc->t_poly = NULL;
+					m_mc->f_poly = poly;
 				}
 
-				Mc->num_hits++;
+				m_mc->num_hits++;
 
 			//	nprintf(("Physics", "edge sphere time: %f, normal: (%f, %f, %f) hit_point: (%f, %f, %f)\n", sphere_time,
 			//		Mc->hit_normal.xyz.x, Mc->hit_normal.xyz.y, Mc->hit_normal.xyz.z,
 			//		hit_point.xyz.x, hit_point.xyz.y, hit_point.xyz.z));
 			} else  {	// Not best so far
-				Assert(Mc->num_hits>0);
-				Mc->num_hits++;
+				Assert(m_mc->num_hits>0);
+				m_mc->num_hits++;
 			}
 		}
 	}
@@ -381,13 +408,38 @@ int model_collide_parse_bsp_defpoints(ubyte * p)
 	return nverts;
 }
 
-void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
+void mc_query::model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 {
 	int i;
 	int tested_leaf = leaf_index;
 	uv_pair uvlist[TMAP_MAX_VERTS];
 	vec3d *points[TMAP_MAX_VERTS];
 
+	// Cull the triangles of all polygons in this leaf at once, so that the exact tests only run on the polygons which
+	// might actually be hit. The polygons of a leaf are stored one after the other, so their triangles are as well.
+	const ubyte *tri_hits = nullptr;
+	size_t first_tri = 0;
+	if ( Model_collide_bulk_tests && !tree->leaf_tris.empty() ) {
+		int last_leaf = leaf_index;
+		while ( tree->leaf_list[last_leaf].next >= 0 ) {
+			Assert( tree->leaf_list[last_leaf].next == last_leaf + 1 );
+			last_leaf = tree->leaf_list[last_leaf].next;
+		}
+
+		first_tri = (size_t)tree->leaf_tris[leaf_index];
+		size_t last_tri = (size_t)tree->leaf_tris[last_leaf + 1];
+
+		m_tri_hits.resize(std::max(m_tri_hits.size(), last_tri - first_tri));
+		if ( m_mc->flags & MC_CHECK_SPHERELINE ) {
+			fvi_sphereline_tris(tree->tris, first_tri, last_tri, &m_p0, &m_direction, m_mc->radius, m_tri_hits.data());
+		} else {
+			float max_dist = (m_mc->flags & MC_CHECK_RAY) ? FLT_MAX : 1.0f;
+			fvi_ray_tris(tree->tris, first_tri, last_tri, &m_p0, &m_direction, max_dist, m_tri_hits.data());
+		}
+
+		tri_hits = m_tri_hits.data();
+	}
+
 	while ( tested_leaf >= 0 ) {
 		bsp_collision_leaf *leaf = &tree->leaf_list[tested_leaf];
 
@@ -396,16 +448,27 @@ void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 		int nv = leaf->num_verts;
 
 		if ( leaf->tmap_num < MAX_MODEL_TEXTURES ) {
-			if ( (!(Mc->flags & MC_CHECK_INVISIBLE_FACES)) && (Mc_pm->maps[leaf->tmap_num].textures[TM_BASE_TYPE].GetTexture() < 0) )	{
+			if ( (!(m_mc->flags & MC_CHECK_INVISIBLE_FACES)) && (m_pm->maps[leaf->tmap_num].textures[TM_BASE_TYPE].GetTexture() < 0) )	{
 				// Don't check invisible polygons.
 				//SUSHI: Unless $collide_invisible is set.
-				if (!(Mc_pm->submodel[Mc_submodel].flags[Model::Submodel_flags::Collide_invisible]))
+				if (!(m_pm->submodel[m_submodel].flags[Model::Submodel_flags::Collide_invisible]))
 					return;
 			}
 		} else {
 			flat_poly = true;
 		}
 
+		if ( tri_hits != nullptr ) {
+			auto leaf_first = tri_hits + (tree->leaf_tris[tested_leaf] - first_tri);
+			auto leaf_last = tri_hits + (tree->leaf_tris[tested_leaf + 1] - first_tri);
+
+			if ( std::find(leaf_first, leaf_last, (ubyte)1) == leaf_last ) {
+				// None of the triangles of this polygon can be hit
+				tested_leaf = leaf->next;
+				continue;
+			}
+		}
+
 		int vert_num;
 		for ( i = 0; i < nv; ++i ) {
 			vert_num = tree->vert_list[vert_start+i].vertnum;
@@ -416,13 +479,13 @@ void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 		}
 
 		if ( flat_poly ) {
-			if ( Mc->flags & MC_CHECK_SPHERELINE ) {
+			if ( m_mc->flags & MC_CHECK_SPHERELINE ) {
 				mc_check_sphereline_face(nv, points, points[0], &leaf->plane_norm, nullptr, -1, nullptr, leaf);
 			} else {
 				mc_check_face(nv, points, points[0], &leaf->plane_norm, nullptr, -1, nullptr, leaf);
 			}
 		} else {
-			if ( Mc->flags & MC_CHECK_SPHERELINE ) {
+			if ( m_mc->flags & MC_CHECK_SPHERELINE ) {
 				mc_check_sphereline_face(nv, points, points[0], &leaf->plane_norm, uvlist, leaf->tmap_num, nullptr, leaf);
 			} else {
 				mc_check_face(nv, points, points[0], &leaf->plane_norm, uvlist, leaf->tmap_num, nullptr, leaf);
@@ -433,7 +496,7 @@ void model_collide_bsp_poly(bsp_collision_tree *tree, int leaf_index)
 	}
 }
 
-void model_collide_bsp(bsp_collision_tree *tree, int node_index)
+void mc_query::model_collide_bsp(bsp_collision_tree *tree, int node_index)
 {
 	if ( tree->node_list == NULL || tree->n_verts <= 0) {
 		return;
@@ -443,8 +506,8 @@ void model_collide_bsp(bsp_collision_tree *tree, int node_index)
 	vec3d hitpos;
 
 	// check the bounding box of this node. if it passes, check left and right children
-	if ( mc_ray_boundingbox( &node->min, &node->max, &Mc_p0, &Mc_direction, &hitpos ) ) {
-		if ( !(Mc->flags & MC_CHECK_RAY) && (vm_vec_dist(&hitpos, &Mc_p0) > Mc_mag) ) {
+	if ( mc_ray_boundingbox( &node->min, &node->max, &m_p0, &m_direction, &hitpos ) ) {
+		if ( !(m_mc->flags & MC_CHECK_RAY) && (vm_vec_dist(&hitpos, &m_p0) > m_mag) ) {
 			// The ray isn't long enough to intersect the bounding box
 			return;
 		}
@@ -809,6 +872,23 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int vers
 
 	tree->n_verts = n_verts;
 
+	// split the polygons of the leaves into triangle fans for the bulk tests. this has to match what fvi_point_face() does.
+	tree->tris.clear();
+	tree->leaf_tris.resize(leaf_buffer.size() + 1);
+
+	for ( i = 0; i < leaf_buffer.size(); ++i ) {
+		auto &leaf = leaf_buffer[i];
+		tree->leaf_tris[i] = (int)tree->tris.count;
+
+		vec3d *first_point = &tree->point_list[vert_buffer[leaf.vert_start].vertnum];
+		for ( int j = 2; j < leaf.num_verts; ++j ) {
+			tree->tris.add(first_point, &tree->point_list[vert_buffer[leaf.vert_start + j - 1].vertnum], &tree->point_list[vert_buffer[leaf.vert_start + j].vertnum], &leaf.plane_norm);
+		}
+	}
+
+	tree->leaf_tris.back() = (int)tree->tris.count;
+	tree->tris.finish();
+
 	// copy node info. this might be a good time to organize the nodes into a cache efficient tree layout.
 	tree->n_nodes = (int)node_buffer.size();
 	tree->node_list = (bsp_collision_node*)vm_malloc(sizeof(bsp_collision_node) * node_buffer.size());
@@ -827,7 +907,7 @@ void model_collide_parse_bsp(bsp_collision_tree *tree, ubyte *bsp_data, int vers
 	vert_buffer.clear();
 }
 
-bool mc_shield_check_common(shield_tri	*tri)
+bool mc_query::mc_shield_check_common(shield_tri	*tri)
 {
 	vec3d * points[3];
 	vec3d hitpoint;
@@ -837,33 +917,33 @@ bool mc_shield_check_common(shield_tri	*tri)
 
 	// Check to see if Mc_pmly is facing away from ray.  If so, don't bother
 	// checking it.
-	if (vm_vec_dot(&Mc_direction,&tri->norm) > 0.0f)	{
+	if (vm_vec_dot(&m_direction,&tri->norm) > 0.0f)	{
 		return false;
 	}
 	// get the vertices in the form the next function wants them
 	for (int j = 0; j < 3; j++ )
-		points[j] = &Mc_pm->shield.verts[tri->verts[j]].pos;
+		points[j] = &m_pm->shield.verts[tri->verts[j]].pos;
 
-	if (!(Mc->flags & MC_CHECK_SPHERELINE) ) {	// Don't do this test for sphere colliding against shields
+	if (!(m_mc->flags & MC_CHECK_SPHERELINE) ) {	// Don't do this test for sphere colliding against shields
 		// Find the intersection of this ray with the plane that the Mc_pmly
 		// lies in
-		dist = fvi_ray_plane(NULL, points[0],&tri->norm,&Mc_p0,&Mc_direction,0.0f);
+		dist = fvi_ray_plane(NULL, points[0],&tri->norm,&m_p0,&m_direction,0.0f);
 
 		if ( dist < 0.0f ) return false; // If the ray is behind the plane there is no collision
-		if ( !(Mc->flags & MC_CHECK_RAY) && (dist > 1.0f) ) return false; // The ray isn't long enough to intersect the plane
+		if ( !(m_mc->flags & MC_CHECK_RAY) && (dist > 1.0f) ) return false; // The ray isn't long enough to intersect the plane
 
 		// Find the hit Mc_pmint
-		vm_vec_scale_add( &hitpoint, &Mc_p0, &Mc_direction, dist );
+		vm_vec_scale_add( &hitpoint, &m_p0, &m_direction, dist );
 	
 		// Check to see if the Mc_pmint of intersection is on the plane.  If so, this
 		// also finds the uv's where the ray hit.
 		if ( fvi_point_face(&hitpoint, 3, points, &tri->norm, NULL,NULL,NULL ) )	{
-			Mc->hit_dist = dist;
-			Mc->shield_hit_tri = (int)(tri - Mc_pm->shield.tris);
-			Mc->hit_point = hitpoint;
-			Mc->hit_normal = tri->norm;
-			Mc->hit_submodel = -1;
-			Mc->num_hits++;
+			m_mc->hit_dist = dist;
+			m_mc->shield_hit_tri = (int)(tri - m_pm->shield.tris);
+			m_mc->hit_point = hitpoint;
+			m_mc->hit_normal = tri->norm;
+			m_mc->hit_submodel = -1;
+			m_mc->num_hits++;
 			return true;		// We hit, so we're done
 		}
 	} else {		// Sphere check against shield
@@ -872,48 +952,48 @@ bool mc_shield_check_common(shield_tri	*tri)
 		// HACK HACK!! The 10000.0 is the face radius, I didn't know this,
 		// so I'm assume 10000 would be as big as ever.
 		mc_check_sphereline_face(3, points, points[0], &tri->norm, NULL, 0, NULL, NULL);
-		if (Mc->num_hits && Mc->hit_dist < sphere_check_closest_shield_dist) {
+		if (m_mc->num_hits && m_mc->hit_dist < sphere_check_closest_shield_dist) {
 
 			// same behavior whether face or edge
 			// normal, edge_hit, hit_point all updated thru sphereline_face
-			sphere_check_closest_shield_dist = Mc->hit_dist;
-			Mc->shield_hit_tri = (int)(tri - Mc_pm->shield.tris);
-			Mc->hit_submodel = -1;
-			Mc->num_hits++;
+			sphere_check_closest_shield_dist = m_mc->hit_dist;
+			m_mc->shield_hit_tri = (int)(tri - m_pm->shield.tris);
+			m_mc->hit_submodel = -1;
+			m_mc->num_hits++;
 			return true;		// We hit, so we're done
 		}
-	} // Mc->flags & MC_CHECK_SPHERELINE else
+	} // m_mc->flags & MC_CHECK_SPHERELINE else
 
 	return false;
 }
 
-bool mc_check_sldc(int offset)
+bool mc_query::mc_check_sldc(int offset)
 {
 	//ShivanSpS - Changed the type char for a type int (Now SLC2)
-	if (offset > Mc_pm->sldc_size - 5) //no way is this big enough
+	if (offset > m_pm->sldc_size - 5) //no way is this big enough
 		return false;
 
-	int* type_p = (int*)(Mc_pm->shield_collision_tree + offset);
+	int* type_p = (int*)(m_pm->shield_collision_tree + offset);
 
 	// not used
 	//int *size_p = (int *)(Mc_pm->shield_collision_tree+offset+4);
 	// split and polygons
-	auto* minbox_p = (vec3d*)(Mc_pm->shield_collision_tree + offset + 8);
-	auto* maxbox_p = (vec3d*)(Mc_pm->shield_collision_tree + offset + 20);
+	auto* minbox_p = (vec3d*)(m_pm->shield_collision_tree + offset + 8);
+	auto* maxbox_p = (vec3d*)(m_pm->shield_collision_tree + offset + 20);
 
 	// split
-	auto* front_offset_p = (unsigned int*)(Mc_pm->shield_collision_tree + offset + 32);
-	auto* back_offset_p = (unsigned int*)(Mc_pm->shield_collision_tree + offset + 36);
+	auto* front_offset_p = (unsigned int*)(m_pm->shield_collision_tree + offset + 32);
+	auto* back_offset_p = (unsigned int*)(m_pm->shield_collision_tree + offset + 36);
 
 	// polygons
-	auto* num_polygons_p = (unsigned int*)(Mc_pm->shield_collision_tree + offset + 32);
+	auto* num_polygons_p = (unsigned int*)(m_pm->shield_collision_tree + offset + 32);
 
-	auto* shld_polys = (unsigned int*)(Mc_pm->shield_collision_tree + offset + 36);
+	auto* shld_polys = (unsigned int*)(m_pm->shield_collision_tree + offset + 36);
 
 
 
 	// see if it fits inside our bbox
-	if (!mc_ray_boundingbox(minbox_p, maxbox_p, &Mc_p0, &Mc_direction, NULL)) {
+	if (!mc_ray_boundingbox(minbox_p, maxbox_p, &m_p0, &m_direction, NULL)) {
 		return false;
 	}
 
@@ -927,7 +1007,7 @@ bool mc_check_sldc(int offset)
 		shield_tri* tri;
 		for (unsigned int i = 0; i < *num_polygons_p; i++)
 		{
-			tri = &Mc_pm->shield.tris[shld_polys[i]];
+			tri = &m_pm->shield.tris[shld_polys[i]];
 
 			mc_shield_check_common(tri);
 
@@ -939,21 +1019,21 @@ bool mc_check_sldc(int offset)
 }
 
 // checks a vector collision against a ships shield (if it has shield points defined).
-void mc_check_shield()
+void mc_query::mc_check_shield()
 {
 	int i;
 
 
-	if ( Mc_pm->shield.ntris < 1 )
+	if ( m_pm->shield.ntris < 1 )
 		return;
-	if (Mc_pm->shield_collision_tree)
+	if (m_pm->shield_collision_tree)
 	{
 		mc_check_sldc(0); // see if we hit the SLDC
 	}
 	else
 	{				
-		for (i = 0; i < Mc_pm->shield.ntris; i++) {
-			mc_shield_check_common(&Mc_pm->shield.tris[i]);
+		for (i = 0; i < m_pm->shield.ntris; i++) {
+			mc_shield_check_common(&m_pm->shield.tris[i]);
 		}
 	}//model has shield_collsion_tree
 }
@@ -961,7 +1041,7 @@ void mc_check_shield()
 
 // This function recursively checks a submodel and its children
 // for a collision with a vector.
-void mc_check_subobj( int mn )
+void mc_query::mc_check_subobj( int mn )
 {
 	vec3d tempv;
 	vec3d hitpt;		// used in bounding box check
@@ -969,61 +1049,61 @@ void mc_check_subobj( int mn )
 	int i;
 
 	Assert( mn >= 0 );
-	Assert( mn < Mc_pm->n_models );
-	if ( (mn < 0) || (mn>=Mc_pm->n_models) ) return;
+	Assert( mn < m_pm->n_models );
+	if ( (mn < 0) || (mn>=m_pm->n_models) ) return;
 	
-	sm = &Mc_pm->submodel[mn];
+	sm = &m_pm->submodel[mn];
 	if (sm->flags[Model::Submodel_flags::No_collisions]) return; // don't do collisions
 	if (sm->flags[Model::Submodel_flags::Nocollide_this_only]) goto NoHit; // Don't collide for this model, but keep checking others
 
-	if (Mc->flags & MC_RESPECT_DETAIL_BOX_SPHERE) {
+	if (m_mc->flags & MC_RESPECT_DETAIL_BOX_SPHERE) {
 		vec3d local;
-		vm_vec_sub(&local, &Eye_position, Mc->pos);
-		vm_vec_rotate(&local, &local, Mc->orient);
-		if (!model_render_check_detail_box(&local, Mc_pm, mn, MR_NORMAL))
+		vm_vec_sub(&local, &Eye_position, m_mc->pos);
+		vm_vec_rotate(&local, &local, m_mc->orient);
+		if (!model_render_check_detail_box(&local, m_pm, mn, MR_NORMAL))
 			goto NoHit; //This submodel is a detail box that is not displayed, skip it
 	}
 
 	// Rotate the world check points into the current subobject's 
 	// frame of reference.
-	// After this block, Mc_p0, Mc_p1, Mc_direction, and Mc_mag are correct
+	// After this block, m_p0, m_p1, m_direction, and m_mag are correct
 	// and relative to this subobjects' frame of reference.
-	vm_vec_sub(&tempv, Mc->p0, &Mc_base);
-	vm_vec_rotate(&Mc_p0, &tempv, &Mc_orient);
+	vm_vec_sub(&tempv, m_mc->p0, &m_base);
+	vm_vec_rotate(&m_p0, &tempv, &m_orient);
 
-	vm_vec_sub(&tempv, Mc->p1, &Mc_base);
-	vm_vec_rotate(&Mc_p1, &tempv, &Mc_orient);
-	vm_vec_sub(&Mc_direction, &Mc_p1, &Mc_p0);
+	vm_vec_sub(&tempv, m_mc->p1, &m_base);
+	vm_vec_rotate(&m_p1, &tempv, &m_orient);
+	vm_vec_sub(&m_direction, &m_p1, &m_p0);
 
 	// bail early if no ray exists
-	if ( IS_VEC_NULL(&Mc_direction) ) {
+	if ( IS_VEC_NULL(&m_direction) ) {
 		return;
 	}
 
-	if (Mc_pm->detail[0] == mn)	{
+	if (m_pm->detail[0] == mn)	{
 		// Quickly bail if we aren't inside the full model bbox
-		if (!mc_ray_boundingbox( &Mc_pm->mins, &Mc_pm->maxs, &Mc_p0, &Mc_direction, NULL))	{
+		if (!mc_ray_boundingbox( &m_pm->mins, &m_pm->maxs, &m_p0, &m_direction, NULL))	{
 			return;
 		}
 
 		// If we are checking the root submodel, then we might want to check	
 		// the shield at this point
-		if ((Mc->flags & MC_CHECK_SHIELD) && (Mc_pm->shield.ntris > 0 )) {
+		if ((m_mc->flags & MC_CHECK_SHIELD) && (m_pm->shield.ntris > 0 )) {
 			mc_check_shield();
 			return;
 		}
 	}
 
-	if (!(Mc->flags & MC_CHECK_MODEL)) {
+	if (!(m_mc->flags & MC_CHECK_MODEL)) {
 		return;
 	}
 	
-	Mc_submodel = mn;
+	m_submodel = mn;
 
 	// Check if the ray intersects this subobject's bounding box
-	if ( mc_ray_boundingbox(&sm->min, &sm->max, &Mc_p0, &Mc_direction, &hitpt) ) {
-		if (Mc->flags & MC_ONLY_BOUND_BOX) {
-			float dist = vm_vec_dist( &Mc_p0, &hitpt );
+	if ( mc_ray_boundingbox(&sm->min, &sm->max, &m_p0, &m_direction, &hitpt) ) {
+		if (m_mc->flags & MC_ONLY_BOUND_BOX) {
+			float dist = vm_vec_dist( &m_p0, &hitpt );
 
 			// If the ray is behind the plane there is no collision
 			if (dist < 0.0f) {
@@ -1031,29 +1111,29 @@ void mc_check_subobj( int mn )
 			}
 
 			// The ray isn't long enough to intersect the plane
-			if ( !(Mc->flags & MC_CHECK_RAY) && (dist > Mc_mag) ) {
+			if ( !(m_mc->flags & MC_CHECK_RAY) && (dist > m_mag) ) {
 				goto NoHit;
 			}
 
 			// If the ray hits, but a closer intersection has already been found, return
-			if ( Mc->num_hits && (dist >= Mc->hit_dist) ) {
+			if ( m_mc->num_hits && (dist >= m_mc->hit_dist) ) {
 				goto NoHit;
 			}
 
-			Mc->hit_dist = dist;
-			Mc->hit_point = hitpt;
-			Mc->hit_submodel = Mc_submodel;
-			Mc->hit_bitmap = -1;
-			Mc->num_hits++;
+			m_mc->hit_dist = dist;
+			m_mc->hit_point = hitpt;
+			m_mc->hit_submodel = m_submodel;
+			m_mc->hit_bitmap = -1;
+			m_mc->num_hits++;
 		} else {
 			// The ray intersects this bounding box, so we have to check all the
 			// polygons in this submodel.
-			if (Mc->lod > 0 && sm->num_details > 0) {
+			if (m_mc->lod > 0 && sm->num_details > 0) {
 				bsp_info* lod_sm = sm;
 
-				for (i = Mc->lod - 1; i >= 0; i--) {
+				for (i = m_mc->lod - 1; i >= 0; i--) {
 					if (sm->details[i] != -1) {
-						lod_sm = &Mc_pm->submodel[sm->details[i]];
+						lod_sm = &m_pm->submodel[sm->details[i]];
 
 						// mprintf(("Checking %s collision for %s using %s instead\n", Mc_pm->filename, sm->name,
 						// lod_sm->name));
@@ -1071,7 +1151,7 @@ void mc_check_subobj( int mn )
 NoHit:
 
 	// If we're only checking one submodel, return
-	if (Mc->flags & MC_SUBMODEL)	{
+	if (m_mc->flags & MC_SUBMODEL)	{
 		return;
 	}
 
@@ -1079,21 +1159,21 @@ NoHit:
 	// If this subobject doesn't have any children, we're done checking it.
 	if ( sm->num_children < 1 ) return;
 	
-	// Save instance (Mc_orient, Mc_base, Mc_point_base)
-	matrix saved_orient = Mc_orient;
-	vec3d saved_base = Mc_base;
+	// Save instance (m_orient, m_base, Mc_point_base)
+	matrix saved_orient = m_orient;
+	vec3d saved_base = m_base;
 	
 	// Check all of this subobject's children
 	i = sm->first_child;
 	while ( i >= 0 )	{
-		auto csm = &Mc_pm->submodel[i];
+		auto csm = &m_pm->submodel[i];
 		matrix instance_orient = vmd_identity_matrix;
 		vec3d instance_offset = csm->offset;
 		bool blown_off = false;
 		bool collision_checked = false;
 		
-		if ( Mc_pmi ) {
-			auto csmi = &Mc_pmi->submodel[i];
+		if ( m_pmi ) {
+			auto csmi = &m_pmi->submodel[i];
 			instance_orient = csmi->canonical_orient;
 			vm_vec_add2(&instance_offset, &csmi->canonical_offset);
 
@@ -1104,10 +1184,10 @@ NoHit:
 		// Don't check it or its children if it is destroyed
 		// or if it's set to no collision
 		if ( !blown_off && !collision_checked && !csm->flags[Model::Submodel_flags::No_collisions] )	{
-			vm_vec_unrotate(&Mc_base, &instance_offset, &saved_orient);
-			vm_vec_add2(&Mc_base, &saved_base);
+			vm_vec_unrotate(&m_base, &instance_offset, &saved_orient);
+			vm_vec_add2(&m_base, &saved_base);
 
-			vm_matrix_x_matrix(&Mc_orient, &saved_orient, &instance_orient);
+			vm_matrix_x_matrix(&m_orient, &saved_orient, &instance_orient);
 
 			mc_check_subobj( i );
 		}
@@ -1119,35 +1199,33 @@ NoHit:
 
 MONITOR(NumFVI)
 
-// See model.h for usage.   I don't want to put the
-// usage here because you need to see the #defines and structures
-// this uses while reading the help.   
-int model_collide(mc_info *mc_info_obj)
+// Runs one query, the model_collide() implementation
+int mc_query::collide(mc_info *mc_info_obj)
 {
-	Mc = mc_info_obj;
+	m_mc = mc_info_obj;
 
 	MONITOR_INC(NumFVI,1);
 
-	Mc->num_hits = 0;				// How many collisions were found
-	Mc->shield_hit_tri = -1;	// Assume we won't hit any shield polygons
-	Mc->hit_bitmap = -1;
-	Mc->edge_hit = false;
+	m_mc->num_hits = 0;				// How many collisions were found
+	m_mc->shield_hit_tri = -1;	// Assume we won't hit any shield polygons
+	m_mc->hit_bitmap = -1;
+	m_mc->edge_hit = false;
 
-	if ( (Mc->flags & MC_CHECK_SHIELD) && (Mc->flags & MC_CHECK_MODEL) )	{
+	if ( (m_mc->flags & MC_CHECK_SHIELD) && (m_mc->flags & MC_CHECK_MODEL) )	{
 		Error( LOCATION, "Checking both shield and model!\n" );
 		return 0;
 	}
 
 	//Fill in some global variables that all the model collide routines need internally.
-	Mc_pm = model_get(Mc->model_num);
-	Mc_orient = *Mc->orient;
-	Mc_base = *Mc->pos;
-	Mc_mag = vm_vec_dist( Mc->p0, Mc->p1 );
+	m_pm = model_get(m_mc->model_num);
+	m_orient = *m_mc->orient;
+	m_base = *m_mc->pos;
+	m_mag = vm_vec_dist( m_mc->p0, m_mc->p1 );
 
-	if ( Mc->model_instance_num >= 0 ) {
-		Mc_pmi = model_get_instance(Mc->model_instance_num);
+	if ( m_mc->model_instance_num >= 0 ) {
+		m_pmi = model_get_instance(m_mc->model_instance_num);
 	} else {
-		Mc_pmi = NULL;
+		m_pmi = NULL;
 	}
 
 	// DA 11/19/98 - disable this check for rotating submodels
@@ -1159,27 +1237,27 @@ int model_collide(mc_info *mc_info_obj)
 	float model_radius;		// How big is the model we're checking against
 	int first_submodel;		// Which submodel gets returned as hit if MC_ONLY_SPHERE specified
 
-	if ( (Mc->flags & MC_SUBMODEL) || (Mc->flags & MC_SUBMODEL_INSTANCE) )	{
-		first_submodel = Mc->submodel_num;
-		model_radius = Mc_pm->submodel[first_submodel].rad;
+	if ( (m_mc->flags & MC_SUBMODEL) || (m_mc->flags & MC_SUBMODEL_INSTANCE) )	{
+		first_submodel = m_mc->submodel_num;
+		model_radius = m_pm->submodel[first_submodel].rad;
 	} else {
-		first_submodel = Mc_pm->detail[0];
-		model_radius = Mc_pm->rad;
+		first_submodel = m_pm->detail[0];
+		model_radius = m_pm->rad;
 	}
 
-	if ( Mc->flags & MC_CHECK_SPHERELINE ) {
-		if ( Mc->radius <= 0.0f ) {
-			Warning(LOCATION, "Attempting to collide with a sphere, but the sphere's radius is <= 0.0f!\n\n(model file is %s; submodel is %d, mc_flags are %d)", Mc_pm->filename, first_submodel, Mc->flags);
+	if ( m_mc->flags & MC_CHECK_SPHERELINE ) {
+		if ( m_mc->radius <= 0.0f ) {
+			Warning(LOCATION, "Attempting to collide with a sphere, but the sphere's radius is <= 0.0f!\n\n(model file is %s; submodel is %d, mc_flags are %d)", m_pm->filename, first_submodel, m_mc->flags);
 			return 0;
 		}
 
 		// Do a quick check on the Bounding Sphere
-		if (fvi_segment_sphere(&Mc->hit_point_world, Mc->p0, Mc->p1, Mc->pos, model_radius+Mc->radius) )	{
-			if ( Mc->flags & MC_ONLY_SPHERE )	{
-				Mc->hit_point = Mc->hit_point_world;
-				Mc->hit_submodel = first_submodel;
-				Mc->num_hits++;
-				return (Mc->num_hits > 0);
+		if (fvi_segment_sphere(&m_mc->hit_point_world, m_mc->p0, m_mc->p1, m_mc->pos, model_radius+m_mc->radius) )	{
+			if ( m_mc->flags & MC_ONLY_SPHERE )	{
+				m_mc->hit_point = m_mc->hit_point_world;
+				m_mc->hit_submodel = first_submodel;
+				m_mc->num_hits++;
+				return (m_mc->num_hits > 0);
 			}
 			// continue checking polygons.
 		} else {
@@ -1189,17 +1267,17 @@ int model_collide(mc_info *mc_info_obj)
 		int r;
 
 		// Do a quick check on the Bounding Sphere
-		if ( Mc->flags & MC_CHECK_RAY ) {
-			r = fvi_ray_sphere(&Mc->hit_point_world, Mc->p0, Mc->p1, Mc->pos, model_radius);
+		if ( m_mc->flags & MC_CHECK_RAY ) {
+			r = fvi_ray_sphere(&m_mc->hit_point_world, m_mc->p0, m_mc->p1, m_mc->pos, model_radius);
 		} else {
-			r = fvi_segment_sphere(&Mc->hit_point_world, Mc->p0, Mc->p1, Mc->pos, model_radius);
+			r = fvi_segment_sphere(&m_mc->hit_point_world, m_mc->p0, m_mc->p1, m_mc->pos, model_radius);
 		}
 		if (r) {
-			if ( Mc->flags & MC_ONLY_SPHERE ) {
-				Mc->hit_point = Mc->hit_point_world;
-				Mc->hit_submodel = first_submodel;
-				Mc->num_hits++;
-				return (Mc->num_hits > 0);
+			if ( m_mc->flags & MC_ONLY_SPHERE ) {
+				m_mc->hit_point = m_mc->hit_point_world;
+				m_mc->hit_submodel = first_submodel;
+				m_mc->num_hits++;
+				return (m_mc->num_hits > 0);
 			}
 			// continue checking polygons.
 		} else {
@@ -1209,49 +1287,49 @@ int model_collide(mc_info *mc_info_obj)
 	}
 
 	// Check only one subobject; or check submodel and any children
-	if ( (Mc->flags & MC_SUBMODEL) || (Mc->flags & MC_SUBMODEL_INSTANCE) ) {
+	if ( (m_mc->flags & MC_SUBMODEL) || (m_mc->flags & MC_SUBMODEL_INSTANCE) ) {
 		// note: within this function, MC_SUBMODEL will return after one check; but MC_SUBMODEL_INSTANCE will not
-		mc_check_subobj(Mc->submodel_num);
+		mc_check_subobj(m_mc->submodel_num);
 	}
 	// Check all the the highest detail model polygons and subobjects for intersections
 	else {
 		// Don't check it or its children if it is destroyed
-		if ( Mc_pmi ) {
-			if ( !Mc_pmi->submodel[Mc_pm->detail[0]].blown_off ) {
-				mc_check_subobj(Mc_pm->detail[0]);
+		if ( m_pmi ) {
+			if ( !m_pmi->submodel[m_pm->detail[0]].blown_off ) {
+				mc_check_subobj(m_pm->detail[0]);
 			}
 		} else {
-			mc_check_subobj(Mc_pm->detail[0]);
+			mc_check_subobj(m_pm->detail[0]);
 		}
 	}
 
 
 	//If we found a hit, then rotate it into world coordinates	
-	if ( Mc->num_hits )	{
-		if ( Mc->flags & MC_SUBMODEL )	{
+	if ( m_mc->num_hits )	{
+		if ( m_mc->flags & MC_SUBMODEL )	{
 			// If we're just checking one submodel, don't use normal instancing to find world points
-			vm_vec_unrotate(&Mc->hit_point_world, &Mc->hit_point, Mc->orient);
-			vm_vec_add2(&Mc->hit_point_world, Mc->pos);
+			vm_vec_unrotate(&m_mc->hit_point_world, &m_mc->hit_point, m_mc->orient);
+			vm_vec_add2(&m_mc->hit_point_world, m_mc->pos);
 		} else {
-			if ( Mc_pmi ) {
-				model_instance_local_to_global_point(&Mc->hit_point_world, &Mc->hit_point, Mc_pm, Mc_pmi, Mc->hit_submodel, Mc->orient, Mc->pos);
+			if ( m_pmi ) {
+				model_instance_local_to_global_point(&m_mc->hit_point_world, &m_mc->hit_point, m_pm, m_pmi, m_mc->hit_submodel, m_mc->orient, m_mc->pos);
 			} else {
-				model_local_to_global_point(&Mc->hit_point_world, &Mc->hit_point, Mc_pm, Mc->hit_submodel, Mc->orient, Mc->pos);
+				model_local_to_global_point(&m_mc->hit_point_world, &m_mc->hit_point, m_pm, m_mc->hit_submodel, m_mc->orient, m_mc->pos);
 			}
 		}
 		
 		// do the same for the list of hitpoints, if necessary
-		if (Mc->flags & MC_COLLIDE_ALL) {
-			for (size_t i = 0; i < Mc->hit_points_all.size(); i++) {
-				if (Mc->flags & MC_SUBMODEL) {
-					vm_vec_unrotate(&Mc->hit_points_all[i], &Mc->hit_points_all[i], Mc->orient);
-					vm_vec_add2(&Mc->hit_points_all[i], Mc->pos);
+		if (m_mc->flags & MC_COLLIDE_ALL) {
+			for (size_t i = 0; i < m_mc->hit_points_all.size(); i++) {
+				if (m_mc->flags & MC_SUBMODEL) {
+					vm_vec_unrotate(&m_mc->hit_points_all[i], &m_mc->hit_points_all[i], m_mc->orient);
+					vm_vec_add2(&m_mc->hit_points_all[i], m_mc->pos);
 				} else {
-					if (Mc_pmi) {
-						model_instance_local_to_global_point(&Mc->hit_points_all[i], &Mc->hit_points_all[i], Mc_pm, Mc_pmi, Mc->hit_submodels_all[i], Mc->orient, Mc->pos);
+					if (m_pmi) {
+						model_instance_local_to_global_point(&m_mc->hit_points_all[i], &m_mc->hit_points_all[i], m_pm, m_pmi, m_mc->hit_submodels_all[i], m_mc->orient, m_mc->pos);
 					}
 					else {
-						model_local_to_global_point(&Mc->hit_points_all[i], &Mc->hit_points_all[i], Mc_pm, Mc->hit_submodels_all[i], Mc->orient, Mc->pos);
+						model_local_to_global_point(&m_mc->hit_points_all[i], &m_mc->hit_points_all[i], m_pm, m_mc->hit_submodels_all[i], m_mc->orient, m_mc->pos);
 					}
 				}
 			}
@@ -1259,5 +1337,16 @@ int model_collide(mc_info *mc_info_obj)
 
 	}
 
-	return Mc->num_hits;
+	return m_mc->num_hits;
+}
+
+// See model.h for usage.   I don't want to put the
+// usage here because you need to see the #defines and structures
+// this uses while reading the help.   
+int model_collide(mc_info *mc_info_obj)
+{
+	// Kept around so the buffers of the query don't have to be allocated again for every call
+	thread_local static mc_query query;
+
+	return query.collide(mc_info_obj);
 }
@@ -124,7 +124,7 @@ void model_interp_process_shield_mesh(polymodel * pm);
 void model_set_subsys_path_nums(polymodel *pm, int n_subsystems, model_subsystem *subsystems);
 void model_set_bay_path_nums(polymodel *pm);
 
-uint align_bsp_data(ubyte* bsp_in, ubyte* bsp_out, uint bsp_size);
+uint align_bsp_data(const ubyte* bsp_in, ubyte* bsp_out, uint bsp_size);
 uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size);
 
 
@@ -2125,37 +2125,59 @@ modelread_status read_model_file_no_subsys(polymodel * pm, const char* filename,
 					sm->bsp_data_size = cfread_int(fp);
 
 					if (sm->bsp_data_size > 0) {
-						auto bsp_data = reinterpret_cast<ubyte*>(vm_malloc(sm->bsp_data_size));
+						extern bool Cmdline_no_bsp_align;
 
-						cfread(bsp_data, 1, sm->bsp_data_size, fp);
+						// If the data gets realigned anyway, it can be realigned straight out of the model file when the
+						// file is in memory. That doesn't work if it has to be byte swapped first.
+						const ubyte* borrowed_data = nullptr;
+#if BYTE_ORDER != BIG_ENDIAN
+						if (!Cmdline_no_bsp_align) {
+							borrowed_data = reinterpret_cast<const ubyte*>(cf_borrow_data(fp, sm->bsp_data_size));
+						}
+#endif
 
-						// byte swap first thing
-						swap_bsp_data(pm, bsp_data);
+						ubyte* bsp_data = nullptr;
+						if (borrowed_data == nullptr) {
+							bsp_data = reinterpret_cast<ubyte*>(vm_malloc(sm->bsp_data_size));
+
+							cfread(bsp_data, 1, sm->bsp_data_size, fp);
+
+							// byte swap first thing
+							swap_bsp_data(pm, bsp_data);
+
+							borrowed_data = bsp_data;
+						}
 
-						extern bool Cmdline_no_bsp_align;
 						if (Cmdline_no_bsp_align) {
 							sm->bsp_data = bsp_data;
 						}
 						else {
-							auto bsp_data_size_aligned = align_bsp_data(bsp_data, nullptr, sm->bsp_data_size);
+							auto bsp_data_size_aligned = align_bsp_data(borrowed_data, nullptr, sm->bsp_data_size);
 
 							if (bsp_data_size_aligned != static_cast<uint>(sm->bsp_data_size)) {
 								auto bsp_data_aligned = reinterpret_cast<ubyte*>(vm_malloc(bsp_data_size_aligned));
 
-								align_bsp_data(bsp_data, bsp_data_aligned, sm->bsp_data_size);
+								align_bsp_data(borrowed_data, bsp_data_aligned, sm->bsp_data_size);
 
 								// release unaligned data
-								vm_free(bsp_data);
-								bsp_data = nullptr;
+								if (bsp_data != nullptr) {
+									vm_free(bsp_data);
+									bsp_data = nullptr;
+								}
 
 								nprintf(("Model", "BSP ALIGN => %s:%s resized by %d bytes (%d total)\n", pm->filename, sm->name, bsp_data_size_aligned - sm->bsp_data_size, bsp_data_size_aligned));
 
 								sm->bsp_data = bsp_data_aligned;
 								sm->bsp_data_size = bsp_data_size_aligned;
 							}
-							else {
+							else if (bsp_data != nullptr) {
 								sm->bsp_data = bsp_data;
 							}
+							else {
+								// Already aligned, but the model needs its own copy
+								sm->bsp_data = reinterpret_cast<ubyte*>(vm_malloc(sm->bsp_data_size));
+								memcpy(sm->bsp_data, borrowed_data, sm->bsp_data_size);
+							}
 						}
 					}
 					else {
@@ -4103,6 +4125,8 @@ void submodel_canonicalize_rotation(bsp_info *sm, submodel_instance *smi, bool c
 			vm_quaternion_rotate(&smi->canonical_orient, smi->cur_angle, &sm->rotation_axis);
 			break;
 	}
+
+	submodel_invalidate_transform(smi);
 }
 
 // Convert float displacement to vector, but no normalization (clamping) is needed
@@ -4129,6 +4153,8 @@ void submodel_canonicalize_translation(bsp_info *sm, submodel_instance *smi)
 			vm_vec_copy_scale(&smi->canonical_offset, &sm->translation_axis, smi->cur_offset);
 			break;
 	}
+
+	submodel_invalidate_transform(smi);
 }
 
 // Does stepped rotation of a submodel
@@ -4468,6 +4494,7 @@ bool model_rotate_gun(const object *objp, const polymodel *pm, const polymodel_i
 		// Pretend the base is pointing directly at the target
 		save_base_orient = base_smi->canonical_orient;
 		vm_quaternion_rotate(&base_smi->canonical_orient, desired_base_angle, &base_sm->rotation_axis);
+		submodel_invalidate_transform(base_smi);
 
 		//------------
 		// Project the destination point onto the turret gun plane with the base in the desired orientation
@@ -4491,6 +4518,7 @@ bool model_rotate_gun(const object *objp, const polymodel *pm, const polymodel_i
 		//------------
 		// Restore the base
 		base_smi->canonical_orient = save_base_orient;
+		submodel_invalidate_transform(base_smi);
 
 	} else {
 		desired_base_angle = base_smi->turret_idle_angle;
@@ -4617,6 +4645,63 @@ void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, int
 	return model_instance_local_to_global_point(outpnt, mpnt, pm, pmi, submodel_num, objorient, objpos, use_last_frame);
 }
 
+// Brings the cached transform of a submodel up to date, starting with its parents.  The caller must hold the lock.
+static const submodel_transform &model_instance_update_submodel_transform(const polymodel *pm, const polymodel_instance *pmi, int submodel_num)
+{
+	auto &transform = pmi->submodel_transforms[submodel_num];
+	int parent = pm->submodel[submodel_num].parent;
+
+	// the rotation of the root submodel is never applied, so its transform stays the identity
+	if (parent < 0) {
+		return transform;
+	}
+
+	const auto &parent_transform = model_instance_update_submodel_transform(pm, pmi, parent);
+	const auto &smi = pmi->submodel[submodel_num];
+
+	if (transform.valid && transform.version == smi.transform_version && transform.parent_stamp == parent_transform.stamp) {
+		return transform;
+	}
+
+	vec3d local_offset;
+	vm_vec_add(&local_offset, &smi.canonical_offset, &pm->submodel[submodel_num].offset);
+	vm_vec_unrotate(&transform.offset, &local_offset, &parent_transform.orient);
+	vm_vec_add2(&transform.offset, &parent_transform.offset);
+
+	transform.orient = smi.canonical_orient * parent_transform.orient;
+
+	transform.valid = true;
+	transform.version = smi.transform_version;
+	transform.parent_stamp = parent_transform.stamp;
+	++transform.stamp;
+
+	return transform;
+}
+
+void model_instance_get_submodel_transform(matrix *orient, vec3d *offset, const polymodel *pm, const polymodel_instance *pmi, int submodel_num)
+{
+	Assert(pm->id == pmi->model_num);
+
+	if (submodel_num < 0) {
+		*orient = vmd_identity_matrix;
+		*offset = vmd_zero_vector;
+		return;
+	}
+
+	Assertion(submodel_num < pm->n_models, "Submodel number %d is out of range for model %s!", submodel_num, pm->filename);
+
+	// particle sources look up their hosts' positions on several threads at once
+	std::lock_guard<std::mutex> guard(pmi->submodel_transforms_mutex);
+
+	if (pmi->submodel_transforms.empty()) {
+		pmi->submodel_transforms.resize(pm->n_models);
+	}
+
+	const auto &transform = model_instance_update_submodel_transform(pm, pmi, submodel_num);
+	*orient = transform.orient;
+	*offset = transform.offset;
+}
+
 void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos, bool use_last_frame)
 {
 	vec3d pnt;
@@ -4624,16 +4709,25 @@ void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, cons
 	int mn;
 	Assert(pm->id == pmi->model_num);
 
-	pnt = *mpnt;
-	mn = submodel_num;
+	if (use_last_frame) {
+		pnt = *mpnt;
+		mn = submodel_num;
 
-	//instance up the tree for this point
-	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		vm_vec_unrotate(&tpnt, &pnt, use_last_frame ? &pmi->submodel[mn].canonical_prev_orient : &pmi->submodel[mn].canonical_orient);
-		vm_vec_add(&pnt, &tpnt, use_last_frame ? &pmi->submodel[mn].canonical_prev_offset : &pmi->submodel[mn].canonical_offset);
-		vm_vec_add2(&pnt, &pm->submodel[mn].offset);
+		//instance up the tree for this point
+		while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
+			vm_vec_unrotate(&tpnt, &pnt, &pmi->submodel[mn].canonical_prev_orient);
+			vm_vec_add(&pnt, &tpnt, &pmi->submodel[mn].canonical_prev_offset);
+			vm_vec_add2(&pnt, &pm->submodel[mn].offset);
 
-		mn = pm->submodel[mn].parent;
+			mn = pm->submodel[mn].parent;
+		}
+	} else {
+		matrix submodel_orient;
+		vec3d submodel_offset;
+		model_instance_get_submodel_transform(&submodel_orient, &submodel_offset, pm, pmi, submodel_num);
+
+		vm_vec_unrotate(&tpnt, mpnt, &submodel_orient);
+		vm_vec_add(&pnt, &tpnt, &submodel_offset);
 	}
 
 	//now instance for the entire object
@@ -4647,25 +4741,17 @@ void model_instance_local_to_global_point(vec3d *outpnt, const vec3d *mpnt, cons
 
 void model_instance_local_to_global_point_dir(vec3d *out_pnt, vec3d *out_dir, const vec3d *in_pnt, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient, const vec3d *objpos)
 {
-	vec3d pnt, tpnt, dir, tdir;
-	int mn;
+	vec3d pnt, tpnt, dir;
+	matrix submodel_orient;
+	vec3d submodel_offset;
 	Assert(pm->id == pmi->model_num);
 
-	pnt = *in_pnt;
-	dir = *in_dir;
-	mn = submodel_num;
-
-	// instance up the tree for this point
-	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		vm_vec_unrotate(&tpnt, &pnt, &pmi->submodel[mn].canonical_orient);
-		vm_vec_add(&pnt, &tpnt, &pmi->submodel[mn].canonical_offset);
-		vm_vec_add2(&pnt, &pm->submodel[mn].offset);
+	model_instance_get_submodel_transform(&submodel_orient, &submodel_offset, pm, pmi, submodel_num);
 
-		vm_vec_unrotate(&tdir, &dir, &pmi->submodel[mn].canonical_orient);
-		dir = tdir;
+	vm_vec_unrotate(&tpnt, in_pnt, &submodel_orient);
+	vm_vec_add(&pnt, &tpnt, &submodel_offset);
 
-		mn = pm->submodel[mn].parent;
-	}
+	vm_vec_unrotate(&dir, in_dir, &submodel_orient);
 
 	// now instance for the entire object
 	if (objorient && objpos) {
@@ -4683,23 +4769,16 @@ void model_instance_local_to_global_point_orient(vec3d *outpnt, matrix *outorien
 {
 	vec3d pnt, tpnt;
 	matrix orient;
-	int mn;
+	matrix transform_orient;
+	vec3d transform_offset;
 	Assert(pm->id == pmi->model_num);
 
-	pnt = *submodel_pnt;
-	orient = *submodel_orient;
-	mn = submodel_num;
+	model_instance_get_submodel_transform(&transform_orient, &transform_offset, pm, pmi, submodel_num);
 
-	// instance up the tree for this point
-	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		vm_vec_unrotate(&tpnt, &pnt, &pmi->submodel[mn].canonical_orient);
-		vm_vec_add(&pnt, &tpnt, &pmi->submodel[mn].canonical_offset);
-		vm_vec_add2(&pnt, &pm->submodel[mn].offset);
+	vm_vec_unrotate(&tpnt, submodel_pnt, &transform_orient);
+	vm_vec_add(&pnt, &tpnt, &transform_offset);
 
-		orient = orient * pmi->submodel[mn].canonical_orient;
-
-		mn = pm->submodel[mn].parent;
-	}
+	orient = *submodel_orient * transform_orient;
 
 	// now instance for the entire object
 	if (objorient && objpos) {
@@ -4722,6 +4801,23 @@ void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, int
 void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos, bool use_last_frame) {
 	Assert(pm->id == pmi->model_num);
 
+	if (!use_last_frame) {
+		matrix submodel_orient;
+		vec3d submodel_offset;
+		model_instance_get_submodel_transform(&submodel_orient, &submodel_offset, pm, pmi, submodel_num);
+
+		vec3d resultPnt = *mpnt;
+
+		if (objorient != nullptr && objpos != nullptr) {
+			vm_vec_sub2(&resultPnt, objpos);
+			vm_vec_rotate(&resultPnt, &resultPnt, objorient);
+		}
+
+		vm_vec_sub2(&resultPnt, &submodel_offset);
+		vm_vec_rotate(outpnt, &resultPnt, &submodel_orient);
+		return;
+	}
+
 	constexpr int preallocatedStackDepth = 5;
 	std::tuple<const matrix*, const vec3d*, const vec3d*> preallocatedStack[preallocatedStackDepth];
 
@@ -4732,13 +4828,8 @@ void model_instance_global_to_local_point(vec3d* outpnt, const vec3d* mpnt, cons
 
 	//Go up the chain of parents to build a stack of transformations from parent -> child
 	while ((mn >= 0) && (pm->submodel[mn].parent >= 0)) {
-		if(use_last_frame) {
-			std::get<0>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_prev_orient;
-			std::get<1>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_prev_offset;
-		} else {
-			std::get<0>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_orient;
-			std::get<1>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_offset;
-		}
+		std::get<0>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_prev_orient;
+		std::get<1>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_prev_offset;
 		std::get<2>(submodelStack[stackCounter++]) = &pm->submodel[mn].offset;
 		mn = pm->submodel[mn].parent;
 	}
@@ -4775,6 +4866,20 @@ void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, int
 void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, bool use_last_frame) {
 	Assert(pm->id == pmi->model_num);
 
+	if (!use_last_frame) {
+		matrix submodel_orient;
+		vec3d submodel_offset;
+		model_instance_get_submodel_transform(&submodel_orient, &submodel_offset, pm, pmi, submodel_num);
+
+		vec3d resultDir = *in_dir;
+
+		if (objorient != nullptr)
+			vm_vec_rotate(&resultDir, &resultDir, objorient);
+
+		vm_vec_rotate(out_dir, &resultDir, &submodel_orient);
+		return;
+	}
+
 	constexpr int preallocatedStackDepth = 5;
 	const matrix* preallocatedStack[preallocatedStackDepth];
 
@@ -4785,10 +4890,7 @@ void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, con
 
 	//Go up the chain of parents to build a stack of transformations from parent -> child
 	while ((mn >= 0) && (pm->submodel[mn].parent >= 0)) {
-		if (use_last_frame)
-			submodelStack[stackCounter++] = &pmi->submodel[mn].canonical_prev_orient;
-		else
-			submodelStack[stackCounter++] = &pmi->submodel[mn].canonical_orient;
+		submodelStack[stackCounter++] = &pmi->submodel[mn].canonical_prev_orient;
 		mn = pm->submodel[mn].parent;
 	}
 
@@ -4814,46 +4916,22 @@ void model_instance_global_to_local_dir(vec3d* out_dir, const vec3d* in_dir, con
 void model_instance_global_to_local_point_orient(vec3d* outpnt, matrix* outorient, const vec3d* submodel_pnt, const matrix* submodel_orient, const polymodel* pm, const polymodel_instance* pmi, int submodel_num, const matrix* objorient, const vec3d* objpos) {
 	Assert(pm->id == pmi->model_num);
 
-	constexpr int preallocatedStackDepth = 5;
-	std::tuple<const matrix*, const vec3d*, const vec3d*> preallocatedStack[preallocatedStackDepth];
-
-	auto submodelStack = submodel_num < 0 || pm->submodel[submodel_num].depth <= preallocatedStackDepth ? preallocatedStack : new std::tuple<const matrix*, const vec3d*, const vec3d*>[pm->submodel[submodel_num].depth];
-	int stackCounter = 0;
-
-	int mn = submodel_num;
-
-	//Go up the chain of parents to build a stack of transformations from parent -> child
-	while ((mn >= 0) && (pm->submodel[mn].parent >= 0)) {
-		std::get<0>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_orient;
-		std::get<1>(submodelStack[stackCounter]) = &pmi->submodel[mn].canonical_offset;
-		std::get<2>(submodelStack[stackCounter++]) = &pm->submodel[mn].offset;
-		mn = pm->submodel[mn].parent;
-	}
-
-	if (objorient != nullptr && objpos != nullptr) {
-		std::get<0>(submodelStack[stackCounter]) = objorient;
-		std::get<1>(submodelStack[stackCounter]) = &vmd_zero_vector;
-		std::get<2>(submodelStack[stackCounter++]) = objpos;
-	}
-	stackCounter--;
+	matrix transform_orient;
+	vec3d transform_offset;
+	model_instance_get_submodel_transform(&transform_orient, &transform_offset, pm, pmi, submodel_num);
 
 	vec3d resultPnt = *submodel_pnt;
 	matrix resultMat = *submodel_orient;
 
-	while (stackCounter >= 0) {
-		const auto& transform = submodelStack[stackCounter--];
-
-		vm_vec_sub2(&resultPnt, std::get<2>(transform));
-		vm_vec_sub2(&resultPnt, std::get<1>(transform));
-		vm_vec_rotate(&resultPnt, &resultPnt, std::get<0>(transform));
-		resultMat = *std::get<0>(transform) * resultMat;
+	if (objorient != nullptr && objpos != nullptr) {
+		vm_vec_sub2(&resultPnt, objpos);
+		vm_vec_rotate(&resultPnt, &resultPnt, objorient);
+		resultMat = *objorient * resultMat;
 	}
 
-	*outpnt = resultPnt;
-	*outorient = resultMat;
-
-	if (submodel_num >= 0 && pm->submodel[submodel_num].depth > preallocatedStackDepth)
-		delete[] submodelStack;
+	vm_vec_sub2(&resultPnt, &transform_offset);
+	vm_vec_rotate(outpnt, &resultPnt, &transform_orient);
+	*outorient = transform_orient * resultMat;
 }
 
 /*
@@ -4966,20 +5044,12 @@ void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, int
 void model_instance_local_to_global_dir(vec3d *out_dir, const vec3d *in_dir, const polymodel *pm, const polymodel_instance *pmi, int submodel_num, const matrix *objorient)
 {
 	vec3d pnt;
-	vec3d tpnt;
-	int mn;
+	matrix submodel_orient;
+	vec3d submodel_offset;
 	Assert(pm->id == pmi->model_num);
 
-	pnt = *in_dir;
-	mn = submodel_num;
-
-	// instance up the tree for this point
-	while ( (mn >= 0) && (pm->submodel[mn].parent >= 0) ) {
-		vm_vec_unrotate(&tpnt, &pnt, &pmi->submodel[mn].canonical_orient);
-		pnt = tpnt;
-
-		mn = pm->submodel[mn].parent;
-	}
+	model_instance_get_submodel_transform(&submodel_orient, &submodel_offset, pm, pmi, submodel_num);
+	vm_vec_unrotate(&pnt, in_dir, &submodel_orient);
 
 	// now instance for the entire object
 	if (objorient) {
@@ -5071,6 +5141,7 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 				r_smi->cur_offset = copy_from->cur_offset;
 				r_smi->canonical_offset = copy_from->canonical_offset;
 				r_smi->canonical_prev_offset = copy_from->canonical_prev_offset;
+				submodel_invalidate_transform(r_smi);
 			} else {
 				r_smi->cur_angle = smi->cur_angle;
 				r_smi->canonical_orient = smi->canonical_orient;
@@ -5079,6 +5150,7 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 				r_smi->cur_offset = smi->cur_offset;
 				r_smi->canonical_offset = smi->canonical_offset;
 				r_smi->canonical_prev_offset = smi->canonical_prev_offset;
+				submodel_invalidate_transform(r_smi);
 			}
 		}
 	} else {
@@ -5099,6 +5171,7 @@ void model_replicate_submodel_instance_sub(polymodel *pm, polymodel_instance *pm
 		smi->cur_offset = copy_from->cur_offset;
 		smi->canonical_offset = copy_from->canonical_offset;
 		smi->canonical_prev_offset = copy_from->canonical_prev_offset;
+		submodel_invalidate_transform(smi);
 	}
 
 	// For all the detail levels of this submodel, set them also.
@@ -5429,6 +5502,9 @@ void model_remove_bsp_collision_tree(int tree_index)
 	if ( Bsp_collision_tree_list[tree_index].vert_list ) {
 		vm_free( Bsp_collision_tree_list[tree_index].vert_list);
 	}
+
+	Bsp_collision_tree_list[tree_index].tris.clear();
+	Bsp_collision_tree_list[tree_index].leaf_tris.clear();
 }
 
 #if BYTE_ORDER == BIG_ENDIAN
@@ -6200,10 +6276,10 @@ uint convert_sldc_to_slc2(ubyte* sldc, ubyte* slc2, uint tree_size)
 }
 
 // if bsp_out is NULL then we just calculate new size
-uint align_bsp_data(ubyte* bsp_in, ubyte* bsp_out, uint bsp_size)
+uint align_bsp_data(const ubyte* bsp_in, ubyte* bsp_out, uint bsp_size)
 {
 	//ShivanSpS 
-	ubyte* end;
+	const ubyte* end;
 	uint copied = 0;
 	end = bsp_in + bsp_size;
 
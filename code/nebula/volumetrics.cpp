@@ -1,10 +1,15 @@
 #include "volumetrics.h"
 
 #include "bmpman/bmpman.h"
+#include "cfile/cfile.h"
+#include "cfile/cfilesystem.h"
+#include "cmdline/cmdline.h"
 #include "mission/missionparse.h"
 #include "model/model.h"
 #include "parse/parselo.h"
 #include "render/3d.h"
+#include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #include <anl.h>
 
@@ -280,18 +285,16 @@ static inline float getNebDistSquared(const ivec3& l, const ivec3& r, const vec3
 	return (dx < 0 ? 0 : dx) * scale.xyz.x * scale.xyz.x + (dy < 0 ? 0 : dy) * scale.xyz.y * scale.xyz.y + (dz < 0 ? 0 : dz) * scale.xyz.z * scale.xyz.z;
 }
 
-void volumetric_nebula::renderVolumeBitmap() {
-	Assertion(!hullPof.empty(), "Volumetric Nebula was not properly configured. Did you call parse_volumetric_nebula()?");
-	Assertion(!isVolumeBitmapValid(), "Volume bitmap was already rendered!");
+bool volumetric_nebula::generateVolumeBitmap(uint32_t planeSeed) {
+	TRACE_SCOPE(tracing::VolumetricsGenerate);
 
 	int n = 1 << resolution;
 	int nSample = (n << (oversampling - 1)) + 1;
-	auto volumeSampleCache = make_unique<bool[]>(nSample * nSample * nSample);
 
 	int modelnum = model_load(hullPof.c_str(), nullptr, ErrorType::NONE);
 	if (modelnum < 0) {
 		Warning(LOCATION, "Could not load model '%s'.  Unable to render volume bitmap!", hullPof.c_str());
-		return;
+		return false;
 	}
 
 	const polymodel* pm = model_get(modelnum);
@@ -303,20 +306,44 @@ void volumetric_nebula::renderVolumeBitmap() {
 	bb_min = pos - (size * 0.5f);
 	bb_max = pos + (size * 0.5f);
 
-	mc_info mc;
+	//Calculate minimum "bottom left" corner of scaled size box
+	vec3d bl = pm->mins - (size * ((scaleFactor - 1.0f) / 2.0f / scaleFactor));
 
-	mc.model_num = modelnum;
-	mc.orient = &vmd_identity_matrix;
-	mc.pos = &vmd_zero_vector;
-	mc.p1 = &vmd_zero_vector;
+	int oversamplingCount = (1 << (oversampling - 1));
 
-	mc.flags = MC_CHECK_MODEL | MC_COLLIDE_ALL | MC_CHECK_INVISIBLE_FACES;
+	int smoothing_steps = getVolumeBitmapSmoothingSteps();
+	float oversamplingDivisor = 255.1f / (static_cast<float>(oversamplingCount + smoothing_steps) * static_cast<float>(oversamplingCount + smoothing_steps) * static_cast<float>(oversamplingCount + smoothing_steps));
+	int smoothStart = smoothing_steps / 2;
+	int smoothStop = (smoothing_steps / 2 + (1 & smoothing_steps));
 
-	//Calculate minimum "bottom left" corner of scaled size box
-	vec3d bl = pm->mins - (size * ((scaleFactor - 1.0f) / 2.0f / scaleFactor));
+	//The box filter of a voxel covers the samples [windowStart, windowEnd) in each dimension. Samples outside of the grid count as empty.
+	SCP_vector<int> windowStart(n), windowEnd(n);
+	for (int i = 0; i < n; i++) {
+		windowStart[i] = std::max(i * oversamplingCount - smoothStart, 0);
+		windowEnd[i] = std::min((i + 1) * oversamplingCount + smoothStop, nSample);
+	}
+
+	//The filter is separable, so it's applied along z for every ray, along y for every x plane of rays, and along x while merging the planes.
+	//Each x plane is sampled by its own job. The jobs get their own random generators, so the result doesn't depend on the number of threads.
+
+	auto samplePlane = [&](int x, int* planeSums) {
+		Random::ThreadSeed seed(planeSeed ^ (static_cast<uint32_t>(x) * 0x9e3779b9u));
+
+		mc_info mc;
+
+		mc.model_num = modelnum;
+		mc.orient = &vmd_identity_matrix;
+		mc.pos = &vmd_zero_vector;
+		mc.p1 = &vmd_zero_vector;
+
+		mc.flags = MC_CHECK_MODEL | MC_COLLIDE_ALL | MC_CHECK_INVISIBLE_FACES;
+
+		SCP_vector<int> collisionZIndices;
+		//insideCount[z] is the number of samples inside the hull before z on the current ray
+		SCP_vector<int> insideCount(nSample + 1);
+		//lineSums[y * n + z] is the sum along z for voxel z on ray y, turned into a running sum over y further down
+		SCP_vector<int> lineSums(nSample * n);
 
-	//Go through sampling procedure to test where the nebula even is
-	for (int x = 0; x < nSample; x++) {
 		for (int y = 0; y < nSample; y++) {
 			vec3d start = bl;
 			start += vec3d{ {{static_cast<float>(x) * size.xyz.x / static_cast<float>(n << (oversampling - 1)),
@@ -342,48 +369,82 @@ void volumetric_nebula::renderVolumeBitmap() {
 				model_collide(&mc);
 			}
 
-			SCP_multiset<int> collisionZIndices;
+			collisionZIndices.clear();
 			for(const vec3d& hitpnt : mc.hit_points_all)
-				collisionZIndices.emplace(static_cast<int>((hitpnt.xyz.z - bl.xyz.z) / size.xyz.z * static_cast<float>(n << (oversampling - 1))));
+				collisionZIndices.push_back(static_cast<int>((hitpnt.xyz.z - bl.xyz.z) / size.xyz.z * static_cast<float>(n << (oversampling - 1))));
+			std::sort(collisionZIndices.begin(), collisionZIndices.end());
 
 			size_t hitcnt = 0;
 			auto hitpntit = collisionZIndices.cbegin();
+			insideCount[0] = 0;
 			for (int z = 0; z < nSample; z++) {
 				while (hitpntit != collisionZIndices.cend() && *hitpntit < z) {
 					++hitpntit;
 					++hitcnt;
 				}
-				volumeSampleCache[x * nSample * nSample + y * nSample + z] = hitcnt % 2 != 0;
+				insideCount[z + 1] = insideCount[z] + (hitcnt % 2 != 0 ? 1 : 0);
+			}
+
+			for (int z = 0; z < n; z++) {
+				lineSums[y * n + z] = insideCount[windowEnd[z]] - insideCount[windowStart[z]];
+				if (y > 0)
+					lineSums[y * n + z] += lineSums[(y - 1) * n + z];
 			}
 		}
+
+		for (int y = 0; y < n; y++) {
+			for (int z = 0; z < n; z++) {
+				planeSums[y * n + z] = lineSums[(windowEnd[y] - 1) * n + z] - (windowStart[y] > 0 ? lineSums[(windowStart[y] - 1) * n + z] : 0);
+			}
+		}
+	};
+
+	//The planes are merged in order, keeping a running sum over x. A voxel subtracts the running sum when its window starts and adds it when it ends.
+	//Only a batch of planes is kept in memory at a time.
+	constexpr int planeBatchSize = 32;
+	SCP_vector<int> planeBatch(planeBatchSize * n * n);
+	SCP_vector<int> runningSums(n * n, 0);
+	SCP_vector<int> voxelSums(n * n * n, 0);
+
+	auto applyWindowBounds = [&](int sampleX) {
+		for (int x = 0; x < n; x++) {
+			int sign = (windowEnd[x] == sampleX ? 1 : 0) - (windowStart[x] == sampleX ? 1 : 0);
+			if (sign == 0)
+				continue;
+
+			for (int yz = 0; yz < n * n; yz++)
+				voxelSums[x * n * n + yz] += sign * runningSums[yz];
+		}
+	};
+
+	for (int batchStart = 0; batchStart < nSample; batchStart += planeBatchSize) {
+		int batchEnd = std::min(batchStart + planeBatchSize, nSample);
+
+		threading::parallel_for(batchStart, batchEnd, 1, [&](size_t first, size_t last) {
+			for (size_t x = first; x < last; ++x) {
+				samplePlane(static_cast<int>(x), &planeBatch[(x - batchStart) * n * n]);
+			}
+		});
+
+		for (int x = batchStart; x < batchEnd; x++) {
+			applyWindowBounds(x);
+
+			const int* planeSums = &planeBatch[(x - batchStart) * n * n];
+			for (int yz = 0; yz < n * n; yz++)
+				runningSums[yz] += planeSums[yz];
+		}
 	}
+	applyWindowBounds(nSample);
 
 	model_unload(modelnum);
 
-	//Sample the nebula values from the binary cubegrid.
+	//Sample the nebula values from the summed up cubegrid.
 	volumeBitmapData = make_unique<ubyte[]>(n * n * n * 4);
-	int oversamplingCount = (1 << (oversampling - 1));
-
-	int smoothing_steps = getVolumeBitmapSmoothingSteps();
-	float oversamplingDivisor = 255.1f / (static_cast<float>(oversamplingCount + smoothing_steps) * static_cast<float>(oversamplingCount + smoothing_steps) * static_cast<float>(oversamplingCount + smoothing_steps));
-	int smoothStart = smoothing_steps / 2;
-	int smoothStop = (smoothing_steps / 2 + (1 & smoothing_steps));
 
 	for (int x = 0; x < n; x++) {
 		for (int y = 0; y < n; y++) {
 			for (int z = 0; z < n; z++) {
-				int sum = 0;
-				for (int sx = x * oversamplingCount - smoothStart; sx < (x + 1) * oversamplingCount + smoothStop; sx++) {
-					for (int sy = y * oversamplingCount - smoothStart; sy < (y + 1) * oversamplingCount + smoothStop; sy++) {
-						for (int sz = z * oversamplingCount - smoothStart; sz < (z + 1) * oversamplingCount + smoothStop; sz++) {
-							if (sx >= 0 && sx < nSample && sy >= 0 && sy < nSample && sz >= 0 && sz < nSample &&
-								volumeSampleCache[sx * nSample * nSample + sy * nSample + sz])
-								sum++;
-						}
-					}
-				}
-
-				volumeBitmapData[COLOR_3D_ARRAY_POS(n, A, x, y, z)] = static_cast<ubyte>(static_cast<float>(sum) * oversamplingDivisor);
+				volumeBitmapData[COLOR_3D_ARRAY_POS(n, A, x, y, z)] = static_cast<ubyte>(static_cast<float>(voxelSums[x * n * n + y * n + z]) * oversamplingDivisor);
 			}
 		}
 	}
@@ -462,6 +523,162 @@ void volumetric_nebula::renderVolumeBitmap() {
 		}
 	}
 
+	return true;
+}
+
+#define VOLUMETRICS_CACHE_ID			0x4C4F564E		// "NVOL"
+#define VOLUMETRICS_CACHE_VERSION		1
+
+// The cache location, see cf_load_pack_index_cache() for the same thing for pack files
+static constexpr uint32_t VOLUMETRICS_CACHE_LOCATION = CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT;
+
+// Rendering a volume bitmap depends on the hull and on the parameters which change the sampling, but not on the position
+struct volume_cache_key {
+	uint pofChecksum = 0;
+	int resolution = 0;
+	int oversampling = 0;
+	int smoothingSteps = 0;
+
+	bool operator==(const volume_cache_key& other) const {
+		return pofChecksum == other.pofChecksum && resolution == other.resolution && oversampling == other.oversampling && smoothingSteps == other.smoothingSteps;
+	}
+};
+
+// One file per hull and parameters, so that nebulae which are used in several missions don't push each other out
+static SCP_string getVolumeCacheFilename(const SCP_string& hullPof, const volume_cache_key& key) {
+	uint hash = 2166136261u;
+
+	for (char c : hullPof) {
+		hash = (hash ^ static_cast<ubyte>(SCP_tolower(c))) * 16777619u;
+	}
+	for (uint value : {key.pofChecksum, static_cast<uint>(key.resolution), static_cast<uint>(key.oversampling), static_cast<uint>(key.smoothingSteps)}) {
+		hash = (hash ^ value) * 16777619u;
+	}
+
+	SCP_string filename;
+	sprintf(filename, "volumetrics_%08x.bin", hash);
+	return filename;
+}
+
+template <typename T>
+static bool volume_cache_read(FILE* fp, T* value) {
+	return fread(value, sizeof(T), 1, fp) == 1;
+}
+
+template <typename T>
+static void volume_cache_write(FILE* fp, const T& value) {
+	fwrite(&value, sizeof(T), 1, fp);
+}
+
+bool volumetric_nebula::loadVolumeBitmapCache(const volume_cache_key& key) {
+	if (Cmdline_rebuild_file_cache) {
+		return false;
+	}
+
+	SCP_string cache_path;
+	cf_create_default_path_string(cache_path, CF_TYPE_CACHE, getVolumeCacheFilename(hullPof, key).c_str(), VOLUMETRICS_CACHE_LOCATION);
+
+	FILE* fp = fopen(cache_path.c_str(), "rb");
+
+	if (!fp) {
+		return false;
+	}
+
+	int n = 1 << resolution;
+	auto data = make_unique<ubyte[]>(n * n * n * 4);
+
+	uint id = 0, version = 0;
+	volume_cache_key cachedKey;
+	vec3d cachedSize;
+	float cachedUdfScale;
+
+	bool ok = volume_cache_read(fp, &id) && volume_cache_read(fp, &version) && volume_cache_read(fp, &cachedKey) &&
+		volume_cache_read(fp, &cachedSize) && volume_cache_read(fp, &cachedUdfScale);
+
+	ok = ok && (id == VOLUMETRICS_CACHE_ID) && (version == VOLUMETRICS_CACHE_VERSION) && (cachedKey == key);
+	ok = ok && fread(data.get(), 1, n * n * n * 4, fp) == static_cast<size_t>(n * n * n * 4);
+
+	fclose(fp);
+
+	if (!ok) {
+		mprintf(("Volumetric nebula cache '%s' is invalid or outdated, ignoring it.\n", cache_path.c_str()));
+		return false;
+	}
+
+	size = cachedSize;
+	bb_min = pos - (size * 0.5f);
+	bb_max = pos + (size * 0.5f);
+	udfScale = cachedUdfScale;
+	volumeBitmapData = std::move(data);
+
+	return true;
+}
+
+void volumetric_nebula::saveVolumeBitmapCache(const volume_cache_key& key) const {
+	cf_create_directory(CF_TYPE_CACHE, VOLUMETRICS_CACHE_LOCATION);
+
+	SCP_string cache_path;
+	cf_create_default_path_string(cache_path, CF_TYPE_CACHE, getVolumeCacheFilename(hullPof, key).c_str(), VOLUMETRICS_CACHE_LOCATION);
+
+	// write to a temporary file first, so that a mission loaded at the same time in another instance can't read half of it
+	SCP_string temp_path = cache_path + ".tmp";
+
+	FILE* fp = fopen(temp_path.c_str(), "wb");
+
+	if (!fp) {
+		mprintf(("Could not write volumetric nebula cache '%s'!\n", temp_path.c_str()));
+		return;
+	}
+
+	int n = 1 << resolution;
+
+	volume_cache_write(fp, static_cast<uint>(VOLUMETRICS_CACHE_ID));
+	volume_cache_write(fp, static_cast<uint>(VOLUMETRICS_CACHE_VERSION));
+	volume_cache_write(fp, key);
+	volume_cache_write(fp, size);
+	volume_cache_write(fp, udfScale);
+	fwrite(volumeBitmapData.get(), 1, n * n * n * 4, fp);
+
+	bool ok = (ferror(fp) == 0);
+	ok = (fclose(fp) == 0) && ok;
+
+	if (ok) {
+		// rename() won't replace an existing file on Windows
+		remove(cache_path.c_str());
+		ok = (rename(temp_path.c_str(), cache_path.c_str()) == 0);
+	}
+
+	if (!ok) {
+		mprintf(("Could not write volumetric nebula cache '%s'!\n", cache_path.c_str()));
+		remove(temp_path.c_str());
+	}
+}
+
+void volumetric_nebula::renderVolumeBitmap() {
+	Assertion(!hullPof.empty(), "Volumetric Nebula was not properly configured. Did you call parse_volumetric_nebula()?");
+	Assertion(!isVolumeBitmapValid(), "Volume bitmap was already rendered!");
+
+	int n = 1 << resolution;
+
+	volume_cache_key cacheKey;
+	cacheKey.resolution = resolution;
+	cacheKey.oversampling = oversampling;
+	cacheKey.smoothingSteps = getVolumeBitmapSmoothingSteps();
+	bool cacheable = cf_chksum_long(hullPof.c_str(), &cacheKey.pofChecksum, -1, CF_TYPE_MODELS) != 0;
+
+	//Drawn even if the cache is used, so that the random numbers used afterwards don't depend on the cache
+	const auto planeSeed = static_cast<uint32_t>(Random::next());
+
+	if (!cacheable || !loadVolumeBitmapCache(cacheKey)) {
+		if (!generateVolumeBitmap(planeSeed)) {
+			return;
+		}
+
+		if (cacheable) {
+			saveVolumeBitmapCache(cacheKey);
+		}
+	}
+
 	volumeBitmapHandle = bm_create_3d(32, n, n, n, volumeBitmapData.get());
 
 	if (!noiseActive)
@@ -6,6 +6,8 @@
 #include <memory>
 #include <optional>
 
+struct volume_cache_key;
+
 namespace fso {
 	namespace fred {
 		class CFred_mission_save;
@@ -85,6 +87,12 @@ class volumetric_nebula {
 
 	bool enabled = true;
 
+	//Samples the hull into volumeBitmapData and sets up everything derived from the hull. The planes are jittered with random generators derived from planeSeed. Returns false if the hull can't be loaded.
+	bool generateVolumeBitmap(uint32_t planeSeed);
+	//The volume bitmap data only depends on the hull and a few quality settings, so it's cached on disk between loads.
+	bool loadVolumeBitmapCache(const volume_cache_key& key);
+	void saveVolumeBitmapCache(const volume_cache_key& key) const;
+
 	//Friend things that are allowed to directly manipulate "current" volumetrics. Only FRED and the Lab. In all other cases, "sensibly constant" values behave properly RAII and stay constant afterwards.
 	friend class LabUi; //Lab
 	friend class CFred_mission_save; //FRED
@@ -1093,7 +1093,7 @@ void process_ingame_ships_packet( ubyte *data, header *hinfo )
 		multi_rollback_ship_record_add_ship(objnum);
 
 		// assign any common data
-		strcpy_s(Ships[ship_num].ship_name, ship_name);
+		ship_rename(ship_num, ship_name);
 		Ships[ship_num].flags.reset();
 		Ships[ship_num].flags.set_from_vector(ship_flags);
 		Ships[ship_num].team = team;
@@ -1332,7 +1332,7 @@ void process_ingame_wings_packet( ubyte *data, header *hinfo )
 				// kind of stupid, but bash the name since it won't get recreated properly from
 				// the parse_wing_create_ships call.
 				shipp = &Ships[shipnum];
-				wing_bash_ship_name(shipp->ship_name, wingp->name, which_one + 1);
+				ship_rename_in_wing(shipnum, wingp->name, which_one + 1);
 				nprintf(("Network", "Created %s\n", shipp->ship_name));
 
 				objp = &Objects[shipp->objnum];
@@ -8,6 +8,7 @@
 */ 
 
 
+#include "debugconsole/console.h"
 #include "globalincs/linklist.h"
 #include "io/timer.h"
 #include "object/objcollide.h"
@@ -18,10 +19,9 @@
 #include "weapon/beam.h"
 #include "weapon/weapon.h"
 #include "tracing/Monitor.h"
+#include "utils/flat_hash_map.h"
 #include "utils/threading.h"
 
-#include <limits>
-
 
 // the next 2 variables are used for pair statistics
 // also in weapon.cpp there is Weapons_created.
@@ -30,6 +30,17 @@ int Num_pairs_checked = 0;
 
 SCP_vector<int> Collision_sort_list;
 
+// position of each object in Collision_sort_list, or -1 if it isn't in there
+static int Collision_sort_list_index[MAX_OBJECTS];
+// number of removed entries in Collision_sort_list which are still waiting to be compacted
+static size_t Collision_sort_list_holes = 0;
+// number of entries at the start of Collision_sort_list which were sorted during the last sweep and prune pass
+static size_t Collision_sort_list_sorted = 0;
+
+// use the persistent sweep and prune broadphase instead of re-sorting the colliders on every axis each frame
+bool Collision_sweep_and_prune = true;
+DCF_BOOL(sweep_and_prune, Collision_sweep_and_prune)
+
 static_assert(1 << collision_cache_bitshift > MAX_OBJECTS, "Collision pair caching currently relies on the highest possible objnum being less than 2^collision_cache_bitshift.");
 
 class collider_pair
@@ -50,7 +61,8 @@ public:
 };
 
 static SCP_set<object*> Collision_cache_stale_objects;
-static SCP_unordered_map<uint, collider_pair> Collision_cached_pairs;
+// pointers into this are only valid until the next insertion or erasure
+static util::flat_hash_map<uint, collider_pair> Collision_cached_pairs;
 
 class checkobject;
 extern checkobject CheckObjects[MAX_OBJECTS];
@@ -98,6 +110,7 @@ bool reject_due_collision_groups(object *A, object *B)
 
 MONITOR(NumPairs)
 MONITOR(NumPairsChecked)
+MONITOR(NumSweepAndPruneSwaps)
 
 //	See if two lines intersect by doing recursive subdivision.
 //	Bails out if larger distance traveled is less than sum of radii + 1.0f.
@@ -584,6 +597,7 @@ void obj_add_collider(int obj_index)
 		return;
 	}
 
+	Collision_sort_list_index[obj_index] = (int)Collision_sort_list.size();
 	Collision_sort_list.push_back(obj_index);
 
 	objp->flags.remove(Object::Object_Flags::Not_in_coll);
@@ -595,12 +609,14 @@ void obj_remove_collider(int obj_index)
     CheckObjects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
 #endif	
 
-	for (size_t i = 0; i < Collision_sort_list.size(); ++i ) {
-		if ( Collision_sort_list[i] == obj_index ) {
-			Collision_sort_list[i] = Collision_sort_list.back();
-			Collision_sort_list.pop_back();
-			break;
-		}
+	// Leave a hole instead of swapping in the last element, so the sort order of the list survives until the next
+	// compaction in obj_sort_and_collide()
+	int list_index = Collision_sort_list_index[obj_index];
+	if (list_index >= 0) {
+		Assertion(Collision_sort_list[list_index] == obj_index, "Collision sort list index of object %d is out of sync!", obj_index);
+		Collision_sort_list[list_index] = -1;
+		Collision_sort_list_index[obj_index] = -1;
+		Collision_sort_list_holes++;
 	}
 
 	Objects[obj_index].flags.set(Object::Object_Flags::Not_in_coll);
@@ -610,23 +626,24 @@ void obj_reset_colliders()
 {
 	Collision_sort_list.clear();
 	Collision_cached_pairs.clear();
+
+	std::fill(std::begin(Collision_sort_list_index), std::end(Collision_sort_list_index), -1);
+	Collision_sort_list_holes = 0;
+	Collision_sort_list_sorted = 0;
 }
 
 void obj_collide_retime_stale_pairs()
 {
 	TRACE_SCOPE(tracing::RetimeCollisionCache);
 
-	auto it = Collision_cached_pairs.begin();
-	while (it != Collision_cached_pairs.end()) {
-		auto &pair = it->second;
-		if (pair.signature_a != pair.a->signature || pair.signature_b != pair.b->signature) {
-			it = Collision_cached_pairs.erase(it);
-		} else {
-			if (pair.a->flags[Object::Object_Flags::Collision_cache_stale] || pair.b->flags[Object::Object_Flags::Collision_cache_stale])
-				pair.next_check_time = timestamp(0);
-			it++;
-		}
-	}
+	Collision_cached_pairs.erase_if([](uint, collider_pair &pair) {
+		if (pair.signature_a != pair.a->signature || pair.signature_b != pair.b->signature)
+			return true;
+
+		if (pair.a->flags[Object::Object_Flags::Collision_cache_stale] || pair.b->flags[Object::Object_Flags::Collision_cache_stale])
+			pair.next_check_time = timestamp(0);
+		return false;
+	});
 
 	for (auto objp : Collision_cache_stale_objects)
 		objp->flags.remove(Object::Object_Flags::Collision_cache_stale);
@@ -725,7 +742,9 @@ void obj_quicksort_colliders(SCP_vector<int> *list, int left, int right, int axi
     }
 }
 
-struct collision_thread_data {
+// A chunk of collision pairs which is handed to the job system as a whole, so that the per-job overhead is spread over several pairs.
+// Only the job that picked up the batch writes its results, so no locking is needed on either side.
+struct collision_job_batch {
 	struct collision_queue_item {
 		obj_pair objs;
 		uint ctype;
@@ -737,97 +756,93 @@ struct collision_thread_data {
 		void (*process_collision)( obj_pair *pair,  const std::any& collision_data );
 	};
 
-	std::atomic_size_t queue_length, result_length;
-	std::mutex queue_mutex, result_mutex;
-	std::unique_ptr<SCP_vector<collision_queue_item>> queue_load, queue_process;
-	std::unique_ptr<SCP_vector<collision_queue_result>> queue_results, queue_send;
-
-	collision_thread_data() :
-		queue_length(0),
-		result_length(0),
-		queue_load(std::make_unique<SCP_vector<collision_queue_item>>()),
-		queue_process(std::make_unique<SCP_vector<collision_queue_item>>()),
-		queue_results(std::make_unique<SCP_vector<collision_queue_result>>()),
-		queue_send(std::make_unique<SCP_vector<collision_queue_result>>()) {}
+	SCP_vector<collision_queue_item> queue;
+	SCP_vector<collision_queue_result> results;
 };
 
-std::unique_ptr<collision_thread_data[]> collision_thread_data_buffer;
-std::atomic_bool collision_processing_done = false;
+constexpr size_t COLLISION_JOB_BATCH_SIZE = 32;
 
-void spin_up_mp_collision() {
-	collision_processing_done.store(false);
-	threading::spin_up_threaded_task(threading::WorkerThreadTask::COLLISION);
+// batches are kept around between frames so their buffers don't need to be reallocated
+SCP_vector<std::unique_ptr<collision_job_batch>> Collision_job_batches;
+size_t Collision_job_batches_used = 0;
+collision_job_batch* Collision_job_current_batch = nullptr;
+threading::job_counter Collision_jobs;
+
+void collide_mp_worker_batch(collision_job_batch& batch) {
+	for (auto& collision_check : batch.queue) {
+		collision_result (*check_collision)( obj_pair *pair ) = nullptr;
+
+		switch( collision_check.ctype )	{
+			case COLLISION_OF(OBJ_WEAPON, OBJ_SHIP):
+			case COLLISION_OF(OBJ_SHIP, OBJ_WEAPON):
+				check_collision = collide_ship_weapon_check;
+				break;
+			case COLLISION_OF(OBJ_SHIP, OBJ_SHIP):
+				check_collision = collide_ship_ship_check;
+				break;
+			default:
+				UNREACHABLE("Got non MP-compatible collision type!");
+		}
+
+		auto&& [check_again, collision_data_maybe, collision_fnc] = check_collision(&collision_check.objs);
+
+		batch.results.emplace_back(collision_job_batch::collision_queue_result{collision_check.objs, check_again, collision_data_maybe, collision_fnc});
+	}
 }
 
-void spin_down_mp_collision() {
-	threading::spin_down_threaded_task();
-	collision_processing_done.store(true);
+void submit_mp_collision_batch() {
+	if (Collision_job_current_batch == nullptr)
+		return;
+
+	auto batch = Collision_job_current_batch;
+	Collision_job_current_batch = nullptr;
+
+	threading::submit_job([batch]() { collide_mp_worker_batch(*batch); }, &Collision_jobs);
 }
 
 void queue_mp_collision(uint ctype, const obj_pair& colliding) {
-	size_t min_queue_length = std::numeric_limits<size_t>::max();
-	size_t target_thread = 0;
-	for (size_t i = 0; i < threading::get_num_workers(); i++) {
-		size_t queue_length = collision_thread_data_buffer[i].queue_length.load(std::memory_order_acquire);
-		if (queue_length == 0) {
-			target_thread = i;
-			break;
-		}
-		else if (queue_length < min_queue_length) {
-			target_thread = i;
-			min_queue_length = queue_length;
-		}
-	}
-	{
-		auto& thread = collision_thread_data_buffer[target_thread];
-		std::scoped_lock lock(thread.queue_mutex);
-		thread.queue_load->emplace_back( collision_thread_data::collision_queue_item{colliding, ctype} );
-		thread.queue_length.fetch_add(1, std::memory_order_release);
+	if (Collision_job_current_batch == nullptr) {
+		if (Collision_job_batches_used == Collision_job_batches.size())
+			Collision_job_batches.push_back(std::make_unique<collision_job_batch>());
+
+		Collision_job_current_batch = Collision_job_batches[Collision_job_batches_used++].get();
 	}
+
+	Collision_job_current_batch->queue.emplace_back( collision_job_batch::collision_queue_item{colliding, ctype} );
+
+	if (Collision_job_current_batch->queue.size() >= COLLISION_JOB_BATCH_SIZE)
+		submit_mp_collision_batch();
 }
 
 void post_process_threaded_collisions() {
-	SCP_map<size_t, size_t> workerThreads;
-	for (size_t i = 0; i < threading::get_num_workers(); i++)
-		workerThreads.emplace(i, 0);
+	submit_mp_collision_batch();
+	threading::wait_for(Collision_jobs);
 
-	while (!workerThreads.empty()) {
-		for(auto& [i, processed] : workerThreads) {
-			auto& thread = collision_thread_data_buffer[i];
+	// Batches are merged in the order they were queued in, and each batch keeps the order of its pairs, so the
+	// outcome doesn't depend on the number of threads or on which worker ended up with which batch.
+	// This matters for multiplayer, where every client has to resolve the same collisions in the same order.
+	for (size_t i = 0; i < Collision_job_batches_used; i++) {
+		auto& batch = *Collision_job_batches[i];
 
-			size_t queue_length = thread.queue_length.load(std::memory_order_acquire);
-			size_t result_length = thread.result_length.load(std::memory_order_acquire);
+		for (auto& collision : batch.results) {
+			if (collision.collision_data.has_value())
+				collision.process_collision(&collision.objs, collision.collision_data);
 
-			if (result_length > processed) {
-				{
-					std::scoped_lock lock(thread.result_mutex);
-					thread.queue_results.swap(thread.queue_send);
-				}
-				for (auto& collision : *thread.queue_send) {
-					uint key = (OBJ_INDEX(collision.objs.a) << collision_cache_bitshift) + OBJ_INDEX(collision.objs.b);
-					collider_pair *collision_info = &Collision_cached_pairs[key];
-
-					if (collision.collision_data.has_value())
-						collision.process_collision(&collision.objs, collision.collision_data);
-
-					if (collision.never_recheck) {
-						collision_info->next_check_time = -1;
-					} else {
-						collision_info->next_check_time = collision.objs.next_check_time;
-					}
-				}
-				processed += thread.queue_send->size();
-				thread.queue_send->clear();
-			}
-			else if (queue_length == 0) {
-				thread.queue_results->clear();
-				workerThreads.erase(i);
-				break;
+			uint key = (OBJ_INDEX(collision.objs.a) << collision_cache_bitshift) + OBJ_INDEX(collision.objs.b);
+			collider_pair *collision_info = &Collision_cached_pairs[key];
+
+			if (collision.never_recheck) {
+				collision_info->next_check_time = -1;
+			} else {
+				collision_info->next_check_time = collision.objs.next_check_time;
 			}
 		}
+
+		batch.queue.clear();
+		batch.results.clear();
 	}
 
-	spin_down_mp_collision();
+	Collision_job_batches_used = 0;
 }
 
 void obj_collide_pair(object *A, object *B)
@@ -1086,11 +1101,19 @@ void obj_collide_pair(object *A, object *B)
     new_pair.b = B;
     new_pair.next_check_time = collision_info->next_check_time;
 
-	if (threading::is_threading() && support_mp) {
+	Num_pairs_checked++;
+
+	// Collisions which can be checked on another thread are always deferred, even without worker threads, so that they
+	// get resolved in the same order no matter how many threads are available
+	if (support_mp) {
 		queue_mp_collision(ctype, new_pair);
 	}
 	else {
-		if (check_collision(&new_pair)) {
+		int never_check_again = check_collision(&new_pair);
+
+		// look the pair up again, the collision may have touched the cache
+		collision_info = &Collision_cached_pairs[key];
+		if (never_check_again) {
 			// don't have to check ever again
 			collision_info->next_check_time = -1;
 		} else {
@@ -1122,6 +1145,7 @@ void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<in
                 }
 
                 if ( collide ) {
+                    Num_pairs++;
                     obj_collide_pair(&Objects[in_index], &Objects[overlappers[j]]);
                 }
             } else {
@@ -1145,53 +1169,133 @@ void obj_find_overlap_colliders(SCP_vector<int> &overlap_list_out, SCP_vector<in
     }
 }
 
-} //anon namespace
+struct collider_bounds {
+	int objnum;
+	float min[3];
+	float max[3];
+};
 
-void collide_mp_worker_thread(size_t threadIdx) {
-	auto& thread = collision_thread_data_buffer[threadIdx];
-	thread.result_length.store(0);
-
-	while (!thread.queue_process->empty() || thread.queue_length.load(std::memory_order_acquire) > 0 || !collision_processing_done.load(std::memory_order_acquire)) {
-		if (!thread.queue_process->empty()) {
-
-			for (auto& collision_check : *thread.queue_process) {
-				collision_result (*check_collision)( obj_pair *pair ) = nullptr;
-
-				switch( collision_check.ctype )	{
-					case COLLISION_OF(OBJ_WEAPON, OBJ_SHIP):
-					case COLLISION_OF(OBJ_SHIP, OBJ_WEAPON):
-						check_collision = collide_ship_weapon_check;
-						break;
-					case COLLISION_OF(OBJ_SHIP, OBJ_SHIP):
-						check_collision = collide_ship_ship_check;
-						break;
-					default:
-						UNREACHABLE("Got non MP-compatible collision type!");
-				}
+// used only by the sweep and prune broadphase, kept around so it doesn't need to be reallocated every frame
+SCP_vector<collider_bounds> Collider_bounds;
+
+void obj_get_collider_bounds(collider_bounds &bounds, int obj_num)
+{
+	bounds.objnum = obj_num;
+
+	for (int axis = 0; axis < 3; ++axis) {
+		bounds.min[axis] = obj_get_collider_endpoint(obj_num, axis, true);
+		bounds.max[axis] = obj_get_collider_endpoint(obj_num, axis, false);
+	}
+}
+
+// Removes the holes left behind by obj_remove_collider() without changing the order of the remaining colliders
+void obj_compact_collision_sort_list()
+{
+	if (Collision_sort_list_holes == 0)
+		return;
+
+	size_t out = 0;
+	for (size_t i = 0; i < Collision_sort_list.size(); ++i) {
+		int objnum = Collision_sort_list[i];
+
+		if (objnum < 0) {
+			if (i < Collision_sort_list_sorted)
+				Collision_sort_list_sorted--;
+			continue;
+		}
+
+		Collision_sort_list[out] = objnum;
+		Collision_sort_list_index[objnum] = (int)out;
+		out++;
+	}
+
+	Collision_sort_list.resize(out);
+	Collision_sort_list_holes = 0;
+}
+
+// Sweep and prune along the x axis, using the order of the previous frame as the starting point for the sort.
+// Since objects don't move much from one frame to the next, the insertion sort only has to do a few swaps, and
+// the pairs are emitted directly once their bounds overlap on all three axes.
+void obj_sweep_and_prune_colliders(SCP_vector<int> &list, bool persistent)
+{
+	auto &bounds = Collider_bounds;
+	bounds.resize(list.size());
+
+	{
+		TRACE_SCOPE(tracing::SortColliders);
+
+		for (size_t i = 0; i < list.size(); ++i) {
+			obj_get_collider_bounds(bounds[i], list[i]);
+		}
 
-				auto&& [check_again, collision_data_maybe, collision_fnc] = check_collision(&collision_check.objs);
+		auto min_x_less = [](const collider_bounds &a, const collider_bounds &b) { return a.min[0] < b.min[0]; };
 
-				{
-					std::scoped_lock lock{thread.result_mutex};
-					thread.queue_results->emplace_back(collision_thread_data::collision_queue_result{collision_check.objs, check_again, collision_data_maybe, collision_fnc});
+		if (persistent) {
+			// everything before sorted_end was in order last frame, so insertion sort is cheap here
+			auto sorted_end = bounds.begin() + std::min(Collision_sort_list_sorted, bounds.size());
+			int num_swaps = 0;
+
+			for (auto it = bounds.begin(); it != sorted_end; ++it) {
+				collider_bounds current = *it;
+				auto hole = it;
+
+				while (hole != bounds.begin() && current.min[0] < (hole - 1)->min[0]) {
+					*hole = *(hole - 1);
+					--hole;
+					num_swaps++;
 				}
-				thread.result_length.fetch_add(1, std::memory_order_release);
-				thread.queue_length.fetch_sub(1, std::memory_order_release);
+
+				*hole = current;
 			}
-			thread.queue_process->clear();
+
+			// objects added since the last frame have no sensible position yet, so sort them on their own and merge
+			if (sorted_end != bounds.end()) {
+				std::sort(sorted_end, bounds.end(), min_x_less);
+				std::inplace_merge(bounds.begin(), sorted_end, bounds.end(), min_x_less);
+			}
+
+			mon_NumSweepAndPruneSwaps = num_swaps;
+		} else {
+			std::sort(bounds.begin(), bounds.end(), min_x_less);
+		}
+
+		for (size_t i = 0; i < bounds.size(); ++i) {
+			list[i] = bounds[i].objnum;
+
+			if (persistent)
+				Collision_sort_list_index[list[i]] = (int)i;
 		}
-		else if (thread.queue_length.load(std::memory_order_acquire) > 0) {
-			//We must have data in the load queue then.
-			std::scoped_lock lock(thread.queue_mutex);
-			thread.queue_load.swap(thread.queue_process);
-			thread.queue_load->clear();
+
+		if (persistent)
+			Collision_sort_list_sorted = list.size();
+	}
+
+	TRACE_SCOPE(tracing::FindOverlapColliders);
+
+	// Collision pairs may create new colliders so only work with the bounds copy from here on
+	for (size_t i = 0; i < bounds.size(); ++i) {
+		const auto &a = bounds[i];
+
+		for (size_t j = i + 1; j < bounds.size() && bounds[j].min[0] <= a.max[0]; ++j) {
+			const auto &b = bounds[j];
+
+			if (b.min[1] > a.max[1] || a.min[1] > b.max[1])
+				continue;
+			if (b.min[2] > a.max[2] || a.min[2] > b.max[2])
+				continue;
+
+			Num_pairs++;
+			obj_collide_pair(&Objects[b.objnum], &Objects[a.objnum]);
 		}
 	}
 }
 
+} //anon namespace
+
 void collide_init() {
-	if (threading::is_threading())
-		collision_thread_data_buffer = std::make_unique<collision_thread_data[]>(threading::get_num_workers());
+	Collision_job_batches.clear();
+	Collision_job_batches_used = 0;
+	Collision_job_current_batch = nullptr;
 }
 
 // used only in obj_sort_and_collide()
@@ -1206,42 +1310,60 @@ void obj_sort_and_collide(SCP_vector<int>* Collision_list)
 	if ( !(Game_detail_flags & DETAIL_FLAG_COLLISION) )
 		return;
 
-	if (threading::is_threading())
-		spin_up_mp_collision();
-
 	if (!Collision_cache_stale_objects.empty()) {
 		obj_collide_retime_stale_pairs();
 	}
 
+	obj_compact_collision_sort_list();
+
+	Num_pairs = 0;
+	Num_pairs_checked = 0;
+
 	// the main use case is to go through the main Collision detection list, so use that if
 	// nothing is defined.
 	if (Collision_list == nullptr) {
 		Collision_list = &Collision_sort_list;
 	}
 
-	sort_list_y.clear();
-	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(Collision_list, 0, (int)(Collision_list->size() - 1), 0);
-	}
-	obj_find_overlap_colliders(sort_list_y, *Collision_list, 0, false);
+	if (Collision_sweep_and_prune) {
+		obj_sweep_and_prune_colliders(*Collision_list, Collision_list == &Collision_sort_list);
+	} else {
+		sort_list_y.clear();
+		{
+			TRACE_SCOPE(tracing::SortColliders);
+			obj_quicksort_colliders(Collision_list, 0, (int)(Collision_list->size() - 1), 0);
+		}
+		obj_find_overlap_colliders(sort_list_y, *Collision_list, 0, false);
 
-	sort_list_z.clear();
-	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_y, 0, (int)(sort_list_y.size() - 1), 1);
-	}
-	obj_find_overlap_colliders(sort_list_z, sort_list_y, 1, false);
+		sort_list_z.clear();
+		{
+			TRACE_SCOPE(tracing::SortColliders);
+			obj_quicksort_colliders(&sort_list_y, 0, (int)(sort_list_y.size() - 1), 1);
+		}
+		obj_find_overlap_colliders(sort_list_z, sort_list_y, 1, false);
 
-	sort_list_y.clear();
-	{
-		TRACE_SCOPE(tracing::SortColliders);
-		obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
+		sort_list_y.clear();
+		{
+			TRACE_SCOPE(tracing::SortColliders);
+			obj_quicksort_colliders(&sort_list_z, 0, (int)(sort_list_z.size() - 1), 2);
+		}
+		obj_find_overlap_colliders(sort_list_y, sort_list_z, 2, true);
+
+		if (Collision_list == &Collision_sort_list) {
+			// the quicksort shuffled the list, so the positions need updating and the order is no use for sweep and prune.
+			// Colliders removed by the collision pairs have left holes, those are compacted next frame.
+			for (size_t i = 0; i < Collision_sort_list.size(); ++i) {
+				if (Collision_sort_list[i] >= 0)
+					Collision_sort_list_index[Collision_sort_list[i]] = (int)i;
+			}
+			Collision_sort_list_sorted = 0;
+		}
 	}
-	obj_find_overlap_colliders(sort_list_y, sort_list_z, 2, true);
 
-	if (threading::is_threading())
-		post_process_threaded_collisions();
+	post_process_threaded_collisions();
+
+	mon_NumPairs = Num_pairs;
+	mon_NumPairsChecked = Num_pairs_checked;
 }
 
 void collide_apply_gravity_flags_weapons() {
@@ -130,8 +130,6 @@ int collide_ship_ship( obj_pair * pair );
 //Same as above, but for deferred collision processing / usage in multithreading
 collision_result collide_ship_ship_check( obj_pair * pair );
 
-void collide_mp_worker_thread(size_t threadIdx);
-
 //	Predictive functions.
 //	Returns true if vector from curpos to goalpos with radius radius will collide with object goalobjp
 int pp_collide(vec3d *curpos, vec3d *goalpos, object *goalobjp, float radius);
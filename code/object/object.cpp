@@ -10,6 +10,7 @@
 
 
 
+#include "ai/ai.h"
 #include "asteroid/asteroid.h"
 #include "cmeasure/cmeasure.h"
 #include "debris/debris.h"
@@ -32,6 +33,7 @@
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "observer/observer.h"
@@ -707,6 +709,7 @@ void obj_delete(int objnum)
 			while(moveup != END_OF_LIST(&Ship_obj_list)){
 				if(OBJ_INDEX(objp) == moveup->objnum){
 					list_remove(&Ship_obj_list,moveup);
+					obj_grid_remove(objp);
 					break;
 				}
 				moveup = GET_NEXT(moveup);
@@ -1572,6 +1575,12 @@ void obj_move_all(float frametime)
 
 	obj_merge_created_list();
 
+	// From here on, target acquisition looks up ships and missiles in the grids, which are kept up to date as they move
+	obj_grid_build();
+
+	// With -parallel_ai, AI ships which need a target pick one now, based on where everything is at the start of the frame
+	ai_decide_targets();
+
 	// Clear the table that tells which groups of weapons have cast light so far.
 	if(!(Game_mode & GM_MULTIPLAYER) || (MULTIPLAYER_MASTER)) {
 		obj_clear_weapon_group_id_list();
@@ -1687,6 +1696,8 @@ void obj_move_all(float frametime)
 		// move post
 		obj_move_all_post(objp, frametime);
 
+		obj_grid_update(objp);
+
 		// Equipment script processing
 		if (objp->type == OBJ_SHIP) {
 			ship* shipp = &Ships[objp->instance];
@@ -1713,6 +1724,10 @@ void obj_move_all(float frametime)
 	// but there isn't really a good place to put this, it doesn't hurt to have this here, and it's conceptually related to what's here.
 	model_do_intrinsic_motions(nullptr);
 
+	// Docked objects are moved below without updating the grids
+	obj_grid_deactivate();
+	ai_discard_target_decisions();
+
 	//	After all objects have been moved, move all docked objects.
 	for (objp = GET_FIRST(&obj_used_list); objp != END_OF_LIST(&obj_used_list); objp = GET_NEXT(objp)) {
 		// skip objects which should be dead
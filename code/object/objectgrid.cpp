@@ -0,0 +1,361 @@
+
+#include "object/objectgrid.h"
+
+#include "math/vecmat.h"
+#include "model/model.h"
+#include "object/object.h"
+#include "ship/ship.h"
+#include "weapon/weapon.h"
+
+#include <cmath>
+
+namespace {
+// Cells are limited to 21 bits per axis so that the three coordinates fit into a 64 bit key
+const int MAX_CELL_COORD = (1 << 20) - 1;
+const int MIN_CELL_COORD = -(1 << 20);
+
+// About the range of a fighter's guns, big enough that most ships fit into a single cell
+const float OBJ_GRID_CELL_SIZE = 2000.0f;
+
+// Distances are compared without square roots here, so leave some room for rounding errors
+const float DISTANCE_TOLERANCE = 1.001f;
+// The same for the cosines of angles
+const float COSINE_TOLERANCE = 0.001f;
+
+object_grid Ship_grid(OBJ_GRID_CELL_SIZE);
+object_grid Missile_grid(OBJ_GRID_CELL_SIZE);
+
+bool Obj_grid_active = false;
+
+// The distance of the bounding box corner farthest from the center, the bounding sphere radius doesn't always contain
+// the box
+float ship_grid_bound(const object* objp)
+{
+	auto pm = model_get(Ship_info[Ships[objp->instance].ship_info_index].model_num);
+
+	vec3d corner;
+	corner.xyz.x = MAX(fl_abs(pm->mins.xyz.x), fl_abs(pm->maxs.xyz.x));
+	corner.xyz.y = MAX(fl_abs(pm->mins.xyz.y), fl_abs(pm->maxs.xyz.y));
+	corner.xyz.z = MAX(fl_abs(pm->mins.xyz.z), fl_abs(pm->maxs.xyz.z));
+
+	return MAX(objp->radius, vm_vec_mag(&corner));
+}
+
+void ship_grid_add(const object* objp)
+{
+	Ship_grid.add(OBJ_INDEX(objp), objp->pos, ship_grid_bound(objp), Ships[objp->instance].flags[Ship::Ship_Flags::Stealth]);
+}
+
+void ship_grid_update(const object* objp)
+{
+	Ship_grid.update(OBJ_INDEX(objp), objp->pos, ship_grid_bound(objp), Ships[objp->instance].flags[Ship::Ship_Flags::Stealth]);
+}
+}
+
+object_grid::object_grid(float cell_size) : _cell_size(cell_size) {
+}
+
+int object_grid::cellCoord(float value) const {
+	auto coord = std::floor(value / _cell_size);
+
+	// written so that NaN ends up in a valid cell as well
+	if (!(coord >= static_cast<float>(MIN_CELL_COORD))) {
+		return MIN_CELL_COORD;
+	}
+	if (coord > static_cast<float>(MAX_CELL_COORD)) {
+		return MAX_CELL_COORD;
+	}
+	return static_cast<int>(coord);
+}
+
+uint64_t object_grid::cellKey(int x, int y, int z) {
+	const uint64_t mask = (1 << 21) - 1;
+
+	return ((static_cast<uint64_t>(x - MIN_CELL_COORD) & mask) << 42) |
+		   ((static_cast<uint64_t>(y - MIN_CELL_COORD) & mask) << 21) |
+		   (static_cast<uint64_t>(z - MIN_CELL_COORD) & mask);
+}
+
+void object_grid::link(int objnum) {
+	auto& e = _entries[objnum];
+
+	e.binned = !e.always_include && e.bound <= _cell_size * 0.5f;
+	if (e.binned) {
+		e.cell = cellKey(cellCoord(e.pos.xyz.x), cellCoord(e.pos.xyz.y), cellCoord(e.pos.xyz.z));
+		_cells[e.cell].push_back(objnum);
+	} else {
+		_unbinned.push_back(objnum);
+	}
+}
+
+void object_grid::unlink(int objnum) {
+	auto& e = _entries[objnum];
+
+	if (e.binned) {
+		auto iter = _cells.find(e.cell);
+		Assertion(iter != _cells.end(), "Object %d is not in the cell it has been filed under!", objnum);
+
+		auto& cell = iter->second;
+		cell.erase(std::find(cell.begin(), cell.end(), objnum));
+		if (cell.empty()) {
+			_cells.erase(iter);
+		}
+	} else {
+		_unbinned.erase(std::find(_unbinned.begin(), _unbinned.end(), objnum));
+	}
+}
+
+void object_grid::clear() {
+	_entries.clear();
+	_cells.clear();
+	_unbinned.clear();
+	_num_entries = 0;
+	_next_order = 0;
+}
+
+void object_grid::add(int objnum, const vec3d& pos, float bound, bool always_include) {
+	Assertion(objnum >= 0, "Invalid object number %d!", objnum);
+
+	if (objnum >= static_cast<int>(_entries.size())) {
+		_entries.resize(objnum + 1);
+	}
+
+	auto& e = _entries[objnum];
+	Assertion(!e.used, "Object %d has been added to the grid twice!", objnum);
+
+	e.used = true;
+	e.always_include = always_include;
+	e.order = _next_order++;
+	e.pos = pos;
+	e.bound = bound;
+
+	link(objnum);
+	++_num_entries;
+}
+
+void object_grid::remove(int objnum) {
+	if (!contains(objnum)) {
+		return;
+	}
+
+	unlink(objnum);
+	_entries[objnum].used = false;
+	--_num_entries;
+}
+
+void object_grid::update(int objnum, const vec3d& pos, float bound, bool always_include) {
+	Assertion(contains(objnum), "Object %d is not in the grid!", objnum);
+
+	auto& e = _entries[objnum];
+
+	// Objects usually stay in their cell from one frame to the next
+	if (e.binned && !always_include && bound <= _cell_size * 0.5f &&
+		e.cell == cellKey(cellCoord(pos.xyz.x), cellCoord(pos.xyz.y), cellCoord(pos.xyz.z))) {
+		e.pos = pos;
+		e.bound = bound;
+		return;
+	}
+
+	unlink(objnum);
+	e.pos = pos;
+	e.bound = bound;
+	e.always_include = always_include;
+	link(objnum);
+}
+
+bool object_grid::contains(int objnum) const {
+	return objnum >= 0 && objnum < static_cast<int>(_entries.size()) && _entries[objnum].used;
+}
+
+int object_grid::getNumObjects() const {
+	return _num_entries;
+}
+
+bool object_grid::mayIntersect(const entry& e, const vec3d& center, float radius) const {
+	if (e.always_include) {
+		return true;
+	}
+
+	auto max_dist = (radius + e.bound) * DISTANCE_TOLERANCE;
+	return vm_vec_dist_squared(&e.pos, &center) <= max_dist * max_dist;
+}
+
+void object_grid::querySphere(const vec3d& center, float radius, SCP_vector<int>& objnums) const {
+	objnums.clear();
+
+	for (auto objnum : _unbinned) {
+		if (mayIntersect(_entries[objnum], center, radius)) {
+			objnums.push_back(objnum);
+		}
+	}
+
+	// Binned objects are at most half a cell away from the center of their bounding sphere
+	auto extent = radius + _cell_size * 0.5f;
+	int min_x = cellCoord(center.xyz.x - extent), max_x = cellCoord(center.xyz.x + extent);
+	int min_y = cellCoord(center.xyz.y - extent), max_y = cellCoord(center.xyz.y + extent);
+	int min_z = cellCoord(center.xyz.z - extent), max_z = cellCoord(center.xyz.z + extent);
+
+	auto num_query_cells = static_cast<int64_t>(max_x - min_x + 1) * (max_y - min_y + 1) * (max_z - min_z + 1);
+
+	auto add_cell = [&](const SCP_vector<int>& cell) {
+		for (auto objnum : cell) {
+			if (mayIntersect(_entries[objnum], center, radius)) {
+				objnums.push_back(objnum);
+			}
+		}
+	};
+
+	if (num_query_cells > static_cast<int64_t>(_cells.size())) {
+		// A long range query, it's cheaper to look at every occupied cell
+		for (auto& cell : _cells) {
+			add_cell(cell.second);
+		}
+	} else {
+		for (int x = min_x; x <= max_x; ++x) {
+			for (int y = min_y; y <= max_y; ++y) {
+				for (int z = min_z; z <= max_z; ++z) {
+					auto iter = _cells.find(cellKey(x, y, z));
+					if (iter != _cells.end()) {
+						add_cell(iter->second);
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(objnums.begin(), objnums.end(), [this](int a, int b) { return _entries[a].order < _entries[b].order; });
+}
+
+void object_grid::queryCone(const vec3d& apex, const vec3d& dir, float length, float cos_half_angle, SCP_vector<int>& objnums) const {
+	querySphere(apex, length, objnums);
+
+	auto half_angle = acosf(std::clamp(cos_half_angle, -1.0f, 1.0f));
+
+	auto outside_cone = [&](int objnum) {
+		auto& e = _entries[objnum];
+		if (e.always_include) {
+			return false;
+		}
+
+		vec3d to_object;
+		vm_vec_sub(&to_object, &e.pos, &apex);
+		auto dist = vm_vec_mag(&to_object);
+
+		auto bound = e.bound * DISTANCE_TOLERANCE;
+		if (dist <= bound) {
+			return false;
+		}
+
+		auto cos_angle = std::clamp(vm_vec_dot(&to_object, &dir) / dist, -1.0f, 1.0f);
+		if (cos_angle + bound / (dist + bound) + COSINE_TOLERANCE >= cos_half_angle) {
+			return false;
+		}
+
+		// The bounding sphere covers this angle around the direction to the object
+		auto angle = acosf(cos_angle) - asinf(bound / dist);
+
+		return angle > half_angle * DISTANCE_TOLERANCE;
+	};
+
+	objnums.erase(std::remove_if(objnums.begin(), objnums.end(), outside_cone), objnums.end());
+}
+
+void obj_grid_build()
+{
+	Ship_grid.clear();
+	Missile_grid.clear();
+
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		ship_grid_add(&Objects[so->objnum]);
+	}
+
+	for (auto mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo)) {
+		auto objp = &Objects[mo->objnum];
+		Missile_grid.add(mo->objnum, objp->pos, objp->radius);
+	}
+
+	Obj_grid_active = true;
+}
+
+void obj_grid_deactivate()
+{
+	Obj_grid_active = false;
+}
+
+void obj_grid_add(const object *objp)
+{
+	if (!Obj_grid_active) {
+		return;
+	}
+
+	// Both lists append new objects, so they also go after everything else in the grid
+	if (objp->type == OBJ_SHIP) {
+		ship_grid_add(objp);
+	} else if (objp->type == OBJ_WEAPON) {
+		Missile_grid.add(OBJ_INDEX(objp), objp->pos, objp->radius);
+	}
+}
+
+void obj_grid_remove(const object *objp)
+{
+	if (!Obj_grid_active) {
+		return;
+	}
+
+	// The type may already have changed, e.g. for the player ship becoming a ghost
+	Ship_grid.remove(OBJ_INDEX(objp));
+	Missile_grid.remove(OBJ_INDEX(objp));
+}
+
+void obj_grid_update(const object *objp)
+{
+	if (!Obj_grid_active) {
+		return;
+	}
+
+	auto objnum = OBJ_INDEX(objp);
+	if (Ship_grid.contains(objnum)) {
+		ship_grid_update(objp);
+	} else if (Missile_grid.contains(objnum)) {
+		Missile_grid.update(objnum, objp->pos, objp->radius);
+	}
+}
+
+void obj_grid_query_ships(const vec3d *pos, float range, SCP_vector<int> &objnums)
+{
+	if (Obj_grid_active) {
+		Ship_grid.querySphere(*pos, range, objnums);
+		return;
+	}
+
+	objnums.clear();
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		objnums.push_back(so->objnum);
+	}
+}
+
+void obj_grid_query_ships_in_cone(const vec3d *apex, const vec3d *dir, float length, float cos_half_angle, SCP_vector<int> &objnums)
+{
+	if (Obj_grid_active) {
+		Ship_grid.queryCone(*apex, *dir, length, cos_half_angle, objnums);
+		return;
+	}
+
+	objnums.clear();
+	for (auto so = GET_FIRST(&Ship_obj_list); so != END_OF_LIST(&Ship_obj_list); so = GET_NEXT(so)) {
+		objnums.push_back(so->objnum);
+	}
+}
+
+void obj_grid_query_missiles(const vec3d *pos, float range, SCP_vector<int> &objnums)
+{
+	if (Obj_grid_active) {
+		Missile_grid.querySphere(*pos, range, objnums);
+		return;
+	}
+
+	objnums.clear();
+	for (auto mo = GET_FIRST(&Missile_obj_list); mo != END_OF_LIST(&Missile_obj_list); mo = GET_NEXT(mo)) {
+		objnums.push_back(mo->objnum);
+	}
+}
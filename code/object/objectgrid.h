@@ -0,0 +1,139 @@
+#ifndef _OBJECTGRID_H
+#define _OBJECTGRID_H
+
+#include "globalincs/pstypes.h"
+
+class object;
+
+/**
+ * @brief A spatial hash of objects, used to find the candidates for target acquisition
+ *
+ * Every object is stored with its position and a bound, the radius of a sphere around its position which contains all
+ * of the object the caller cares about. The space is divided into cubic cells and each object is filed under the cell
+ * its position is in, so a query only has to look at the cells which overlap the query sphere. Objects whose bound is
+ * larger than half a cell, and objects which have been added with always_include, are kept in a separate list which is
+ * looked at by every query.
+ *
+ * Queries return the objects in the order they have been added in, so a caller which walks the result gets the same
+ * tie-breaking as one which walks the list the objects have been added from.
+ */
+class object_grid {
+	struct entry {
+		bool used = false;
+		bool binned = false;
+		bool always_include = false;
+		int order = 0;
+		vec3d pos = {};
+		float bound = 0.0f;
+		uint64_t cell = 0;
+	};
+
+	float _cell_size;
+	int _next_order = 0;
+
+	SCP_vector<entry> _entries;
+	SCP_unordered_map<uint64_t, SCP_vector<int>> _cells;
+	SCP_vector<int> _unbinned;
+	int _num_entries = 0;
+
+	int cellCoord(float value) const;
+	static uint64_t cellKey(int x, int y, int z);
+
+	void unlink(int objnum);
+	void link(int objnum);
+
+	bool mayIntersect(const entry& e, const vec3d& center, float radius) const;
+
+ public:
+	explicit object_grid(float cell_size);
+
+	//! Removes all objects and restarts the insertion order
+	void clear();
+
+	/**
+	 * @brief Adds an object after all objects which are already in the grid
+	 *
+	 * @param objnum The object number, must not be in the grid yet
+	 * @param pos The position the object is filed under
+	 * @param bound The radius of the sphere around pos the object occupies
+	 * @param always_include If true, every query returns the object regardless of its position
+	 */
+	void add(int objnum, const vec3d& pos, float bound, bool always_include = false);
+
+	//! Removes an object, does nothing if it isn't in the grid
+	void remove(int objnum);
+
+	//! Changes the position and bound of an object which is in the grid, keeping its place in the order
+	void update(int objnum, const vec3d& pos, float bound, bool always_include = false);
+
+	bool contains(int objnum) const;
+
+	int getNumObjects() const;
+
+	/**
+	 * @brief Finds the objects whose bound may intersect a sphere
+	 *
+	 * The result contains every object whose bound intersects the sphere, and may contain a few which don't, so the
+	 * caller still has to do its own distance checks.
+	 *
+	 * @param[in] center The center of the sphere
+	 * @param[in] radius The radius of the sphere
+	 * @param[out] objnums The objects, in insertion order
+	 */
+	void querySphere(const vec3d& center, float radius, SCP_vector<int>& objnums) const;
+
+	/**
+	 * @brief Finds the objects whose bound may intersect a cone
+	 *
+	 * Besides the bounding sphere, an object is returned if the cosine of its angle to the axis plus bound / (distance
+	 * + bound) reaches cos_half_angle. That is the allowance turret_fov_test() makes for the size of an object, which
+	 * is larger than the sphere for narrow cones.
+	 *
+	 * @param[in] apex The apex of the cone
+	 * @param[in] dir The normalized direction of the axis of the cone
+	 * @param[in] length The length of the cone, measured from the apex
+	 * @param[in] cos_half_angle The cosine of the angle between the axis and the side of the cone
+	 * @param[out] objnums The objects, in insertion order
+	 */
+	void queryCone(const vec3d& apex, const vec3d& dir, float length, float cos_half_angle, SCP_vector<int>& objnums) const;
+};
+
+/**
+ * @brief Files all ships and missiles in the grids used for target acquisition
+ *
+ * Called by obj_move_all before the objects are moved. Until obj_grid_deactivate is called, the list hooks and
+ * obj_grid_update keep the grids in sync with Ship_obj_list and Missile_obj_list.
+ */
+void obj_grid_build();
+
+//! Stops using the grids, the queries walk the object lists again
+void obj_grid_deactivate();
+
+//! Files an object which has just been added to Ship_obj_list or Missile_obj_list
+void obj_grid_add(const object *objp);
+
+//! Removes an object which has just been removed from Ship_obj_list or Missile_obj_list
+void obj_grid_remove(const object *objp);
+
+//! Refiles an object after it has been moved
+void obj_grid_update(const object *objp);
+
+/**
+ * @brief Finds the ships which may be within a distance of a point
+ *
+ * A ship may be within the distance if its bounding sphere or its bounding box is. Stealth ships are always returned,
+ * since targeting them involves more than their distance.
+ *
+ * @param[in] pos The point
+ * @param[in] range The distance
+ * @param[out] objnums The ships, in Ship_obj_list order. Ships which should be dead are included.
+ */
+void obj_grid_query_ships(const vec3d *pos, float range, SCP_vector<int> &objnums);
+
+//! Like obj_grid_query_ships, but for ships within a cone, see object_grid::queryCone
+void obj_grid_query_ships_in_cone(const vec3d *apex, const vec3d *dir, float length, float cos_half_angle, SCP_vector<int> &objnums);
+
+//! Finds the missiles whose bounding sphere may be within a distance of a point, in Missile_obj_list order
+void obj_grid_query_missiles(const vec3d *pos, float range, SCP_vector<int> &objnums);
+
+#endif
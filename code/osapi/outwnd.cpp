@@ -11,6 +11,7 @@
 #include <cstdarg>
 #include <cstring>
 #include <algorithm>
+#include <mutex>
 
 #ifdef WIN32
 #include <direct.h>
@@ -62,6 +63,10 @@ static const char* FreeSpace_logfilename = nullptr;
 
 static std::unique_ptr<osapi::DebugWindow> debugWindow;
 
+// Jobs on the worker threads may print as well, e.g. the FFmpeg log of sounds decoded in the background.
+// Recursive since outwnd_print calls itself for the missing filter file notice.
+static std::recursive_mutex Outwnd_print_mutex;
+
 void load_filter_info()
 {
 	FILE* fp;
@@ -201,6 +206,8 @@ void outwnd_print(const char *id, const char *tmp)
 	if (!outwnd_inited)
 		return;
 
+	std::lock_guard<std::recursive_mutex> guard(Outwnd_print_mutex);
+
 	if (Outwnd_no_filter_file == 1) {
 		Outwnd_no_filter_file = 2;
 
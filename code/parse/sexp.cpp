@@ -1012,6 +1012,7 @@ const char *Skybox_flags[] = {
 int	Directive_count;
 int	Sexp_useful_number = 1;  // a variable to pass useful info in from external modules
 bool Assume_event_is_current = true;
+fix	Sexp_next_time_change = INT_MAX;
 int	Locked_sexp_true = -1;
 int	Locked_sexp_false = -1;
 int	Num_sexp_ai_goal_links = sizeof(Sexp_ai_goal_links) / sizeof(sexp_ai_goal_link);
@@ -1089,7 +1090,6 @@ void sexp_copy_variable_from_index(int node);
 void sexp_copy_variable_between_indexes(int node);
 
 int verify_vector(const char *text);
-bool is_descendant_of_when_argument_op(int node);
 
 
 #define ARG_ITEM_F_DUP	(1<<0)
@@ -7352,6 +7352,16 @@ int sexp_current_speed(int n)
 	return 0;
 }
 
+/**
+ * Called by the operators which become true after a delay, with the mission time at which that will happen if nothing
+ * else changes.  Sexp_next_time_change keeps the earliest of these times, see mission_process_event.
+ */
+void sexp_report_time_change(std::int64_t time)
+{
+	if (time < Sexp_next_time_change)
+		Sexp_next_time_change = static_cast<fix>(std::max(time, static_cast<std::int64_t>(INT_MIN)));
+}
+
 int sexp_check_objective_delay(int delay_node, int objective_node, int(*objective_function)(int, fix*))
 {
 	fix delay, time;
@@ -7373,8 +7383,9 @@ int sexp_check_objective_delay(int delay_node, int objective_node, int(*objectiv
 	{
 		if ((Missiontime - time) >= delay)
 			return val;
-		else
-			return SEXP_FALSE;
+
+		sexp_report_time_change(static_cast<std::int64_t>(time) + delay);
+		return SEXP_FALSE;
 	}
 
 	return val;
@@ -7816,8 +7827,9 @@ int sexp_are_waypoints_done_delay(int n)
 	{
 		if ((Missiontime - time) >= delay)
 			return val;
-		else
-			return SEXP_FALSE;
+
+		sexp_report_time_change(static_cast<std::int64_t>(time) + delay);
+		return SEXP_FALSE;
 	}
 
 	return val;
@@ -8018,6 +8030,12 @@ int sexp_has_time_elapsed(int n, bool use_msecs)
 	if ( mission_time >= time )
 		return SEXP_KNOWN_TRUE;
 
+	// rounded down, so this never comes too late
+	if (use_msecs)
+		sexp_report_time_change(static_cast<std::int64_t>(time) * 65536 / MILLISECONDS_PER_SECOND);
+	else
+		sexp_report_time_change(static_cast<std::int64_t>(time) * 65536);
+
 	return SEXP_FALSE;
 }
 
@@ -11131,40 +11149,11 @@ void eval_switch(int n)
 }
 
 /**
- * Evaluates the when conditional
- *
- * @note Goober5000 - added capability for arguments
- * @note Goober5000 - and also if-then-else and perform-actions
+ * Performs the actions of a when, every-time or if-then-else (or one of their argument versions) after its
+ * condition evaluated to val.  Returns the value of the operator before short-circuiting.
  */
-int eval_when(int n, int when_op_num)
+int eval_when_actions(int actions, int when_op_num, int val)
 {
-	int arg_handler = -1, cond, val, actions;
-	Assert( n >= 0 );
-	arg_item *ptr;
-
-	// get the parts of the sexp and evaluate the conditional
-	if (is_when_argument_op(when_op_num))
-	{
-		arg_handler = CAR(n);
-		cond = CADR(n);
-		actions = CDDR(n);
-
-		Sexp_current_argument_nesting_level++;
-		sexp_container_set_special_arg_status(arg_handler, true);
-		// evaluate for custom arguments
-		val = eval_sexp(arg_handler, cond);
-	}
-	// normal evaluation
-	else
-	{
-		cond = CAR(n);
-		actions = CDR(n);
-
-		// evaluate just as-is
-		val = eval_sexp(cond);
-	}
-
-
 	// if value is true, perform the actions in the 'then' part
 	if (val == SEXP_TRUE) // note: SEXP_KNOWN_TRUE is never returned from eval_sexp
 	{
@@ -11220,6 +11209,45 @@ int eval_when(int n, int when_op_num)
 		val = SEXP_TRUE;
 	}
 
+	return val;
+}
+
+/**
+ * Evaluates the when conditional
+ *
+ * @note Goober5000 - added capability for arguments
+ * @note Goober5000 - and also if-then-else and perform-actions
+ */
+int eval_when(int n, int when_op_num)
+{
+	int arg_handler = -1, cond, val, actions;
+	Assert( n >= 0 );
+	arg_item *ptr;
+
+	// get the parts of the sexp and evaluate the conditional
+	if (is_when_argument_op(when_op_num))
+	{
+		arg_handler = CAR(n);
+		cond = CADR(n);
+		actions = CDDR(n);
+
+		Sexp_current_argument_nesting_level++;
+		sexp_container_set_special_arg_status(arg_handler, true);
+		// evaluate for custom arguments
+		val = eval_sexp(arg_handler, cond);
+	}
+	// normal evaluation
+	else
+	{
+		cond = CAR(n);
+		actions = CDR(n);
+
+		// evaluate just as-is
+		val = eval_sexp(cond);
+	}
+
+	val = eval_when_actions(actions, when_op_num, val);
+
 	if (is_when_argument_op(when_op_num))
 	{
 		if (Log_event) {	
@@ -19008,6 +19036,7 @@ int sexp_goal_delay_status( int n, int want_true )
 		else if ( mission_log_get_time(LOG_GOAL_SATISFIED, name, nullptr, &time) ) {
 			if ( (Missiontime - time) >= delay )
 				return SEXP_KNOWN_TRUE;
+			sexp_report_time_change(static_cast<std::int64_t>(time) + delay);
 		}
 	} else {
 		// if we are looking for a goal false entry and we find a true, then return known false here
@@ -19016,6 +19045,7 @@ int sexp_goal_delay_status( int n, int want_true )
 		else if ( mission_log_get_time(LOG_GOAL_FAILED, name, nullptr, &time) ) {
 			if ( (Missiontime - time) >= delay )
 				return SEXP_KNOWN_TRUE;
+			sexp_report_time_change(static_cast<std::int64_t>(time) + delay);
 		}
 	}
 
@@ -27853,6 +27883,103 @@ void add_to_event_log_buffer(int node, int op_num, int result)
 	Current_event_log_buffer->push_back(tmp);
 }
 
+/**
+ * Checks whether the value of a node is already known, in which case it doesn't have to be evaluated again.
+ * If it is, result is set to the value eval_sexp returns for the node.  The caller is responsible for
+ * skipping this for nodes that are part of a when-argument tree.
+ */
+bool sexp_known_value(int cur_node, int &result)
+{
+	// we want to log event values for KNOWN_X or FOREVER_X before returning
+	if (Log_event && ((Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) || (Sexp_nodes[cur_node].value == SEXP_KNOWN_FALSE) || (Sexp_nodes[cur_node].value == SEXP_NAN_FOREVER))) {
+		// if this is a node that has been assigned the value by short-circuiting,
+		// it might not be the operator that returned the value
+		int op_index = get_operator_index(cur_node);
+		if (op_index < 0)
+			op_index = get_operator_index(CAR(cur_node));
+
+		// log the known value
+		add_to_event_log_buffer(cur_node, op_index, Sexp_nodes[cur_node].value);
+	}
+
+	// now do a quick return whether or not we log, per the comment in eval_sexp about trapping known sexpressions
+	if (Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) {
+		result = SEXP_TRUE;
+		return true;
+	}
+	else if (Sexp_nodes[cur_node].value == SEXP_KNOWN_FALSE) {
+		result = SEXP_FALSE;
+		return true;
+	}
+	else if (Sexp_nodes[cur_node].value == SEXP_NAN_FOREVER) {
+		result = SEXP_FALSE;
+		return true;
+	}
+
+	return false;
+}
+
+/**
+ * Finishes the evaluation of an operator node: logs the value, pops the operator pushed onto
+ * Current_sexp_operator and stores the value in the node for short circuit evaluation.
+ * Returns the value eval_sexp returns for the node.
+ */
+int sexp_finish_operator(int cur_node, int sexp_val)
+{
+	if (Log_event) {
+		add_to_event_log_buffer(cur_node, get_operator_index(cur_node), sexp_val);
+	}
+
+	Assert(!Current_sexp_operator.empty()); 
+	Current_sexp_operator.pop_back();
+
+	Assertion(sexp_val != UNINITIALIZED, "SEXP %s didn't return a value!", CTEXT(cur_node));
+
+	// if we haven't returned, check the sexp value of the sexpression evaluation.  A special
+	// value of known true or known false means that we should set the sexp.value field for
+	// short circuit eval.
+	if (sexp_val == SEXP_KNOWN_TRUE) {
+		Sexp_nodes[cur_node].value = SEXP_KNOWN_TRUE;
+		return SEXP_TRUE;
+	}
+
+	if (sexp_val == SEXP_KNOWN_FALSE) {
+		Sexp_nodes[cur_node].value = SEXP_KNOWN_FALSE;
+		return SEXP_FALSE;
+	}
+
+	if ( sexp_val == SEXP_NAN ) {
+		Sexp_nodes[cur_node].value = SEXP_NAN;			// not a number values are false I would suspect
+		return SEXP_FALSE;
+	}
+
+	if ( sexp_val == SEXP_NAN_FOREVER ) {
+		Sexp_nodes[cur_node].value = SEXP_NAN_FOREVER;
+		// Goober5000 changed from sexp_val to SEXP_FALSE on 2/21/2006 in accordance with above comment
+		// NOTE: we return false rather than known-false to match the SEXP_KNOWN_FALSE case above
+		return SEXP_FALSE;
+	}
+
+	if ( sexp_val == SEXP_CANT_EVAL ) {
+		Sexp_nodes[cur_node].value = SEXP_CANT_EVAL;
+		Assume_event_is_current = false;  // indicate sexp isn't current yet
+		return SEXP_FALSE;
+	}
+
+	if ( Sexp_nodes[cur_node].value == SEXP_NAN ) {	// if we had a nan, but now don't, reset the value
+		Sexp_nodes[cur_node].value = SEXP_UNKNOWN;
+		return sexp_val;
+	}
+
+	if ( sexp_val ){
+		Sexp_nodes[cur_node].value = SEXP_TRUE;
+	} else {
+		Sexp_nodes[cur_node].value = SEXP_FALSE;
+	}
+
+	return sexp_val;
+}
+
 /**
  * High-level sexpression evaluator
  */
@@ -27872,29 +27999,8 @@ int eval_sexp(int cur_node, int referenced_node)
 	// we can't 'know' its value since the sexp nodes may be evaluated in different ways for
 	// different arguments, so we skip this behaviour.
 
-	if (!is_descendant_of_when_argument_op(cur_node)) {
-		// we want to log event values for KNOWN_X or FOREVER_X before returning
-		if (Log_event && ((Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) || (Sexp_nodes[cur_node].value == SEXP_KNOWN_FALSE) || (Sexp_nodes[cur_node].value == SEXP_NAN_FOREVER))) {
-			// if this is a node that has been assigned the value by short-circuiting,
-			// it might not be the operator that returned the value
-			int op_index = get_operator_index(cur_node);
-			if (op_index < 0)
-				op_index = get_operator_index(CAR(cur_node));
-
-			// log the known value
-			add_to_event_log_buffer(cur_node, op_index, Sexp_nodes[cur_node].value);
-		}
-
-		// now do a quick return whether or not we log, per the comment above about trapping known sexpressions
-		if (Sexp_nodes[cur_node].value == SEXP_KNOWN_TRUE) {
-			return SEXP_TRUE;
-		}
-		else if (Sexp_nodes[cur_node].value == SEXP_KNOWN_FALSE) {
-			return SEXP_FALSE;
-		}
-		else if (Sexp_nodes[cur_node].value == SEXP_NAN_FOREVER) {
-			return SEXP_FALSE;
-		}
+	if (!is_descendant_of_when_argument_op(cur_node) && sexp_known_value(cur_node, sexp_val)) {
+		return sexp_val;
 	}
 
 	// ignore for container data, because their "first" is a container modifier
@@ -30387,58 +30493,7 @@ int eval_sexp(int cur_node, int referenced_node)
 			}
 		}
 
-		if (Log_event) {
-			add_to_event_log_buffer(cur_node, get_operator_index(cur_node), sexp_val);
-		}
-
-		Assert(!Current_sexp_operator.empty()); 
-		Current_sexp_operator.pop_back();
-
-		Assertion(sexp_val != UNINITIALIZED, "SEXP %s didn't return a value!", CTEXT(cur_node));
-
-		// if we haven't returned, check the sexp value of the sexpression evaluation.  A special
-		// value of known true or known false means that we should set the sexp.value field for
-		// short circuit eval.
-		if (sexp_val == SEXP_KNOWN_TRUE) {
-			Sexp_nodes[cur_node].value = SEXP_KNOWN_TRUE;
-			return SEXP_TRUE;
-		}
-
-		if (sexp_val == SEXP_KNOWN_FALSE) {
-			Sexp_nodes[cur_node].value = SEXP_KNOWN_FALSE;
-			return SEXP_FALSE;
-		}
-
-		if ( sexp_val == SEXP_NAN ) {
-			Sexp_nodes[cur_node].value = SEXP_NAN;			// not a number values are false I would suspect
-			return SEXP_FALSE;
-		}
-
-		if ( sexp_val == SEXP_NAN_FOREVER ) {
-			Sexp_nodes[cur_node].value = SEXP_NAN_FOREVER;
-			// Goober5000 changed from sexp_val to SEXP_FALSE on 2/21/2006 in accordance with above comment
-			// NOTE: we return false rather than known-false to match the SEXP_KNOWN_FALSE case above
-			return SEXP_FALSE;
-		}
-
-		if ( sexp_val == SEXP_CANT_EVAL ) {
-			Sexp_nodes[cur_node].value = SEXP_CANT_EVAL;
-			Assume_event_is_current = false;  // indicate sexp isn't current yet
-			return SEXP_FALSE;
-		}
-
-		if ( Sexp_nodes[cur_node].value == SEXP_NAN ) {	// if we had a nan, but now don't, reset the value
-			Sexp_nodes[cur_node].value = SEXP_UNKNOWN;
-			return sexp_val;
-		}
-
-		if ( sexp_val ){
-			Sexp_nodes[cur_node].value = SEXP_TRUE;
-		} else {
-			Sexp_nodes[cur_node].value = SEXP_FALSE;
-		}
-
-		return sexp_val;
+		return sexp_finish_operator(cur_node, sexp_val);
 	}
 }
 
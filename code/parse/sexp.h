@@ -17,6 +17,8 @@
 #include "mission/mission_flags.h"
 #include "ai/ai_flags.h"
 
+#include <climits>
+
 class ship_subsys;
 class ship;
 class waypoint_list;
@@ -1417,6 +1419,7 @@ extern int Locked_sexp_true, Locked_sexp_false;
 extern int Directive_count;
 extern int Sexp_useful_number;  // a variable to pass useful info in from external modules
 extern bool Assume_event_is_current;
+extern fix Sexp_next_time_change;	// the earliest mission time at which a delay evaluated since this was reset will elapse
 extern int Sexp_clipboard;  // used by Fred
 
 extern SCP_vector<int> Current_sexp_operator;
@@ -1457,6 +1460,12 @@ extern int stuff_sexp_variable_list();
 extern int eval_sexp(int cur_node, int referenced_node = -1);
 extern int eval_num(int n, bool &is_nan, bool &is_nan_forever);
 extern bool is_sexp_true(int cur_node, int referenced_node = -1);
+
+// the parts of eval_sexp which are shared with compiled sexp programs (see parse/sexp/sexp_program.h)
+extern bool sexp_known_value(int cur_node, int &result);
+extern int sexp_finish_operator(int cur_node, int sexp_val);
+extern int eval_when_actions(int actions, int when_op_num, int val);
+extern void sexp_report_time_change(std::int64_t time);
 extern bool map_opf_to_opr(sexp_opf_t opf_type, sexp_opr_t &opr_type);
 const char *opr_type_name(sexp_opr_t opr_type);
 extern int query_operator_return_type(int op);
@@ -1489,6 +1498,7 @@ extern bool is_when_argument_op(int op_const);
 extern bool is_argument_provider_op(int op_const);
 extern bool is_implicit_argument_provider_op(int op_const); // jg18
 extern int find_argument_provider(int node);
+extern bool is_descendant_of_when_argument_op(int node);
 
 // functions to change the attributes of an sexpression tree to persistent or not persistent
 extern void sexp_unmark_persistent( int n );
@@ -0,0 +1,510 @@
+#include "parse/sexp/sexp_program.h"
+
+#include "parse/sexp.h"
+
+namespace {
+
+bool is_true(int sexp_val)
+{
+	// same as is_sexp_true
+	return (sexp_val == SEXP_TRUE) || (sexp_val == SEXP_KNOWN_TRUE);
+}
+
+bool is_compare_op(int op_num)
+{
+	switch (op_num) {
+	case OP_EQUALS:
+	case OP_GREATER_THAN:
+	case OP_LESS_THAN:
+	case OP_NOT_EQUAL:
+	case OP_GREATER_OR_EQUAL:
+	case OP_LESS_OR_EQUAL:
+		return true;
+	default:
+		return false;
+	}
+}
+
+bool compare_numbers(int op_num, int first_number, int current_number)
+{
+	switch (op_num) {
+	case OP_EQUALS:
+		return first_number == current_number;
+	case OP_NOT_EQUAL:
+		return first_number != current_number;
+	case OP_GREATER_THAN:
+		return first_number > current_number;
+	case OP_GREATER_OR_EQUAL:
+		return first_number >= current_number;
+	case OP_LESS_THAN:
+		return first_number < current_number;
+	case OP_LESS_OR_EQUAL:
+		return first_number <= current_number;
+	default:
+		UNREACHABLE("Operator %d is not a number comparison!", op_num);
+		return false;
+	}
+}
+
+// returns the value sexp_number_compare bails out with if the node is not a number, or -1 if it is fine
+int check_number_compare_nan(int node)
+{
+	if (node != -1) {
+		if (Sexp_nodes[node].value == SEXP_NAN)
+			return SEXP_FALSE;
+		if (Sexp_nodes[node].value == SEXP_NAN_FOREVER)
+			return SEXP_KNOWN_FALSE;
+	}
+	return -1;
+}
+
+// the mission state read by the operators which may be part of a schedulable program, false for all other operators
+bool get_operator_dependencies(int op_num, flagset<sexp::SEXPProgram::Dependency>& dependencies)
+{
+	using Dependency = sexp::SEXPProgram::Dependency;
+
+	switch (op_num) {
+	case OP_IS_DESTROYED:
+	case OP_IS_SUBSYSTEM_DESTROYED:
+	case OP_HAS_ARRIVED:
+	case OP_HAS_DEPARTED:
+	case OP_IS_DISABLED:
+	case OP_IS_DISARMED:
+		dependencies += Dependency::MissionLog;
+		dependencies += Dependency::Ships;
+		return true;
+
+	case OP_IS_DESTROYED_DELAY:
+	case OP_IS_SUBSYSTEM_DESTROYED_DELAY:
+	case OP_HAS_ARRIVED_DELAY:
+	case OP_HAS_DEPARTED_DELAY:
+	case OP_IS_DISABLED_DELAY:
+	case OP_IS_DISARMED_DELAY:
+		dependencies += Dependency::MissionLog;
+		dependencies += Dependency::Ships;
+		dependencies += Dependency::Time;
+		return true;
+
+	case OP_GOAL_TRUE_DELAY:
+	case OP_GOAL_FALSE_DELAY:
+		dependencies += Dependency::MissionLog;
+		dependencies += Dependency::Time;
+		return true;
+
+	case OP_GOAL_INCOMPLETE:
+		dependencies += Dependency::MissionLog;
+		return true;
+
+	case OP_EVENT_TRUE:
+	case OP_EVENT_FALSE:
+	case OP_EVENT_INCOMPLETE:
+		dependencies += Dependency::Events;
+		return true;
+
+	case OP_HAS_TIME_ELAPSED:
+	case OP_HAS_TIME_ELAPSED_MSECS:
+		dependencies += Dependency::Time;
+		return true;
+
+	default:
+		return false;
+	}
+}
+
+}
+
+namespace sexp {
+
+SEXPProgram SEXPProgram::compile(int node)
+{
+	Assertion(!Fred_running, "SEXP programs resolve operators like the game does and can't be used in FRED!");
+
+	SEXPProgram program;
+	program._root = node;
+	// a when is the only conditional which doesn't do anything while its condition is false
+	program._schedulable = (node >= 0) && (Sexp_nodes[node].first == -1) && (get_operator_const(node) == OP_WHEN);
+	program.compileNode(node);
+
+	return program;
+}
+
+int SEXPProgram::addInstruction(Opcode opcode, int node, int op_num, const SCP_vector<Operand>& operands)
+{
+	Instruction instruction;
+	instruction.opcode = opcode;
+	instruction.cacheable = node >= 0 && !is_descendant_of_when_argument_op(node);
+	instruction.node = node;
+	instruction.op_num = op_num;
+	instruction.first_operand = static_cast<int>(_operands.size());
+	instruction.num_operands = static_cast<int>(operands.size());
+
+	_operands.insert(_operands.end(), operands.begin(), operands.end());
+	_instructions.push_back(instruction);
+
+	return static_cast<int>(_instructions.size()) - 1;
+}
+
+int SEXPProgram::compileNode(int node)
+{
+	SCP_vector<Operand> operands;
+
+	if (node == -1) {
+		return addInstruction(Opcode::Empty, node, OP_NOT_AN_OP, operands);
+	}
+
+	// see eval_sexp for which nodes are lists
+	if ((Sexp_nodes[node].first != -1) && (Sexp_nodes[node].subtype != SEXP_ATOM_CONTAINER_DATA)) {
+		operands.push_back({CAR(node), compileNode(CAR(node))});
+		return addInstruction(Opcode::List, node, OP_NOT_AN_OP, operands);
+	}
+
+	int op_num = get_operator_const(node);
+	int n = CDR(node);
+
+	switch (op_num) {
+	case OP_NOT_AN_OP:
+		addAtomDependencies(node);
+		return addInstruction(Opcode::Atom, node, op_num, operands);
+
+	case OP_TRUE:
+	case OP_FALSE:
+		return addInstruction(Opcode::Constant, node, op_num, operands);
+
+	case OP_AND:
+	case OP_OR:
+	case OP_NOT:
+		// the first argument is evaluated through its operator node, the others through their list node, like
+		// sexp_and, sexp_or and sexp_not do it
+		if (n != -1) {
+			if (CAR(n) != -1) {
+				operands.push_back({CAR(n), compileNode(CAR(n))});
+			} else {
+				operands.push_back({n, -1});
+				addAtomDependencies(n);
+			}
+
+			if (op_num != OP_NOT) {
+				for (; CDR(n) != -1; n = CDR(n)) {
+					operands.push_back({CDR(n), compileNode(CDR(n))});
+				}
+			}
+		}
+
+		if (op_num == OP_AND) {
+			return addInstruction(Opcode::And, node, op_num, operands);
+		} else if (op_num == OP_OR) {
+			return addInstruction(Opcode::Or, node, op_num, operands);
+		}
+		return addInstruction(Opcode::Not, node, op_num, operands);
+
+	case OP_WHEN:
+	case OP_IF_THEN_ELSE:
+	case OP_EVERY_TIME:
+		Assert(n >= 0);
+		operands.push_back({CAR(n), compileNode(CAR(n))});
+		return addInstruction(Opcode::When, node, op_num, operands);
+
+	default:
+		if (is_compare_op(op_num)) {
+			// every argument is evaluated through its list node
+			operands.push_back({n, compileNode(n)});
+			for (int current_node = CDR(n); current_node != -1; current_node = CDR(current_node)) {
+				operands.push_back({current_node, compileNode(current_node)});
+			}
+			return addInstruction(Opcode::NumberCompare, node, op_num, operands);
+		}
+
+		addOperatorDependencies(node, op_num);
+		return addInstruction(Opcode::Tree, node, op_num, operands);
+	}
+}
+
+void SEXPProgram::addAtomDependencies(int node)
+{
+	if (Sexp_nodes[node].type & SEXP_FLAG_VARIABLE) {
+		_dependencies += Dependency::Variables;
+		_dependency_nodes[static_cast<size_t>(Dependency::Variables)].push_back(node);
+	}
+
+	// containers can be modified in too many ways to keep track of them
+	if (Sexp_nodes[node].subtype == SEXP_ATOM_CONTAINER_NAME || Sexp_nodes[node].subtype == SEXP_ATOM_CONTAINER_DATA) {
+		_schedulable = false;
+	}
+}
+
+void SEXPProgram::addOperatorDependencies(int node, int op_num)
+{
+	flagset<Dependency> dependencies;
+	if (!get_operator_dependencies(op_num, dependencies)) {
+		_schedulable = false;
+		return;
+	}
+
+	// the arguments have to be plain values, another operator could read anything
+	for (int n = CDR(node); n != -1; n = CDR(n)) {
+		if (CAR(n) != -1) {
+			_schedulable = false;
+			return;
+		}
+		addAtomDependencies(n);
+	}
+
+	_dependencies |= dependencies;
+
+	// the names of the ships, wings and events, which are all plain values here
+	for (auto dependency : { Dependency::Ships, Dependency::Events }) {
+		if (dependencies[dependency]) {
+			auto& nodes = _dependency_nodes[static_cast<size_t>(dependency)];
+			for (int n = CDR(node); n != -1; n = CDR(n)) {
+				nodes.push_back(n);
+			}
+		}
+	}
+}
+
+int SEXPProgram::evaluate() const
+{
+	if (_instructions.empty()) {
+		return eval_sexp(_root);
+	}
+
+	// instructions are added after their operands, so the root is always the last one
+	return execute(static_cast<int>(_instructions.size()) - 1);
+}
+
+int SEXPProgram::execute(int index) const
+{
+	const auto& instruction = _instructions[index];
+	const int node = instruction.node;
+	int sexp_val;
+
+	switch (instruction.opcode) {
+	case Opcode::Empty:
+		return SEXP_FALSE;
+
+	case Opcode::Tree:
+		return eval_sexp(node);
+
+	default:
+		break;
+	}
+
+	// everything from here on mirrors eval_sexp
+	if (instruction.cacheable && sexp_known_value(node, sexp_val)) {
+		return sexp_val;
+	}
+
+	if (instruction.opcode == Opcode::List) {
+		const auto& operand = _operands[instruction.first_operand];
+
+		sexp_val = execute(operand.instruction);
+		Sexp_nodes[node].value = Sexp_nodes[operand.node].value;	// higher level node gets node value
+		return sexp_val;
+	}
+
+	if (instruction.opcode == Opcode::Atom) {
+		return sexp_atoi(node);
+	}
+
+	Current_sexp_operator.push_back(instruction.op_num);
+
+	switch (instruction.opcode) {
+	case Opcode::Constant:
+		sexp_val = (instruction.op_num == OP_TRUE) ? SEXP_KNOWN_TRUE : SEXP_KNOWN_FALSE;
+		break;
+
+	case Opcode::And:
+		sexp_val = executeAnd(instruction);
+		break;
+
+	case Opcode::Or:
+		sexp_val = executeOr(instruction);
+		break;
+
+	case Opcode::Not:
+		sexp_val = executeNot(instruction);
+		break;
+
+	case Opcode::NumberCompare:
+		sexp_val = executeNumberCompare(instruction);
+		break;
+
+	case Opcode::When:
+		sexp_val = executeWhen(instruction);
+		break;
+
+	default:
+		UNREACHABLE("Unhandled opcode %d!", static_cast<int>(instruction.opcode));
+		sexp_val = SEXP_FALSE;
+		break;
+	}
+
+	return sexp_finish_operator(node, sexp_val);
+}
+
+// see sexp_and
+int SEXPProgram::executeAnd(const Instruction& instruction) const
+{
+	bool all_true = true;
+	bool result = true;
+
+	for (int i = 0; i < instruction.num_operands; ++i) {
+		const auto& operand = _operands[instruction.first_operand + i];
+
+		if (operand.instruction < 0) {
+			result = (sexp_atoi(operand.node) != 0) && result;
+			continue;
+		}
+
+		result = is_true(execute(operand.instruction)) && result;
+		if (Sexp_nodes[operand.node].value == SEXP_KNOWN_FALSE || Sexp_nodes[operand.node].value == SEXP_NAN_FOREVER)
+			return SEXP_KNOWN_FALSE;
+		if (Sexp_nodes[operand.node].value != SEXP_KNOWN_TRUE)
+			all_true = false;
+	}
+
+	if (all_true)
+		return SEXP_KNOWN_TRUE;
+
+	return result ? SEXP_TRUE : SEXP_FALSE;
+}
+
+// see sexp_or
+int SEXPProgram::executeOr(const Instruction& instruction) const
+{
+	bool all_false = true;
+	bool result = false;
+
+	for (int i = 0; i < instruction.num_operands; ++i) {
+		const auto& operand = _operands[instruction.first_operand + i];
+
+		if (operand.instruction < 0) {
+			result = (sexp_atoi(operand.node) != 0) || result;
+			continue;
+		}
+
+		result = is_true(execute(operand.instruction)) || result;
+		if (Sexp_nodes[operand.node].value == SEXP_KNOWN_TRUE)
+			return SEXP_KNOWN_TRUE;
+		if (Sexp_nodes[operand.node].value != SEXP_KNOWN_FALSE)
+			all_false = false;
+	}
+
+	if (all_false)
+		return SEXP_KNOWN_FALSE;
+
+	return result ? SEXP_TRUE : SEXP_FALSE;
+}
+
+// see sexp_not
+int SEXPProgram::executeNot(const Instruction& instruction) const
+{
+	bool result = false;
+
+	if (instruction.num_operands > 0) {
+		const auto& operand = _operands[instruction.first_operand];
+
+		if (operand.instruction < 0) {
+			result = (sexp_atoi(operand.node) != 0);
+		} else {
+			result = is_true(execute(operand.instruction));
+			if (Sexp_nodes[operand.node].value == SEXP_KNOWN_FALSE || Sexp_nodes[operand.node].value == SEXP_NAN_FOREVER)
+				return SEXP_KNOWN_TRUE;
+			else if (Sexp_nodes[operand.node].value == SEXP_KNOWN_TRUE)
+				return SEXP_KNOWN_FALSE;
+			else if (Sexp_nodes[operand.node].value == SEXP_NAN)
+				return SEXP_TRUE;
+		}
+	}
+
+	return result ? SEXP_FALSE : SEXP_TRUE;
+}
+
+// see sexp_number_compare
+int SEXPProgram::executeNumberCompare(const Instruction& instruction) const
+{
+	const auto* operands = &_operands[instruction.first_operand];
+	int bail;
+
+	int first_number = execute(operands[0].instruction);
+
+	// bail on NANs, these are checked before the following argument has been evaluated
+	if ((bail = check_number_compare_nan(CAR(operands[0].node))) != -1)
+		return bail;
+	if ((bail = check_number_compare_nan(CDR(operands[0].node))) != -1)
+		return bail;
+
+	for (int i = 1; i < instruction.num_operands; ++i) {
+		int current_node = operands[i].node;
+
+		if ((bail = check_number_compare_nan(CAR(current_node))) != -1)
+			return bail;
+		if ((bail = check_number_compare_nan(CDR(current_node))) != -1)
+			return bail;
+
+		int current_number = execute(operands[i].instruction);
+
+		if (!compare_numbers(instruction.op_num, first_number, current_number))
+			return SEXP_FALSE;
+	}
+
+	return SEXP_TRUE;
+}
+
+// see eval_when and the every-time case in eval_sexp
+int SEXPProgram::executeWhen(const Instruction& instruction) const
+{
+	const auto& condition = _operands[instruction.first_operand];
+	int n = CDR(instruction.node);
+
+	int val = execute(condition.instruction);
+	val = eval_when_actions(CDR(n), instruction.op_num, val);
+
+	if (instruction.op_num == OP_EVERY_TIME) {
+		flush_sexp_tree(n);
+		return SEXP_NAN;
+	}
+
+	if (condition.node >= 0 && (Sexp_nodes[condition.node].value == SEXP_KNOWN_FALSE || Sexp_nodes[condition.node].value == SEXP_NAN_FOREVER))
+		return SEXP_KNOWN_FALSE;  // no need to waste time on this anymore
+
+	return val;
+}
+
+int SEXPProgram::getRoot() const
+{
+	return _root;
+}
+
+size_t SEXPProgram::getNumInstructions() const
+{
+	return _instructions.size();
+}
+
+size_t SEXPProgram::getNumTreeInstructions() const
+{
+	size_t count = 0;
+	for (const auto& instruction : _instructions) {
+		if (instruction.opcode == Opcode::Tree) {
+			++count;
+		}
+	}
+	return count;
+}
+
+bool SEXPProgram::isSchedulable() const
+{
+	return _schedulable;
+}
+
+const flagset<SEXPProgram::Dependency>& SEXPProgram::getDependencies() const
+{
+	return _dependencies;
+}
+
+const SCP_vector<int>& SEXPProgram::getDependencyNodes(Dependency dependency) const
+{
+	return _dependency_nodes[static_cast<size_t>(dependency)];
+}
+
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include "globalincs/flagset.h"
+#include "globalincs/pstypes.h"
+
+#include <array>
+
+namespace sexp {
+
+/**
+ * @brief A SEXP tree which has been compiled into a flat list of instructions
+ *
+ * eval_sexp finds the operator of every node it visits through a switch with several hundred cases and walks the
+ * linked Sexp_nodes lists to find the arguments. A program does that once, when it is compiled: every instruction
+ * knows what it has to do, which instructions produce its operands and whether its value may be cached.
+ *
+ * Only the operators which make up the skeleton of most event formulas are compiled, i.e. when, every-time,
+ * if-then-else, and, or, not, true, false and the number comparisons. Any other operator becomes an instruction which
+ * hands its subtree to eval_sexp, which remains the reference implementation. The actions of a when are always
+ * evaluated by eval_sexp.
+ *
+ * Evaluating a program has exactly the same effects as calling eval_sexp on its root: the arguments are evaluated in
+ * the same order, the same values are stored in the nodes and the same entries end up in the event log. The program
+ * only stores the structure of the tree, so it stays valid as long as the tree isn't modified.
+ *
+ * While compiling, the program also records which mission state its condition reads. If that is known for every
+ * operator in the condition, the program is schedulable: as long as that state doesn't change, evaluating the condition
+ * again gives the same result, so an event whose condition was false doesn't have to be evaluated again until then.
+ */
+class SEXPProgram {
+ public:
+	//! The mission state the condition of a program can depend on
+	enum class Dependency : ubyte {
+		MissionLog,		//!< Entries in the mission log, which are only ever added
+		Ships,			//!< The status of ships and wings, i.e. whether they have arrived, departed or been destroyed
+		Variables,		//!< SEXP variables
+		Events,			//!< The results of other events
+		Time,			//!< Mission time, the operators report when they change through sexp_report_time_change
+		NUM_VALUES
+	};
+
+ private:
+	enum class Opcode : ubyte {
+		Empty,			//!< An empty list, always false
+		Tree,			//!< Evaluated by eval_sexp
+		List,			//!< A list node, evaluates its first element
+		Atom,			//!< A number, variable or container
+		Constant,		//!< true or false
+		And,
+		Or,
+		Not,
+		NumberCompare,
+		When,			//!< when, if-then-else and every-time
+	};
+
+	struct Operand {
+		int node;			//!< The node whose value is checked after the operand has been evaluated
+		int instruction;	//!< The instruction which evaluates the operand, or -1 if the node is read as a number
+	};
+
+	struct Instruction {
+		Opcode opcode;
+		bool cacheable;		//!< false for nodes in a when-argument tree, those may not use their known value
+		int node;
+		int op_num;
+		int first_operand;	//!< Index into _operands
+		int num_operands;
+	};
+
+	SCP_vector<Instruction> _instructions;
+	SCP_vector<Operand> _operands;
+	int _root = -1;
+
+	flagset<Dependency> _dependencies;
+	std::array<SCP_vector<int>, static_cast<size_t>(Dependency::NUM_VALUES)> _dependency_nodes;
+	bool _schedulable = false;
+
+	int compileNode(int node);
+	int addInstruction(Opcode opcode, int node, int op_num, const SCP_vector<Operand>& operands);
+	void addAtomDependencies(int node);
+	void addOperatorDependencies(int node, int op_num);
+
+	int execute(int index) const;
+	int executeAnd(const Instruction& instruction) const;
+	int executeOr(const Instruction& instruction) const;
+	int executeNot(const Instruction& instruction) const;
+	int executeNumberCompare(const Instruction& instruction) const;
+	int executeWhen(const Instruction& instruction) const;
+
+ public:
+	/**
+	 * @brief Compiles the SEXP tree starting at the given node
+	 *
+	 * Operators are resolved like eval_sexp does it in game, so this must not be used in FRED.
+	 *
+	 * @param node The root node of the tree, usually the formula of an event
+	 * @return The compiled program
+	 */
+	static SEXPProgram compile(int node);
+
+	/**
+	 * @brief Evaluates the program
+	 * @return The same value eval_sexp would return for the root node
+	 */
+	int evaluate() const;
+
+	//! The root node of the tree this program has been compiled from
+	int getRoot() const;
+
+	size_t getNumInstructions() const;
+
+	//! The number of instructions which are evaluated by eval_sexp
+	size_t getNumTreeInstructions() const;
+
+	/**
+	 * @brief Whether the program is a when whose condition only depends on the state returned by getDependencies
+	 *
+	 * Only conditions made of the compiled operators and the objective, goal and event status operators with literal or
+	 * variable arguments are schedulable. Anything else may read state which isn't tracked, e.g. positions or hull
+	 * strength, which change all the time anyway.
+	 */
+	bool isSchedulable() const;
+
+	//! The mission state the condition reads, only complete if the program is schedulable
+	const flagset<Dependency>& getDependencies() const;
+
+	/**
+	 * @brief The nodes which say which entries of the given state the condition reads
+	 *
+	 * These are the ship, wing and event name arguments of the operators and the variable atoms. Their values are only
+	 * known while the program runs, since they may be variables. The mission log and mission time have no nodes.
+	 */
+	const SCP_vector<int>& getDependencyNodes(Dependency dependency) const;
+};
+
+}
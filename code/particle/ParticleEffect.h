@@ -128,7 +128,7 @@ public:
 	friend class ParticleManager;
 	friend int ::parse_weapon(int, bool, const char*);
 	friend ParticleEffectHandle scripting::api::getLegacyScriptingParticleEffect(int bitmap, bool reversed);
-	friend bool move_particle(float frametime, particle* part);
+	friend void add_particle_light(const ParticleEffect& source_effect, const particle& part, const vec3d& prev_pos, float curve_velocity);
 
 	SCP_string m_name; //!< The name of this effect
 
@@ -236,6 +236,8 @@ public:
 
 	const SCP_string& getName() const { return m_name; }
 
+	bool hasLightSource() const { return m_light_source.has_value(); }
+
 	std::pair<TIMESTAMP, TIMESTAMP> getEffectDuration() const;
 
 	float getNextSpawnDelay() const;
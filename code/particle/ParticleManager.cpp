@@ -6,13 +6,24 @@
 #include "particle/ParticleManager.h"
 
 #include "bmpman/bmpman.h"
+#include "cmdline/cmdline.h"
 #include "globalincs/systemvars.h"
 #include "tracing/tracing.h"
+#include "utils/Random.h"
+#include "utils/threading.h"
 
 /**
  * @defgroup particleSystems Particle System
  */
 
+namespace {
+// Number of sources which are handed to one job when processing them in parallel
+const size_t SOURCE_BATCH_SIZE = 16;
+
+// Set on the threads which process a batch of sources, so that sources created there end up in their batch
+thread_local SCP_vector<particle::ParticleSource>* Batch_created_sources = nullptr;
+}
+
 namespace particle {
 std::unique_ptr<ParticleManager> ParticleManager::m_manager = nullptr;
 
@@ -38,6 +49,13 @@ void ParticleManager::shutdown() {
 ParticleSource* ParticleManager::createSource() {
 	ParticleSource* source;
 
+	// the validity counter gets updated once the batch has been merged
+	if (Batch_created_sources != nullptr) {
+		Batch_created_sources->emplace_back();
+
+		return &Batch_created_sources->back();
+	}
+
 	m_sourceValidityCounter++;
 
 	// If we are currently in the onFrame function, adding stuff to the vector would invalidate the iterator currently in use
@@ -62,16 +80,13 @@ ParticleEffectHandle ParticleManager::getEffectByName(const SCP_string& name)
 		return ParticleEffectHandle::invalid();
 	}
 
-	auto foundIterator = find_if(m_effects.begin(), m_effects.end(),
-								 [&name](const SCP_vector<ParticleEffect>& vec) {
-									 return !vec.empty() && lcase_equal(vec.front().getName(), name);
-								 });
+	auto foundIterator = m_effectsByName.find(name);
 
-	if (foundIterator == m_effects.end()) {
+	if (foundIterator == m_effectsByName.end()) {
 		return ParticleEffectHandle::invalid();
 	}
 
-	return ParticleEffectHandle(distance(m_effects.begin(), foundIterator));
+	return foundIterator->second;
 }
 
 void ParticleManager::doFrame(float) {
@@ -82,6 +97,21 @@ void ParticleManager::doFrame(float) {
 	TRACE_SCOPE(tracing::ProcessParticleEffects);
 
 	m_processingSources = true;
+	bool changehappened = Cmdline_parallel_particles ? processSourcesParallel() : processSources();
+
+	m_processingSources = false;
+
+	for (auto& source : m_deferredSourceAdding) {
+		changehappened = true;
+		m_sources.push_back(std::move(source));
+	}
+	m_deferredSourceAdding.clear();
+
+	if (changehappened)
+		m_sourceValidityCounter++;
+}
+
+bool ParticleManager::processSources() {
 	bool changehappened = false;
 
 	for (auto source = std::begin(m_sources); source != std::end(m_sources);) {
@@ -104,16 +134,67 @@ void ParticleManager::doFrame(float) {
 		++source;
 	}
 
-	m_processingSources = false;
+	return changehappened;
+}
 
-	for (auto& source : m_deferredSourceAdding) {
-		changehappened = true;
-		m_sources.push_back(std::move(source));
+bool ParticleManager::processSourcesParallel() {
+	const size_t numSources = m_sources.size();
+	if (numSources == 0) {
+		return false;
 	}
-	m_deferredSourceAdding.clear();
 
-	if (changehappened)
-		m_sourceValidityCounter++;
+	const size_t numBatches = (numSources + SOURCE_BATCH_SIZE - 1) / SOURCE_BATCH_SIZE;
+	if (m_sourceBatches.size() < numBatches) {
+		m_sourceBatches.resize(numBatches);
+	}
+	m_sourceContinues.resize(numSources);
+
+	// This is the only number taken from the global generator, so a fixed seed still determines everything
+	const auto frameSeed = static_cast<uint32_t>(::util::Random::next());
+
+	threading::parallel_for(0, numSources, SOURCE_BATCH_SIZE, [this, frameSeed](size_t first, size_t last) {
+		auto& batch = m_sourceBatches[first / SOURCE_BATCH_SIZE];
+
+		set_emission_buffer(&batch.emissions);
+		Batch_created_sources = &batch.createdSources;
+
+		for (size_t i = first; i < last; ++i) {
+			::util::Random::ThreadSeed seed(frameSeed ^ (static_cast<uint32_t>(i) * 0x9e3779b9u));
+
+			auto& source = m_sources[i];
+			m_sourceContinues[i] = source.isValid() && source.process();
+		}
+
+		Batch_created_sources = nullptr;
+		set_emission_buffer(nullptr);
+	});
+
+	for (size_t i = 0; i < numBatches; ++i) {
+		auto& batch = m_sourceBatches[i];
+
+		merge_emission_buffer(batch.emissions);
+
+		for (auto& source : batch.createdSources) {
+			m_deferredSourceAdding.push_back(std::move(source));
+		}
+		batch.createdSources.clear();
+	}
+
+	// remove the sources which are done, without changing the order of the others
+	size_t kept = 0;
+	for (size_t i = 0; i < numSources; ++i) {
+		if (!m_sourceContinues[i]) {
+			continue;
+		}
+
+		if (kept != i) {
+			m_sources[kept] = std::move(m_sources[i]);
+		}
+		++kept;
+	}
+	m_sources.erase(m_sources.begin() + kept, m_sources.end());
+
+	return kept != numSources;
 }
 
 ParticleEffectHandle ParticleManager::addEffect(ParticleEffect&& effect)
@@ -149,7 +230,6 @@ ParticleEffectHandle ParticleManager::addEffect(SCP_vector<ParticleEffect>&& eff
 
 #ifndef NDEBUG
 	if (!effect.front().getName().empty()) {
-		// This check is a bit expensive and will only be used in debug
 		auto index = getEffectByName(effect.front().getName());
 
 		if (index.isValid()) {
@@ -162,6 +242,12 @@ ParticleEffectHandle ParticleManager::addEffect(SCP_vector<ParticleEffect>&& eff
 	auto& effect_after_emplace = m_effects.emplace_back(std::move(effect));
 
 	auto handle = ParticleEffectHandle(static_cast<ParticleEffectHandle::impl_type>(m_effects.size() - 1));
+
+	if (!effect_after_emplace.front().getName().empty()) {
+		// emplace doesn't replace an existing entry, so the first effect with a name keeps it like before
+		m_effectsByName.emplace(effect_after_emplace.front().getName(), handle);
+	}
+
 	for (size_t i = 0; i < effect_after_emplace.size(); i++)
 		effect_after_emplace[i].m_self = ParticleSubeffectHandle{handle, i};
 
@@ -34,6 +34,12 @@ class ParticleManager {
  private:
 	SCP_vector<SCP_vector<ParticleEffect>> m_effects; //!< All parsed effects
 
+	/**
+	 * The effects with a name, by the name of their first subeffect. If there are several effects with the same name,
+	 * this contains the first one.
+	 */
+	SCP_unordered_map<SCP_string, ParticleEffectHandle, SCP_string_lcase_hash, SCP_string_lcase_equal_to> m_effectsByName;
+
 	SCP_vector<ParticleSource> m_sources; //!< The currently active sources
 
 	bool m_processingSources = false; //!< @c true if sources are currently being processed
@@ -45,6 +51,17 @@ class ParticleManager {
 	 */
 	SCP_vector<ParticleSource> m_deferredSourceAdding;
 
+	/**
+	 * @brief What a batch of sources produced when the sources are processed in parallel
+	 */
+	struct SourceBatch {
+		EmissionBuffer emissions;
+		SCP_vector<ParticleSource> createdSources; //!< Sources created while processing, e.g. for particle trails
+	};
+
+	SCP_vector<SourceBatch> m_sourceBatches;
+	SCP_vector<ubyte> m_sourceContinues; //!< Per source, @c true if the source is still running after processing
+
 	/**
 	 * The global paticle manager
 	 */
@@ -61,6 +78,23 @@ class ParticleManager {
 	 * @return The source pointer
 	 */
 	ParticleSource* createSource();
+
+	/**
+	 * @brief Processes the sources one after the other
+	 * @return @c true if sources have been removed
+	 */
+	bool processSources();
+
+	/**
+	 * @brief Processes the sources in batches on the job system
+	 *
+	 * Every source draws its random numbers from its own generator, seeded from one number per frame and the position
+	 * of the source in the list. The particles and sources created by a batch are merged in the order of the batches
+	 * afterwards. With a fixed seed, this gives the same particles no matter how many threads there are.
+	 *
+	 * @return @c true if sources have been removed
+	 */
+	bool processSourcesParallel();
  public:
 	ParticleManager();
 
@@ -103,8 +137,7 @@ class ParticleManager {
 	/**
 	 * @brief Gets an effect by name
 	 *
-	 * @note If possible, only call this once and then store the index. The lookup is being done by a sequential search
-	 * which means it's pretty slow.
+	 * The lookup is case insensitive and goes through a hash map, so this is cheap enough to be called at runtime.
 	 *
 	 * @param name The name of the effect that is being searched, may not be empty
 	 * @return The index of the effect
@@ -0,0 +1,162 @@
+#include "particle/ParticlePool.h"
+
+#include "object/object.h"
+
+namespace particle {
+
+void ParticlePool::add(particle&& part, ubyte flags)
+{
+	flags &= FLAG_VELOCITY_CURVE | FLAG_LIGHT;
+
+	if (part.looping) {
+		flags |= FLAG_LOOPING;
+	}
+	if (part.attached_objnum >= 0) {
+		flags |= FLAG_ATTACHED;
+	}
+
+	for (int axis = 0; axis < 3; ++axis) {
+		m_pos[axis].push_back(part.pos.a1d[axis]);
+		m_vel[axis].push_back(part.velocity.a1d[axis]);
+	}
+	m_velScale.push_back(1.0f);
+	m_age.push_back(part.age);
+	m_maxLife.push_back(part.max_life);
+	m_attachedObjnum.push_back(part.attached_objnum);
+	m_attachedSig.push_back(part.attached_sig);
+	m_flags.push_back(flags);
+
+	m_cold.push_back(std::move(part));
+}
+
+void ParticlePool::clear()
+{
+	for (int axis = 0; axis < 3; ++axis) {
+		m_pos[axis].clear();
+		m_vel[axis].clear();
+	}
+	m_velScale.clear();
+	m_age.clear();
+	m_maxLife.clear();
+	m_attachedObjnum.clear();
+	m_attachedSig.clear();
+	m_flags.clear();
+
+	m_cold.clear();
+}
+
+void ParticlePool::age(float frametime)
+{
+	const size_t count = size();
+	float* ages = m_age.data();
+	const float* max_lives = m_maxLife.data();
+	ubyte* flags = m_flags.data();
+
+	// Written without branches so that this gets vectorized
+	bool any_attached = false;
+	for (size_t i = 0; i < count; ++i) {
+		// a new particle gets a tiny age, so that it is rendered at least once
+		float age = ages[i] == 0.0f ? 0.00001f : ages[i] + frametime;
+		ages[i] = age;
+
+		float max_life = max_lives[i];
+		ubyte flag = flags[i];
+
+		// special case, if max_life is 0 then we want it to render at least once
+		bool expired = (age > max_life) & ((flag & FLAG_LOOPING) == 0) & ((age > frametime) | (max_life > 0.0f));
+
+		flags[i] = static_cast<ubyte>((flag & ~FLAG_EXPIRED) | (expired ? FLAG_EXPIRED : 0));
+		any_attached |= (flag & FLAG_ATTACHED) != 0;
+	}
+
+	if (!any_attached) {
+		return;
+	}
+
+	// if the particle is attached to an object which has become invalid, kill it
+	for (size_t i = 0; i < count; ++i) {
+		if (!(flags[i] & FLAG_ATTACHED)) {
+			continue;
+		}
+
+		int objnum = m_attachedObjnum[i];
+		if ((objnum >= MAX_OBJECTS) || (m_attachedSig[i] != Objects[objnum].signature)) {
+			flags[i] |= FLAG_EXPIRED;
+		}
+	}
+}
+
+void ParticlePool::integrate(float frametime)
+{
+	const size_t count = size();
+	const float* vel_scales = m_velScale.data();
+
+	for (int axis = 0; axis < 3; ++axis) {
+		float* pos = m_pos[axis].data();
+		const float* vel = m_vel[axis].data();
+
+		for (size_t i = 0; i < count; ++i) {
+			pos[i] += (vel[i] * vel_scales[i]) * frametime;
+		}
+	}
+}
+
+void ParticlePool::compact()
+{
+	const size_t count = size();
+	size_t kept = 0;
+
+	for (size_t i = 0; i < count; ++i) {
+		if (m_flags[i] & FLAG_EXPIRED) {
+			continue;
+		}
+
+		if (kept != i) {
+			for (int axis = 0; axis < 3; ++axis) {
+				m_pos[axis][kept] = m_pos[axis][i];
+				m_vel[axis][kept] = m_vel[axis][i];
+			}
+			m_velScale[kept] = m_velScale[i];
+			m_age[kept] = m_age[i];
+			m_maxLife[kept] = m_maxLife[i];
+			m_attachedObjnum[kept] = m_attachedObjnum[i];
+			m_attachedSig[kept] = m_attachedSig[i];
+			m_flags[kept] = m_flags[i];
+			m_cold[kept] = std::move(m_cold[i]);
+		}
+
+		++kept;
+	}
+
+	if (kept == count) {
+		return;
+	}
+
+	for (int axis = 0; axis < 3; ++axis) {
+		m_pos[axis].resize(kept);
+		m_vel[axis].resize(kept);
+	}
+	m_velScale.resize(kept);
+	m_age.resize(kept);
+	m_maxLife.resize(kept);
+	m_attachedObjnum.resize(kept);
+	m_attachedSig.resize(kept);
+	m_flags.resize(kept);
+	m_cold.erase(m_cold.begin() + kept, m_cold.end());
+}
+
+particle& ParticlePool::get(size_t index)
+{
+	auto& part = m_cold[index];
+
+	for (int axis = 0; axis < 3; ++axis) {
+		part.pos.a1d[axis] = m_pos[axis][index];
+		part.velocity.a1d[axis] = m_vel[axis][index];
+	}
+	part.age = m_age[index];
+	part.max_life = m_maxLife[index];
+
+	return part;
+}
+
+}
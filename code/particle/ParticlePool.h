@@ -0,0 +1,91 @@
+#ifndef PARTICLE_POOL_H
+#define PARTICLE_POOL_H
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "particle/particle.h"
+
+namespace particle {
+
+/**
+ * @brief Stores non-persistent particles in structure of arrays layout
+ *
+ * @ingroup particleSystems
+ *
+ * The data touched by every particle every frame (position, velocity, age, lifetime and the attachment info needed to
+ * check for expiry) is kept in separate arrays, so that aging, expiry and integration are simple loops the compiler can
+ * vectorize. The rest of the particle is kept in a cold array of full #particle structs. The hot fields of those are
+ * only brought up to date by get(), for the code which needs the whole particle (curves, lighting and rendering).
+ */
+class ParticlePool {
+ public:
+	/**
+	 * @brief Per particle flags
+	 */
+	enum Flags : ubyte {
+		FLAG_LOOPING = 1 << 0,			//!< The particle never expires due to age
+		FLAG_ATTACHED = 1 << 1,			//!< The particle is attached to an object and dies with it
+		FLAG_VELOCITY_CURVE = 1 << 2,	//!< The velocity is scaled by a lifetime curve, see setVelocityScale()
+		FLAG_LIGHT = 1 << 3,			//!< The particle's effect emits light
+		FLAG_EXPIRED = 1 << 4,			//!< Set by age() if the particle is going to be removed by compact()
+	};
+
+ private:
+	SCP_vector<float> m_pos[3];
+	SCP_vector<float> m_vel[3];
+	SCP_vector<float> m_velScale; //!< Only differs from 1 for particles with FLAG_VELOCITY_CURVE
+	SCP_vector<float> m_age;
+	SCP_vector<float> m_maxLife;
+	SCP_vector<int> m_attachedObjnum;
+	SCP_vector<int> m_attachedSig;
+	SCP_vector<ubyte> m_flags;
+
+	SCP_vector<particle> m_cold;
+
+ public:
+	/**
+	 * @brief Adds a particle to the end of the pool
+	 * @param part The particle
+	 * @param flags Any of FLAG_VELOCITY_CURVE and FLAG_LIGHT. The other flags are derived from the particle.
+	 */
+	void add(particle&& part, ubyte flags);
+
+	void clear();
+
+	size_t size() const { return m_cold.size(); }
+
+	bool empty() const { return m_cold.empty(); }
+
+	ubyte flags(size_t index) const { return m_flags[index]; }
+
+	/**
+	 * @brief Ages all particles by one frame and sets FLAG_EXPIRED on the ones which have run out of time or lost the
+	 * object they are attached to
+	 */
+	void age(float frametime);
+
+	void setVelocityScale(size_t index, float scale) { m_velScale[index] = scale; }
+
+	float getVelocityScale(size_t index) const { return m_velScale[index]; }
+
+	/**
+	 * @brief Moves all particles along their scaled velocity
+	 */
+	void integrate(float frametime);
+
+	/**
+	 * @brief Removes the particles marked with FLAG_EXPIRED, keeping the remaining ones in order
+	 */
+	void compact();
+
+	/**
+	 * @brief Gets the complete particle at the given index
+	 *
+	 * @warning Changes to the position, velocity, age or lifetime of the returned particle are lost.
+	 */
+	particle& get(size_t index);
+};
+
+}
+
+#endif // PARTICLE_POOL_H
@@ -13,6 +13,7 @@
 #include "particle/particle.h"
 #include "particle/ParticleManager.h"
 #include "particle/ParticleEffect.h"
+#include "particle/ParticlePool.h"
 #include "debugconsole/console.h"
 #include "globalincs/systemvars.h"
 #include "graphics/2d.h"
@@ -31,9 +32,11 @@ using namespace particle;
 
 namespace
 {
-	SCP_vector<::particle::particle> Particles;
+	::particle::ParticlePool Particles;
 	SCP_vector<ParticlePtr> Persistent_particles;
 
+	thread_local EmissionBuffer* Emission_buffer = nullptr;
+
 	static int Particles_enabled = 1;
 
 	float get_current_alpha(vec3d* pos, float rad)
@@ -174,11 +177,29 @@ namespace particle
 		return false;
 	}
 
+	static void add_to_pool(particle&& new_particle) {
+		// the parts of the effect which decide how the particle gets moved don't change during its lifetime
+		const auto& source_effect = new_particle.parent_effect.getParticleEffect();
+
+		ubyte flags = 0;
+		if (source_effect.m_lifetime_curves.has_curve(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT))
+			flags |= ParticlePool::FLAG_VELOCITY_CURVE;
+		if (source_effect.hasLightSource())
+			flags |= ParticlePool::FLAG_LIGHT;
+
+		Particles.add(std::move(new_particle), flags);
+	}
+
 	void create(particle&& new_particle) {
 		if (maybe_cull_particle(new_particle))
 			return;
 
-		Particles.push_back(new_particle);
+		if (Emission_buffer != nullptr) {
+			Emission_buffer->particles.push_back(std::move(new_particle));
+			return;
+		}
+
+		add_to_pool(std::move(new_particle));
 	}
 
 	// Creates a single particle. See the PARTICLE_?? defines for types.
@@ -189,11 +210,30 @@ namespace particle
 
 		ParticlePtr new_particle_ptr = std::make_shared<particle>(new_particle);
 
-		Persistent_particles.push_back(new_particle_ptr);
+		if (Emission_buffer != nullptr)
+			Emission_buffer->persistent_particles.push_back(new_particle_ptr);
+		else
+			Persistent_particles.push_back(new_particle_ptr);
 
 		return {new_particle_ptr};
 	}
 
+	void set_emission_buffer(EmissionBuffer* buffer) {
+		Emission_buffer = buffer;
+	}
+
+	void merge_emission_buffer(EmissionBuffer& buffer) {
+		for (auto& part : buffer.particles) {
+			add_to_pool(std::move(part));
+		}
+		buffer.particles.clear();
+
+		for (auto& part : buffer.persistent_particles) {
+			Persistent_particles.push_back(std::move(part));
+		}
+		buffer.persistent_particles.clear();
+	}
+
 	float getPixelSize(const particle& subject_particle) {
 		vec3d world_pos = subject_particle.pos;
 
@@ -211,6 +251,87 @@ namespace particle
 			gr_screen.max_w);
 	}
 
+	/**
+	 * @brief Adds the light of a particle which has just been moved
+	 * @param source_effect The effect of the particle, which has to have a light source
+	 * @param part The particle
+	 * @param prev_pos The position of the particle before it has been moved
+	 * @param curve_velocity The velocity of the particle after applying the velocity curve
+	 */
+	void add_particle_light(const ParticleEffect& source_effect, const particle& part, const vec3d& prev_pos, float curve_velocity) {
+		const auto& curve_input = std::forward_as_tuple(part, curve_velocity);
+		const auto& light_source = *source_effect.m_light_source;
+
+		vec3d p_pos;
+		if (part.attached_objnum >= 0)
+		{
+			vm_vec_unrotate(&p_pos, &part.pos, &Objects[part.attached_objnum].orient);
+			vm_vec_add2(&p_pos, &Objects[part.attached_objnum].pos);
+		}
+		else
+		{
+			p_pos = part.pos;
+		}
+		
+		float light_radius = light_source.light_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_RADIUS_MULT, curve_input);
+		float source_radius = light_source.source_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_SOURCE_RADIUS_MULT, curve_input);
+		float intensity = light_source.intensity * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_INTENSITY_MULT, curve_input);
+		float r = light_source.r * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_R_MULT, curve_input);
+		float g = light_source.g * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_G_MULT, curve_input);
+		float b = light_source.b * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_B_MULT, curve_input);
+
+		if (light_radius <= 0.0f || intensity <= 0.0f) {
+			return;
+		}
+
+		switch (light_source.light_source_mode) {
+		case ParticleEffect::LightInformation::LightSourceMode::POINT:
+			light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+			break;
+		case ParticleEffect::LightInformation::LightSourceMode::TO_LAST_POS: {
+			vec3d p_prev_pos;
+			if (part.attached_objnum >= 0)
+			{
+				vm_vec_unrotate(&p_prev_pos, &prev_pos, &Objects[part.attached_objnum].last_orient);
+				vm_vec_add2(&p_prev_pos, &Objects[part.attached_objnum].last_pos);
+			}
+			else
+			{
+				p_prev_pos = prev_pos;
+			}
+			light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+		}
+		break;
+		case ParticleEffect::LightInformation::LightSourceMode::AS_PARTICLE:
+			if (part.length != 0.0f) {
+				vec3d p1;
+				vm_vec_copy_normalize_safe(&p1, &part.velocity);
+				if (part.attached_objnum >= 0) {
+					vm_vec_unrotate(&p1, &p1, &Objects[part.attached_objnum].orient);
+				}
+				p1 *= part.length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
+				p1 += p_pos;
+				light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius);
+			}
+			else {
+				light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
+			}
+			break;
+		case ParticleEffect::LightInformation::LightSourceMode::CONE: {
+			float cone_angle = light_source.cone_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_ANGLE_MULT, curve_input);
+			float cone_inner_angle = light_source.cone_inner_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_INNER_ANGLE_MULT, curve_input);
+			vec3d p1;
+			vm_vec_copy_normalize_safe(&p1, &part.velocity);
+			if (part.attached_objnum >= 0) {
+				vm_vec_unrotate(&p1, &p1, &Objects[part.attached_objnum].orient);
+			}
+
+			light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius);
+		}
+		break;
+		}
+	}
+
 	/**
 	 * @brief Moves a single particle
 	 * @param frametime The length of the current frame
@@ -264,83 +385,55 @@ namespace particle
 		vec3d prev_pos = part->pos;
 		part->pos += (part->velocity * vel_scalar) * frametime;
 
-		const auto& curve_input = std::forward_as_tuple(*part, part_velocity * vel_scalar);
+		if (Detail.lighting > 3 && source_effect.hasLightSource()) {
+			add_particle_light(source_effect, *part, prev_pos, part_velocity * vel_scalar);
+		}
+
+		return false;
+	}
 
-		if (Detail.lighting > 3 && source_effect.m_light_source) {
-			const auto& light_source = *source_effect.m_light_source;
+	/**
+	 * @brief Does what move_particle() does for all pooled particles, one step at a time for all of them
+	 *
+	 * Only the particles whose effect has a velocity curve or a light source need to look at their effect. Everything
+	 * else runs as simple passes over the pool's arrays.
+	 */
+	static void move_pool(float frametime) {
+		if (Particles.empty())
+			return;
 
-			vec3d p_pos;
-			if (part->attached_objnum >= 0)
-			{
-				vm_vec_unrotate(&p_pos, &part->pos, &Objects[part->attached_objnum].orient);
-				vm_vec_add2(&p_pos, &Objects[part->attached_objnum].pos);
-			}
-			else
-			{
-				p_pos = part->pos;
-			}
-			
-			float light_radius = light_source.light_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_RADIUS_MULT, curve_input);
-			float source_radius = light_source.source_radius * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_SOURCE_RADIUS_MULT, curve_input);
-			float intensity = light_source.intensity * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_INTENSITY_MULT, curve_input);
-			float r = light_source.r * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_R_MULT, curve_input);
-			float g = light_source.g * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_G_MULT, curve_input);
-			float b = light_source.b * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_B_MULT, curve_input);
-
-			// after this point it is only lighting code, so we can early return
-			if (light_radius <= 0.0f || intensity <= 0.0f) {
-				return false;
-			}
+		Particles.age(frametime);
 
-			switch (light_source.light_source_mode) {
-			case ParticleEffect::LightInformation::LightSourceMode::POINT:
-				light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-				break;
-			case ParticleEffect::LightInformation::LightSourceMode::TO_LAST_POS: {
-				vec3d p_prev_pos;
-				if (part->attached_objnum >= 0)
-				{
-					vm_vec_unrotate(&p_prev_pos, &prev_pos, &Objects[part->attached_objnum].last_orient);
-					vm_vec_add2(&p_prev_pos, &Objects[part->attached_objnum].last_pos);
-				}
-				else
-				{
-					p_prev_pos = prev_pos;
-				}
-				light_add_tube(&p_prev_pos, &p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-			}
-			break;
-			case ParticleEffect::LightInformation::LightSourceMode::AS_PARTICLE:
-				if (part->length != 0.0f) {
-					vec3d p1;
-					vm_vec_copy_normalize_safe(&p1, &part->velocity);
-					if (part->attached_objnum >= 0) {
-						vm_vec_unrotate(&p1, &p1, &Objects[part->attached_objnum].orient);
-					}
-					p1 *= part->length * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LENGTH_MULT, curve_input);
-					p1 += p_pos;
-					light_add_tube(&p_pos, &p1, light_radius, light_radius, intensity, r, g, b, source_radius);
-				}
-				else {
-					light_add_point(&p_pos, light_radius, light_radius, intensity, r, g, b, source_radius);
-				}
-				break;
-			case ParticleEffect::LightInformation::LightSourceMode::CONE: {
-				float cone_angle = light_source.cone_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_ANGLE_MULT, curve_input);
-				float cone_inner_angle = light_source.cone_inner_angle * source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::LIGHT_CONE_INNER_ANGLE_MULT, curve_input);
-				vec3d p1;
-				vm_vec_copy_normalize_safe(&p1, &part->velocity);
-				if (part->attached_objnum >= 0) {
-					vm_vec_unrotate(&p1, &p1, &Objects[part->attached_objnum].orient);
-				}
+		const size_t count = Particles.size();
 
-				light_add_cone(&p_pos, &p1, cone_angle, cone_inner_angle, false, light_radius, light_radius, intensity, r, g, b, source_radius);
-			}
-			break;
+		for (size_t i = 0; i < count; ++i) {
+			if ((Particles.flags(i) & (ParticlePool::FLAG_VELOCITY_CURVE | ParticlePool::FLAG_EXPIRED)) != ParticlePool::FLAG_VELOCITY_CURVE)
+				continue;
+
+			const auto& part = Particles.get(i);
+			const auto& source_effect = part.parent_effect.getParticleEffect();
+
+			Particles.setVelocityScale(i, source_effect.m_lifetime_curves.get_output(ParticleEffect::ParticleLifetimeCurvesOutput::VELOCITY_MULT, std::forward_as_tuple(part, vm_vec_mag_quick(&part.velocity))));
+		}
+
+		Particles.integrate(frametime);
+
+		if (Detail.lighting > 3) {
+			for (size_t i = 0; i < count; ++i) {
+				if ((Particles.flags(i) & (ParticlePool::FLAG_LIGHT | ParticlePool::FLAG_EXPIRED)) != ParticlePool::FLAG_LIGHT)
+					continue;
+
+				const auto& part = Particles.get(i);
+				float vel_scale = Particles.getVelocityScale(i);
+
+				vec3d prev_pos = part.pos;
+				vm_vec_scale_add2(&prev_pos, &part.velocity, -vel_scale * frametime);
+
+				add_particle_light(part.parent_effect.getParticleEffect(), part, prev_pos, vm_vec_mag_quick(&part.velocity) * vel_scale);
 			}
 		}
 
-		return false;
+		Particles.compact();
 	}
 
 	void move_all(float frametime)
@@ -374,25 +467,7 @@ namespace particle
 			++p;
 		}
 
-		for (auto p = Particles.begin(); p != Particles.end();)
-		{
-			if (move_particle(frametime, &(*p)))
-			{
-				// if we're sitting on the very last particle, popping-back will invalidate the iterator!
-				if (p + 1 == Particles.end())
-				{
-					Particles.pop_back();
-					break;
-				}
-
-				*p = Particles.back();
-				Particles.pop_back();
-				continue;
-			}
-
-			// next particle
-			++p;
-		}
+		move_pool(frametime);
 	}
 
 	// kill all active particles
@@ -530,8 +605,8 @@ namespace particle
 			render_particle(part.get());
 		}
 
-		for (auto& part : Particles) {
-			render_particle(&part);
+		for (size_t i = 0; i < Particles.size(); ++i) {
+			render_particle(&Particles.get(i));
 		}
 
 	}
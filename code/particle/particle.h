@@ -117,6 +117,30 @@ namespace particle
 	 */
 	WeakParticlePtr createPersistent(particle&& new_particle);
 
+	/**
+	 * @brief Particles which have been created while an emission buffer was set
+	 *
+	 * Particle sources which are processed on worker threads can't add their particles to the global lists directly.
+	 * Instead, each of them collects its particles here, and the buffers are merged into the lists afterwards.
+	 */
+	struct EmissionBuffer {
+		SCP_vector<particle> particles;
+		SCP_vector<ParticlePtr> persistent_particles;
+	};
+
+	/**
+	 * @brief Makes create() and createPersistent() add to the given buffer if they are called from the current thread
+	 * @param buffer The buffer, or @c nullptr to add to the global lists again
+	 */
+	void set_emission_buffer(EmissionBuffer* buffer);
+
+	/**
+	 * @brief Adds the particles of a buffer to the global lists and empties the buffer
+	 *
+	 * Must be called from the main thread.
+	 */
+	void merge_emission_buffer(EmissionBuffer& buffer);
+
 	float getPixelSize(const particle& subject_particle);
 }
 
@@ -335,6 +335,8 @@ ADE_VIRTVAR(Orientation, l_SubmodelInstance, "orientation", "Gets or sets the su
 
 		smi->cur_angle = angle;
 		smi->turret_idle_angle = angle;
+
+		submodel_invalidate_transform(smi);
 	}
 
 	return ade_set_args(L, "o", l_Matrix.Set(matrix_h(&smi->canonical_orient)));
@@ -363,6 +365,8 @@ ADE_VIRTVAR(TranslationOffset,
 		smi->canonical_offset = *vec;
 
 		smi->cur_offset = vm_vec_mag(vec);
+
+		submodel_invalidate_transform(smi);
 	}
 
 	return ade_set_args(L, "o", l_Vector.Set(smih->Get()->canonical_offset));
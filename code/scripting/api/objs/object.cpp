@@ -16,6 +16,7 @@
 #include "debris/debris.h"
 #include "jumpnode/jumpnode.h"
 #include "object/objcollide.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "scripting/api/LuaEventCallback.h"
@@ -179,6 +180,8 @@ ADE_VIRTVAR(Position, l_Object, "vector", "Object world position (World vector)"
 
 		if (objh->objp()->flags[Object::Object_Flags::Collides])
 			obj_collide_obj_cache_stale(objh->objp());
+
+		obj_grid_update(objh->objp());
 	}
 
 	return ade_set_args(L, "o", l_Vector.Set(objh->objp()->pos));
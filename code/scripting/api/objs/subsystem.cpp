@@ -182,6 +182,8 @@ ADE_VIRTVAR(Orientation, l_Subsystem, "orientation", "Orientation of subobject o
 
 		smi->cur_angle = angle;
 		smi->turret_idle_angle = angle;
+
+		submodel_invalidate_transform(smi);
 	}
 
 	return ade_set_args(L, "o", l_Matrix.Set(matrix_h(&smi->canonical_orient)));
@@ -205,6 +207,8 @@ ADE_VIRTVAR(GunOrientation, l_Subsystem, "orientation", "Orientation of turret g
 	{
 		smi->canonical_prev_orient = smi->canonical_orient;
 		smi->canonical_orient = *mh->GetMatrix();
+
+		submodel_invalidate_transform(smi);
 	}
 
 	return ade_set_args(L, "o", l_Matrix.Set(matrix_h(&smi->canonical_orient)));
@@ -235,6 +239,8 @@ ADE_VIRTVAR(TranslationOffset,
 		smi->canonical_offset = *vec;
 
 		smi->cur_offset = vm_vec_mag(vec);
+
+		submodel_invalidate_transform(smi);
 	}
 
 	return ade_set_args(L, "o", l_Vector.Set(smi->canonical_offset));
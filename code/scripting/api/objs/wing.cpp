@@ -55,9 +55,7 @@ ADE_VIRTVAR(Name, l_Wing, "string", "Name of Wing", "string", "Wing name, or emp
 		return ade_set_error(L, "s", "");
 
 	if(ADE_SETTING_VAR && s != NULL) {
-		auto len = sizeof(Wings[wdx].name);
-		strncpy(Wings[wdx].name, s, len);
-		Wings[wdx].name[len - 1] = 0;
+		wing_rename(wdx, s);
 	}
 
 	return ade_set_args(L, "s", Wings[wdx].name);
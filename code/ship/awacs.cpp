@@ -481,9 +481,14 @@ int ship_is_visible_by_team(const object *target, const ship *viewer)
 	int team = viewer->team;
 
 	// this can happen in multi, where networking is processed before first frame sim
+	awacs_ensure_processed();
+
+	return Ship_visibility_by_team[team][ship_num] ? 1 : 0;
+}
+
+void awacs_ensure_processed()
+{
 	if (Awacs_stamp.isImmediate()) {
 		awacs_process();
 	}
-
-	return Ship_visibility_by_team[team][ship_num] ? 1 : 0;
 }
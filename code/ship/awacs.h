@@ -33,6 +33,9 @@ void awacs_level_init();
 // call every frame to process AWACS details
 void awacs_process();
 
+// brings the AWACS details up to date if they haven't been processed since the level started
+void awacs_ensure_processed();
+
 // get the total AWACS level for target to viewer
 // < 0.0f		: untargetable
 // 0.0 - 1.0f	: marginally targetable
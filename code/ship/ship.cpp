@@ -64,6 +64,7 @@
 #include "object/objcollide.h"
 #include "object/object.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "object/waypoint.h"
@@ -266,6 +267,95 @@ const ship_registry_entry *ship_registry_get(const SCP_string &name)
 	return nullptr;
 }
 
+// The slots of the ships and wings with a given name, so that looking up a name doesn't have to compare it against every
+// slot.  Names should be unique, but the lookups have always returned the lowest matching slot, so every slot is kept,
+// sorted by index.
+typedef SCP_unordered_map<SCP_string, SCP_vector<int>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> name_index_map;
+static name_index_map Ship_name_index;
+static name_index_map Wing_name_index;
+
+static void name_index_add(name_index_map &index, const char *name, int slot)
+{
+	auto &slots = index[name];
+
+	auto it = std::lower_bound(slots.begin(), slots.end(), slot);
+	if (it == slots.end() || *it != slot)
+		slots.insert(it, slot);
+}
+
+static void name_index_remove(name_index_map &index, const char *name, int slot)
+{
+	auto index_it = index.find(name);
+	if (index_it == index.end())
+		return;
+
+	auto &slots = index_it->second;
+	slots.erase(std::remove(slots.begin(), slots.end(), slot), slots.end());
+	if (slots.empty())
+		index.erase(index_it);
+}
+
+static const SCP_vector<int> *name_index_find(const name_index_map &index, const char *name)
+{
+	auto index_it = index.find(name);
+	if (index_it == index.end())
+		return nullptr;
+
+	return &index_it->second;
+}
+
+void ship_name_index_add(int shipnum)
+{
+	name_index_add(Ship_name_index, Ships[shipnum].ship_name, shipnum);
+}
+
+void ship_name_index_remove(int shipnum)
+{
+	name_index_remove(Ship_name_index, Ships[shipnum].ship_name, shipnum);
+}
+
+void ship_rename(int shipnum, const char *new_name)
+{
+	ship_name_index_remove(shipnum);
+
+	auto shipp = &Ships[shipnum];
+	auto len = sizeof(shipp->ship_name);
+	strncpy(shipp->ship_name, new_name, len);
+	shipp->ship_name[len - 1] = 0;
+
+	ship_name_index_add(shipnum);
+}
+
+void ship_rename_in_wing(int shipnum, const char *wing_name, int index)
+{
+	char new_name[NAME_LENGTH];
+	wing_bash_ship_name(new_name, wing_name, index);
+
+	ship_rename(shipnum, new_name);
+}
+
+void wing_name_index_add(int wingnum)
+{
+	name_index_add(Wing_name_index, Wings[wingnum].name, wingnum);
+}
+
+void wing_name_index_clear()
+{
+	Wing_name_index.clear();
+}
+
+void wing_rename(int wingnum, const char *new_name)
+{
+	name_index_remove(Wing_name_index, Wings[wingnum].name, wingnum);
+
+	auto wingp = &Wings[wingnum];
+	auto len = sizeof(wingp->name);
+	strncpy(wingp->name, new_name, len);
+	wingp->name[len - 1] = 0;
+
+	wing_name_index_add(wingnum);
+}
+
 
 int	Num_engine_wash_types;
 int	Num_ship_subobj_types;
@@ -796,6 +886,7 @@ static int ship_obj_list_add(int objnum)
 	Ship_objs[i].objnum = objnum;
 	list_append(&Ship_obj_list, &Ship_objs[i]);
 	Ship_objs[i].flags |= SHIP_OBJ_USED;
+	obj_grid_add(&Objects[objnum]);
 
 	return i;
 }
@@ -808,6 +899,7 @@ static void ship_obj_list_remove(int index)
 {
 	Assert(index >= 0 && index < MAX_SHIP_OBJS);
 	list_remove( Ship_obj_list, &Ship_objs[index]);	
+	obj_grid_remove(&Objects[Ship_objs[index].objnum]);
 	ship_obj_list_reset_slot(index);
 }
 
@@ -6774,10 +6866,12 @@ void ship_level_init()
 		Ships[i].ship_name[0] = '\0';
 		Ships[i].objnum = -1;
 	}
+	Ship_name_index.clear();
 
 	Num_wings = 0;
 	for (i = 0; i < MAX_WINGS; i++ )
 		Wings[i].clear();
+	Wing_name_index.clear();
 
 	for (i=0; i<MAX_STARTING_WINGS; i++)
 		Starting_wings[i] = -1;
@@ -8823,6 +8917,7 @@ void ship_delete( object * obj )
 	// free up the list of subsystems of this ship.  walk through list and move remaining subsystems
 	// on ship back to the free list for other ships to use.
 	ship_subsystems_delete(&Ships[num]);
+	ship_name_index_remove(num);
 	shipp->objnum = -1;
 
 	animation::ModelAnimationSet::stopAnimations(model_get_instance(shipp->model_instance_num));
@@ -11522,6 +11617,7 @@ int ship_create(matrix* orient, vec3d* pos, int ship_type, const char* ship_name
 		}
 		strcpy_s(shipp->ship_name, ship_name);
 	}
+	ship_name_index_add(shipnum);
 
 	ship_set_default_weapons(shipp, sip);	//	Moved up here because ship_set requires that weapon info be valid.  MK, 4/28/98
 	ship_set(shipnum, objnum, ship_type);
@@ -15117,24 +15213,29 @@ void wing_bash_ship_name(char *ship_name, const char *wing_name, int index, bool
  */
 int wing_name_lookup(const char *name, int ignore_count)
 {
-	int i, wing_limit;
+	int i;
 
 	Assertion(name != nullptr, "NULL name passed to wing_name_lookup");
 
-	if ( Fred_running )
-		wing_limit = MAX_WINGS;
-	else
-		wing_limit = Num_wings;
-
-	if (Fred_running || ignore_count ) {  // current_count not used for Fred..
-		for (i=0; i<wing_limit; i++)
+	// FRED changes wing names directly, so it can't use the index
+	if ( Fred_running ) {
+		for (i=0; i<MAX_WINGS; i++)
 			if (Wings[i].wave_count && !stricmp(Wings[i].name, name))
 				return i;
 
-	} else {
-		for (i=0; i<wing_limit; i++)
-			if (Wings[i].current_count && !stricmp(Wings[i].name, name))
-				return i;
+		return -1;
+	}
+
+	auto wings = name_index_find(Wing_name_index, name);
+	if (wings == nullptr)
+		return -1;
+
+	for (int wingnum : *wings) {
+		if (wingnum >= Num_wings)
+			break;
+
+		if (ignore_count ? Wings[wingnum].wave_count : Wings[wingnum].current_count)
+			return wingnum;
 	}
 
 	return -1;
@@ -15153,11 +15254,19 @@ int wing_lookup(const char *name)
 {
 	Assertion(name != nullptr, "NULL name passed to wing_lookup");
 
-	for(int idx=0;idx<Num_wings;idx++)
-		if(stricmp(Wings[idx].name,name)==0)
-		   return idx;
+	if (Fred_running) {
+		for(int idx=0;idx<Num_wings;idx++)
+			if(stricmp(Wings[idx].name,name)==0)
+			   return idx;
 
-	return -1;
+		return -1;
+	}
+
+	auto wings = name_index_find(Wing_name_index, name);
+	if (wings == nullptr || wings->front() >= Num_wings)
+		return -1;
+
+	return wings->front();
 }
 
 int wing_formation_lookup(const char *formation_name)
@@ -15342,12 +15451,29 @@ int ship_name_lookup(const char *name, int inc_players)
 {
 	Assertion(name != nullptr, "NULL name passed to ship_name_lookup");
 
-	for (int i=0; i<MAX_SHIPS; i++){
+	// FRED changes ship names directly, so it can't use the index
+	if (Fred_running) {
+		for (int i=0; i<MAX_SHIPS; i++){
+			if (Ships[i].objnum >= 0){
+				if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)){
+					if (!stricmp(name, Ships[i].ship_name)){
+						return i;
+					}
+				}
+			}
+		}
+
+		return -1;
+	}
+
+	auto ships = name_index_find(Ship_name_index, name);
+	if (ships == nullptr)
+		return -1;
+
+	for (int i : *ships) {
 		if (Ships[i].objnum >= 0){
 			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)){
-				if (!stricmp(name, Ships[i].ship_name)){
-					return i;
-				}
+				return i;
 			}
 		}
 	}
@@ -21523,6 +21649,7 @@ void ship_render_weapon_models(model_render_params *ship_render_info, model_draw
 					angles angs = vmd_zero_angles;
 					angs.b = shipp->primary_rotate_ang[i];
 					vm_angles_2_matrix(&pmi->submodel[mn].canonical_orient, &angs);
+					submodel_invalidate_transform(&pmi->submodel[mn]);
 				}
 			}
 		}
@@ -966,6 +966,18 @@ extern bool ship_registry_exists(const SCP_string &name);
 extern const ship_registry_entry *ship_registry_get(const char *name);
 extern const ship_registry_entry *ship_registry_get(const SCP_string &name);
 
+// The index behind ship_name_lookup, wing_name_lookup and wing_lookup.  ship_create and ship_delete add and remove
+// ships, wings are added once they have been parsed.  Names of existing ships and wings must be changed with the
+// rename functions, otherwise the lookups won't find them.
+extern void ship_name_index_add(int shipnum);
+extern void ship_name_index_remove(int shipnum);
+extern void ship_rename(int shipnum, const char *new_name);
+// gives a ship the name of the given position in a wing, see wing_bash_ship_name()
+extern void ship_rename_in_wing(int shipnum, const char *wing_name, int index);
+extern void wing_name_index_add(int wingnum);
+extern void wing_name_index_clear();
+extern void wing_rename(int wingnum, const char *new_name);
+
 #define REGULAR_WEAPON	(1<<0)
 #define DOGFIGHT_WEAPON (1<<1)
 
@@ -259,11 +259,41 @@ int ds_get_sid()
 	return (int)(sound_buffers.size() - 1);
 }
 
-int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
+void ds_read_pcm(sound::IAudioFile* file, SCP_vector<uint8_t>& audio_buffer)
 {
-	Assert(sid != NULL);
 	Assert(file != NULL);
 
+	const auto fileProps = file->getFileProperties();
+
+	audio_buffer.clear();
+	audio_buffer.reserve(fileProps.total_samples * fileProps.bytes_per_sample * fileProps.num_channels);
+
+	SCP_vector<uint8_t> buffer(fileProps.sample_rate * fileProps.bytes_per_sample * fileProps.num_channels);
+	int read;
+	while((read = file->Read(&buffer[0], buffer.size())) >= 0) {
+		if (read == 0) {
+			// buffer not large enough
+			buffer.resize(buffer.size() * 2);
+		} else {
+			audio_buffer.insert(audio_buffer.end(), buffer.begin(), std::next(buffer.begin(), read));
+		}
+	}
+}
+
+int ds_load_buffer(int *sid, int flags, sound::IAudioFile* file)
+{
+	Assert(file != NULL);
+
+	SCP_vector<uint8_t> audio_buffer;
+	ds_read_pcm(file, audio_buffer);
+
+	return ds_load_buffer(sid, flags, file->getFileProperties(), audio_buffer.data(), audio_buffer.size());
+}
+
+int ds_load_buffer(int *sid, int  /*flags*/, const sound::AudioFileProperties& fileProps, const uint8_t* data, size_t size)
+{
+	Assert(sid != NULL);
+
 	// All sounds are required to have a software buffer
 	*sid = ds_get_sid();
 	if (*sid == -1) {
@@ -274,10 +304,7 @@ int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
 	ALuint pi;
 	OpenAL_ErrorCheck(alGenBuffers(1, &pi), return -1);
 
-	const auto fileProps = file->getFileProperties();
-
 	ALenum format;
-	ALsizei size = fileProps.total_samples * fileProps.bytes_per_sample * fileProps.num_channels;
 	ALint n_channels = fileProps.num_channels;
 	ALsizei frequency;
 		
@@ -289,23 +316,9 @@ int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
 		return -1;
 	}
 
-	SCP_vector<uint8_t> audio_buffer;
-	audio_buffer.reserve(size);
-
-	SCP_vector<uint8_t> buffer(fileProps.sample_rate * fileProps.bytes_per_sample * fileProps.num_channels);
-	int read;
-	while((read = file->Read(&buffer[0], buffer.size())) >= 0) {
-		if (read == 0) {
-			// buffer not large enough
-			buffer.resize(buffer.size() * 2);
-		} else {
-			audio_buffer.insert(audio_buffer.end(), buffer.begin(), std::next(buffer.begin(), read));
-		}
-	}
-
-	Snd_sram += audio_buffer.size();
+	Snd_sram += size;
 
-	OpenAL_ErrorCheck(alBufferData(pi, format, audio_buffer.data(), (ALsizei)audio_buffer.size(), frequency), return -1; );
+	OpenAL_ErrorCheck(alBufferData(pi, format, data, (ALsizei)size, frequency), return -1; );
 
 	sound_buffers[*sid].buf_id = pi;
 	sound_buffers[*sid].channel_id = -1;
@@ -313,7 +326,7 @@ int ds_load_buffer(int *sid, int  /*flags*/, sound::IAudioFile* file)
 	sound_buffers[*sid].bits_per_sample = fileProps.bytes_per_sample * 8;
 	sound_buffers[*sid].nchannels = n_channels;
 	sound_buffers[*sid].nseconds = fl2i(fileProps.duration);
-	sound_buffers[*sid].nbytes = (int)audio_buffer.size();
+	sound_buffers[*sid].nbytes = (int)size;
 
 	return 0;
 }
@@ -59,6 +59,18 @@ using ds_sound_handle = ::util::ID<ds_sound_handle_tag, int, -1>;
 int ds_init();
 void ds_close();
 int ds_load_buffer(int *sid, int flags, sound::IAudioFile* file);
+/**
+ * @brief Uploads PCM data, e.g. from ds_read_pcm, into a new buffer
+ *
+ * @details Like the other overload, this has to be called from the thread which owns the OpenAL context.
+ */
+int ds_load_buffer(int *sid, int flags, const sound::AudioFileProperties& fileProps, const uint8_t* data, size_t size);
+/**
+ * @brief Reads all PCM data of a file
+ *
+ * @details Doesn't touch any sound system state, so this may run on a worker thread which has the file to itself.
+ */
+void ds_read_pcm(sound::IAudioFile* file, SCP_vector<uint8_t>& audio_buffer);
 void ds_unload_buffer(int sid);
 ds_sound_handle ds_play(int sid, int snd_id, int priority, const EnhancedSoundData* enhanced_sound_data, float volume,
                         float pan, int looping, bool is_voice_msg = false);
@@ -8,6 +8,7 @@
 */
 
 #include "cfile/cfile.h"
+#include "cfile/cfilesystem.h"
 #include "cmdline/cmdline.h"
 #include "debugconsole/console.h"
 #include "gamesnd/eventmusic.h"
@@ -26,12 +27,16 @@
 #include "sound/dscap.h"
 #include "tracing/Monitor.h"
 #include "tracing/tracing.h"
+#include "utils/threading.h"
 
 #ifdef WITH_FFMPEG
 #include "sound/ffmpeg/FFmpegWaveFile.h"
 #endif
 
 #include <climits>
+#include <cstring>
+#include <memory>
+#include <type_traits>
 
 #define SND_F_USED			(1<<0)		// Sounds[] element is used
 
@@ -47,6 +52,52 @@ struct loaded_sound {
 
 SCP_vector<loaded_sound> Sounds;
 
+// The indices of the used Sounds[] elements by filename, so that snd_load() doesn't have to compare the filename of
+// every loaded sound
+static SCP_unordered_map<SCP_string, SCP_vector<size_t>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Sound_filename_index;
+
+#define SOUND_CACHE_ID			0x444E5353		// "SSND"
+#define SOUND_CACHE_VERSION		1
+
+// Kept in the user directory next to the pack index and volumetric nebula caches
+static constexpr uint32_t SOUND_CACHE_LOCATION = CF_LOCATION_ROOT_USER | CF_LOCATION_ROOT_GAME | CF_LOCATION_TYPE_ROOT;
+
+// The decoded data of a sound depends on the contents of the file and on whether it is resampled for 3D playback
+struct sound_cache_key {
+	uint checksum = 0;
+	uint size = 0;
+	int use_ds3d = 0;
+
+	bool operator==(const sound_cache_key& other) const {
+		return checksum == other.checksum && size == other.size && use_ds3d == other.use_ds3d;
+	}
+};
+
+// The PCM data of a sound, which is decoded by a worker thread if the sound has been queued with snd_queue_load()
+struct decoded_sound {
+	SCP_vector<uint8_t> file_data; // the contents of the file, cfile is only used on the main thread
+	bool use_ds3d = false;
+
+	// empty if -sound_cache isn't used
+	SCP_string cache_path;
+	sound_cache_key cache_key;
+
+	bool valid = false; // false if the file couldn't be decoded
+	bool resampled = false;
+	sound::AudioFileProperties props;
+
+	// the PCM data, either decoded into data or mapped from the cache
+	SCP_vector<uint8_t> data;
+	std::unique_ptr<cf_file_mapping> mapping;
+	const uint8_t* pcm = nullptr;
+	size_t pcm_size = 0;
+
+	threading::job_counter done;
+};
+
+// The first map has the sounds for 2D playback, the second the ones for 3D playback which are resampled to mono
+static SCP_unordered_map<SCP_string, std::unique_ptr<decoded_sound>, SCP_string_lcase_hash, SCP_string_lcase_equal_to> Queued_sounds[2];
+
 int Sound_enabled = FALSE;				// global flag to turn sound on/off
 size_t Snd_sram;								// mem (in bytes) used up by storing sounds in system memory
 
@@ -175,6 +226,7 @@ int ds_priority(int priority)
 void snd_clear()
 {
 	Sounds.clear();
+	Sound_filename_index.clear();
 
 	// reset how much storage sounds are taking up in memory
 	Snd_sram = 0;
@@ -215,6 +267,10 @@ int snd_init()
 
 	// Init the audio streaming stuff
 	audiostream_init();
+
+	if (Cmdline_sound_cache) {
+		cf_create_directory(CF_TYPE_CACHE, SOUND_CACHE_LOCATION);
+	}
 			
 	ds_initialized = 1;
 	Sound_enabled = TRUE;
@@ -315,6 +371,296 @@ static std::unique_ptr<sound::IAudioFile> openAudioFile(const char* fileName)
 	return nullptr;
 }
 
+static std::unique_ptr<sound::IAudioFile> openAudioFileMem(const SCP_vector<uint8_t>& fileData)
+{
+#ifdef WITH_FFMPEG
+	{
+		std::unique_ptr<sound::IAudioFile> audio_file(new sound::ffmpeg::FFmpegWaveFile());
+
+		if (audio_file->OpenMem(fileData.data(), fileData.size())) {
+			return audio_file;
+		}
+	}
+#endif
+
+	return nullptr;
+}
+
+// Sounds used for 3D playback have to be resampled to one channel, returns true if that was necessary
+static bool resampleAudioFile(sound::IAudioFile* audio_file, bool use_ds3d)
+{
+	if (!use_ds3d || audio_file->getFileProperties().num_channels <= 1) {
+		return false;
+	}
+
+	sound::ResampleProperties resample;
+	resample.num_channels = 1;
+
+	audio_file->setResamplingProperties(resample);
+	return true;
+}
+
+// Followed by data_size bytes of PCM data. Written as a whole, so the version has to change whenever this does.
+struct sound_cache_header {
+	uint id = 0;
+	uint version = 0;
+	sound_cache_key key;
+	int resampled = 0;
+	int bytes_per_sample = 0;
+	int total_samples = 0;
+	int num_channels = 0;
+	int sample_rate = 0;
+	double duration = 0.0;
+	uint64_t data_size = 0;
+};
+
+static_assert(std::is_trivially_copyable<sound_cache_header>::value, "The sound cache header is written as it is!");
+
+// One file per sound, named after the sound so that sounds with the same contents can't write the same file at once
+static SCP_string getSoundCachePath(const char* filename, const sound_cache_key& key)
+{
+	uint hash = 2166136261u;
+
+	for (auto c = filename; *c != '\0'; ++c) {
+		hash = (hash ^ static_cast<ubyte>(SCP_tolower(*c))) * 16777619u;
+	}
+	for (uint value : {key.checksum, key.size, static_cast<uint>(key.use_ds3d)}) {
+		hash = (hash ^ value) * 16777619u;
+	}
+
+	SCP_string cache_filename;
+	sprintf(cache_filename, "sound_%08x.bin", hash);
+
+	SCP_string cache_path;
+	cf_create_default_path_string(cache_path, CF_TYPE_CACHE, cache_filename.c_str(), SOUND_CACHE_LOCATION);
+	return cache_path;
+}
+
+// Maps the PCM data of a sound from the cache, may run on a worker thread
+static bool loadSoundCache(decoded_sound* snd)
+{
+	if (Cmdline_rebuild_file_cache) {
+		return false;
+	}
+
+	std::unique_ptr<cf_file_mapping> mapping(new cf_file_mapping());
+	if (!mapping->map(snd->cache_path.c_str())) {
+		return false;
+	}
+
+	sound_cache_header header;
+	bool ok = mapping->size() >= sizeof(header);
+
+	if (ok) {
+		memcpy(&header, mapping->data(), sizeof(header));
+
+		ok = (header.id == SOUND_CACHE_ID) && (header.version == SOUND_CACHE_VERSION) && (header.key == snd->cache_key);
+		ok = ok && (header.data_size == mapping->size() - sizeof(header));
+	}
+
+	if (!ok) {
+		mprintf(("Sound cache '%s' is invalid or outdated, ignoring it.\n", snd->cache_path.c_str()));
+		return false;
+	}
+
+	snd->resampled = header.resampled != 0;
+	snd->props.bytes_per_sample = header.bytes_per_sample;
+	snd->props.total_samples = header.total_samples;
+	snd->props.num_channels = header.num_channels;
+	snd->props.sample_rate = header.sample_rate;
+	snd->props.duration = header.duration;
+
+	snd->pcm = mapping->data() + sizeof(header);
+	snd->pcm_size = static_cast<size_t>(header.data_size);
+	snd->mapping = std::move(mapping);
+
+	return true;
+}
+
+// May run on a worker thread
+static void saveSoundCache(const decoded_sound* snd)
+{
+	// write to a temporary file first, so that another instance which is loading at the same time can't map half of it
+	SCP_string temp_path = snd->cache_path + ".tmp";
+
+	FILE* fp = fopen(temp_path.c_str(), "wb");
+
+	if (!fp) {
+		mprintf(("Could not write sound cache '%s'!\n", temp_path.c_str()));
+		return;
+	}
+
+	sound_cache_header header;
+	header.id = SOUND_CACHE_ID;
+	header.version = SOUND_CACHE_VERSION;
+	header.key = snd->cache_key;
+	header.resampled = snd->resampled ? 1 : 0;
+	header.bytes_per_sample = snd->props.bytes_per_sample;
+	header.total_samples = snd->props.total_samples;
+	header.num_channels = snd->props.num_channels;
+	header.sample_rate = snd->props.sample_rate;
+	header.duration = snd->props.duration;
+	header.data_size = snd->pcm_size;
+
+	fwrite(&header, sizeof(header), 1, fp);
+	fwrite(snd->pcm, 1, snd->pcm_size, fp);
+
+	bool ok = (ferror(fp) == 0);
+	ok = (fclose(fp) == 0) && ok;
+
+	if (ok) {
+		// rename() won't replace an existing file on Windows
+		remove(snd->cache_path.c_str());
+		ok = (rename(temp_path.c_str(), snd->cache_path.c_str()) == 0);
+	}
+
+	if (!ok) {
+		mprintf(("Could not write sound cache '%s'!\n", snd->cache_path.c_str()));
+		remove(temp_path.c_str());
+	}
+}
+
+// Reads a sound file into memory, returns nullptr if it can't be found or read
+static std::unique_ptr<decoded_sound> readSoundFile(const char* filename, bool use_ds3d)
+{
+	auto res = cf_find_file_location_ext(filename, NUM_AUDIO_EXT, audio_ext_list, CF_TYPE_ANY);
+	if (!res.found)
+		return nullptr;
+
+	auto cfp = cfopen_special(res, "rb", CF_TYPE_ANY);
+	if (cfp == nullptr)
+		return nullptr;
+
+	std::unique_ptr<decoded_sound> snd(new decoded_sound());
+	snd->use_ds3d = use_ds3d;
+	snd->file_data.resize(cfilelength(cfp));
+	auto read = cfread(snd->file_data.data(), 1, static_cast<int>(snd->file_data.size()), cfp);
+	cfclose(cfp);
+
+	if (read != static_cast<int>(snd->file_data.size()))
+		return nullptr;
+
+	if (Cmdline_sound_cache) {
+		snd->cache_key.checksum = cf_add_chksum_long(0, snd->file_data.data(), snd->file_data.size());
+		snd->cache_key.size = static_cast<uint>(snd->file_data.size());
+		snd->cache_key.use_ds3d = use_ds3d ? 1 : 0;
+		snd->cache_path = getSoundCachePath(filename, snd->cache_key);
+	}
+
+	return snd;
+}
+
+// Decodes a sound which has been read with readSoundFile(), or maps it from the cache. May run on a worker thread.
+static void decodeSound(decoded_sound* snd)
+{
+	if (!snd->cache_path.empty() && loadSoundCache(snd)) {
+		snd->file_data = SCP_vector<uint8_t>();
+		snd->valid = true;
+		return;
+	}
+
+	auto audio_file = openAudioFileMem(snd->file_data);
+	snd->file_data = SCP_vector<uint8_t>();
+
+	if (audio_file == nullptr) {
+		return;
+	}
+
+	snd->resampled = resampleAudioFile(audio_file.get(), snd->use_ds3d);
+	snd->props = audio_file->getFileProperties();
+
+	ds_read_pcm(audio_file.get(), snd->data);
+	snd->pcm = snd->data.data();
+	snd->pcm_size = snd->data.size();
+	snd->valid = true;
+
+	if (!snd->cache_path.empty()) {
+		saveSoundCache(snd);
+	}
+}
+
+static void snd_index_add(size_t n)
+{
+	Sound_filename_index[Sounds[n].filename].push_back(n);
+}
+
+static void snd_index_remove(size_t n)
+{
+	auto iter = Sound_filename_index.find(Sounds[n].filename);
+	if (iter == Sound_filename_index.end()) {
+		return;
+	}
+
+	auto& indices = iter->second;
+	indices.erase(std::remove(indices.begin(), indices.end(), n), indices.end());
+	if (indices.empty()) {
+		Sound_filename_index.erase(iter);
+	}
+}
+
+// Returns the lowest index of a loaded sound which can be used for the file, or -1 if there is none
+//
+// NOTE: this will allow a duplicate 3D entry if 2D stereo entry exists,
+//       but will not load a duplicate 2D entry to get stereo if 3D
+//       version already loaded
+static int snd_find_loaded(const char* filename, bool use_ds3d)
+{
+	auto iter = Sound_filename_index.find(filename);
+	if (iter == Sound_filename_index.end()) {
+		return -1;
+	}
+
+	int found = -1;
+	for (auto n : iter->second) {
+		// make sure the sound is actually loaded in a compatible way (2D vs. 3D)
+		if ( (Sounds[n].info.n_channels == 1) || !use_ds3d ) {
+			if (found < 0 || static_cast<int>(n) < found) {
+				found = static_cast<int>(n);
+			}
+		}
+	}
+
+	return found;
+}
+
+void snd_queue_load(const game_snd_entry* entry, int flags)
+{
+	if (!ds_initialized || !threading::is_threading())
+		return;
+
+	if ((flags & GAME_SND_NOT_VALID) || !VALID_FNAME(entry->filename))
+		return;
+
+	// Sounds which are loaded already are queued anyway, since the callers queue the mission sounds before the
+	// interface sounds, which are usually the same, are unloaded
+	bool use_ds3d = (flags & GAME_SND_USE_DS3D) != 0;
+	auto& queue = Queued_sounds[use_ds3d ? 1 : 0];
+	if (queue.find(entry->filename) != queue.end())
+		return;
+
+	// cfile isn't thread safe and only has a few file handles, so the file is read into memory here and only the
+	// decoding, which is what takes time, is left to the worker. Files which can't be found are left to snd_load() so
+	// that it reports them as usual.
+	auto queued = readSoundFile(entry->filename, use_ds3d);
+	if (queued == nullptr)
+		return;
+
+	auto snd = queued.get();
+	threading::submit_job([snd]() { decodeSound(snd); }, &snd->done);
+
+	queue.emplace(entry->filename, std::move(queued));
+}
+
+void snd_discard_queued_loads()
+{
+	for (auto& queue : Queued_sounds) {
+		for (auto& queued : queue) {
+			threading::wait_for(queued.second->done);
+		}
+		queue.clear();
+	}
+}
+
 // ---------------------------------------------------------------------------------------
 // snd_load() 
 //
@@ -337,6 +683,7 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 	sound_info* si;
 	loaded_sound* snd;
 	size_t n;
+	bool use_ds3d = flags && (*flags & GAME_SND_USE_DS3D);
 
 	if (!ds_initialized)
 		return sound_load_id::invalid();
@@ -350,24 +697,20 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 		return sound_load_id::invalid();
 	}
 
+	auto existing = snd_find_loaded(entry->filename, use_ds3d);
+	if (existing >= 0) {
+		// Check we need to populate the signature here, as modders may desire to use 
+		// a sound file more than once in their tables.
+		if (entry->id_sig == -1) {
+			entry->id_sig = Sounds[existing].sig;
+		}
+
+		return sound_load_id(existing);
+	}
+
 	for (n = 0; n < Sounds.size(); n++) {
 		if ( !(Sounds[n].flags & SND_F_USED) ) {
 			break;
-		} else if ( !stricmp( Sounds[n].filename, entry->filename) ) {
-			// extra check: make sure the sound is actually loaded in a compatible way (2D vs. 3D)
-			//
-			// NOTE: this will allow a duplicate 3D entry if 2D stereo entry exists,
-			//       but will not load a duplicate 2D entry to get stereo if 3D
-			//       version already loaded
-			if ( (Sounds[n].info.n_channels == 1) || !(flags && *flags & GAME_SND_USE_DS3D) ) {
-				// Check we need to populate the signature here, as modders may desire to use 
-				// a sound file more than once in their tables.
-				if (entry->id_sig == -1) {
-					entry->id_sig = Sounds[n].sig;
-				}
-
-				return sound_load_id(static_cast<int>(n));
-			}
 		}
 	}
 
@@ -387,28 +730,55 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 
 	nprintf(("Sound", "SOUND ==> Loading '%s'\n", entry->filename));
 
-	std::unique_ptr<sound::IAudioFile> audio_file = openAudioFile(entry->filename);
+	// Use the data which has been decoded in the background if the sound has been queued, otherwise decode it now
+	std::unique_ptr<decoded_sound> decoded;
+	auto& queue = Queued_sounds[use_ds3d ? 1 : 0];
+	auto queued_iter = queue.find(entry->filename);
 
-	if (audio_file == nullptr) {
+	if (queued_iter != queue.end()) {
+		decoded = std::move(queued_iter->second);
+		queue.erase(queued_iter);
+
+		threading::wait_for(decoded->done);
+	} else {
+		decoded = readSoundFile(entry->filename, use_ds3d);
+
+		if (decoded != nullptr) {
+			decodeSound(decoded.get());
+		}
+	}
+
+	// If the sound couldn't be decoded from memory, it's opened again from the file so that the error is reported
+	// properly
+	if (decoded == nullptr || !decoded->valid) {
+		decoded.reset(new decoded_sound());
+
+		auto audio_file = openAudioFile(entry->filename);
+
+		if (audio_file != nullptr) {
+			decoded->resampled = resampleAudioFile(audio_file.get(), use_ds3d);
+			decoded->props = audio_file->getFileProperties();
+			ds_read_pcm(audio_file.get(), decoded->data);
+			decoded->pcm = decoded->data.data();
+			decoded->pcm_size = decoded->data.size();
+			decoded->valid = true;
+		}
+	}
+
+	if (!decoded->valid) {
 		if (flags)
 			*flags |= GAME_SND_NOT_VALID;
 		return sound_load_id::invalid();
 	}
 
-	auto fileProps = audio_file->getFileProperties();
+	const auto& fileProps = decoded->props;
 
 	type = 0;
-	if (flags && *flags & GAME_SND_USE_DS3D) {
+	if (use_ds3d) {
 		type |= DS_3D;
 
-		if (fileProps.num_channels > 1) {
-			// We need to resample the audio down to one channel
-			sound::ResampleProperties resample;
-			resample.num_channels = 1;
-
-			audio_file->setResamplingProperties(resample);
-			fileProps = audio_file->getFileProperties(); // Refresh properties so that we have accurate information
-
+		// The audio has been resampled down to one channel
+		if (decoded->resampled) {
 #ifndef NDEBUG
 			// Retail has a few sounds that triggers this warning so we need to ignore those
 			const char* warning_ignore_list[] = {
@@ -455,7 +825,7 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 
 	snd->uncompressed_size = si->size;
 
-	auto rc = ds_load_buffer(&snd->sid, type, audio_file.get());
+	auto rc = ds_load_buffer(&snd->sid, type, fileProps, decoded->pcm, decoded->pcm_size);
 	if (rc == -1) {
 		nprintf(("Sound", "SOUND ==> Failed to load '%s'\n", entry->filename));
 		if (flags)
@@ -468,6 +838,7 @@ sound_load_id snd_load(game_snd_entry* entry, int *flags, int /*allow_hardware_l
 
 	strcpy_s( snd->filename, entry->filename );
 	snd->flags = SND_F_USED;
+	snd_index_add(n);
 
 	snd->sig = snd_next_sig++;
 	if (snd_next_sig < 0 ) snd_next_sig = 1;
@@ -500,6 +871,10 @@ int snd_unload(sound_load_id n)
 
 	auto& snd = Sounds[n.value()];
 
+	if (snd.flags & SND_F_USED) {
+		snd_index_remove(n.value());
+	}
+
 	ds_unload_buffer(snd.sid);
 
 	if (snd.sid != -1) {
@@ -539,6 +914,7 @@ void snd_close(void)
 {
 	snd_stop_all();
 	if (!ds_initialized) return;
+	snd_discard_queued_loads();
 	snd_unload_all();		// free the sound data stored in DirectSound secondary buffers
 	dscap_close();	// Close DirectSoundCapture
 	ds_close();		// Close DirectSound off
@@ -134,6 +134,13 @@ void snd_set_voice_volume(float volume);
 //int	snd_load( char *filename, int hardware=0, int three_d=0, int *sig=NULL );
 sound_load_id snd_load(game_snd_entry* entry, int* flags, int allow_hardware_load = 0);
 
+// Starts reading the PCM data of a sound on a worker thread, so that a later snd_load() of the same
+// file with the same flags only has to upload it. Does nothing if there are no worker threads.
+void snd_queue_load(const game_snd_entry* entry, int flags);
+
+// Waits for the sounds queued with snd_queue_load() which haven't been loaded yet and throws them away
+void snd_discard_queued_loads();
+
 int snd_unload(sound_load_id sndnum);
 void	snd_unload_all();
 
@@ -775,6 +775,8 @@ add_file_folder("Math"
 	math/floating.h
 	math/fvi.cpp
 	math/fvi.h
+	math/fvi_simd.cpp
+	math/fvi_simd.h
 	math/ik_solver.cpp
 	math/ik_solver.h
 	math/spline.cpp
@@ -1024,6 +1026,8 @@ add_file_folder("Object"
 	object/object.h
 	object/objectdock.cpp
 	object/objectdock.h
+	object/objectgrid.cpp
+	object/objectgrid.h
 	object/objectshield.cpp
 	object/objectshield.h
 	object/objectsnd.cpp
@@ -1108,6 +1112,8 @@ add_file_folder("Parse\\\\SEXP"
 	parse/sexp/LuaAISEXP.h
 	parse/sexp/sexp_lookup.cpp
 	parse/sexp/sexp_lookup.h
+	parse/sexp/sexp_program.cpp
+	parse/sexp/sexp_program.h
 	parse/sexp/SEXPParameterExtractor.cpp
 	parse/sexp/SEXPParameterExtractor.h
 )
@@ -1122,6 +1128,8 @@ add_file_folder("Particle"
 	particle/ParticleManager.cpp
 	particle/ParticleManager.h
 	particle/ParticleParse.cpp
+	particle/ParticlePool.cpp
+	particle/ParticlePool.h
 	particle/ParticleSource.cpp
 	particle/ParticleSource.h
 	particle/ParticleVolume.h
@@ -1662,6 +1670,8 @@ add_file_folder("Tracing"
 	tracing/categories.h
 	tracing/FrameProfiler.h
 	tracing/FrameProfiler.cpp
+	tracing/FrameTelemetry.h
+	tracing/FrameTelemetry.cpp
 	tracing/MainFrameTimer.h
 	tracing/MainFrameTimer.cpp
 	tracing/Monitor.h
@@ -1702,6 +1712,7 @@ add_file_folder("Utils"
 	utils/encoding.h
 	utils/event.h
 	utils/finally.h
+	utils/flat_hash_map.h
 	utils/HeapAllocator.cpp
 	utils/HeapAllocator.h
 	utils/id.h
@@ -0,0 +1,194 @@
+
+#include "tracing/FrameTelemetry.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+using namespace tracing;
+
+// Wall-clock time between two snapshots, in nanoseconds like the event timestamps (see timer_get_nanoseconds())
+const std::uint64_t SNAPSHOT_INTERVAL = 10ull * 1000 * 1000 * 1000;
+
+const char* const FRAME_SCOPE_NAME = "Frame";
+
+int highest_bit(std::uint64_t value) {
+	int bit = 0;
+	while (value >>= 1) {
+		++bit;
+	}
+	return bit;
+}
+
+// Category names are plain identifiers, but this keeps the output valid if one ever contains a quote
+void write_json_string(std::ofstream& out, const char* str) {
+	out << '"';
+	for (; *str != '\0'; ++str) {
+		if (*str == '"' || *str == '\\') {
+			out << '\\';
+		}
+		out << *str;
+	}
+	out << '"';
+}
+
+void write_csv_row(std::ofstream& out, double time, const char* name, const LatencyHistogram& histogram) {
+	out << time << ",\"" << name << "\"," << histogram.count() << "," << histogram.percentile(0.5) << ","
+		<< histogram.percentile(0.95) << "," << histogram.percentile(0.99) << "," << histogram.max() << "\n";
+}
+
+void write_json_scope(std::ofstream& out, const char* name, const LatencyHistogram& histogram) {
+	out << "{\"name\":";
+	write_json_string(out, name);
+	out << ",\"count\":" << histogram.count() << ",\"p50\":" << histogram.percentile(0.5)
+		<< ",\"p95\":" << histogram.percentile(0.95) << ",\"p99\":" << histogram.percentile(0.99)
+		<< ",\"max\":" << histogram.max() << "}";
+}
+}
+
+namespace tracing {
+
+LatencyHistogram::LatencyHistogram() : _buckets(BUCKET_COUNT, 0) {
+}
+
+size_t LatencyHistogram::bucketIndex(std::uint64_t value) {
+	if (value < 2 * SUB_BUCKET_COUNT) {
+		return static_cast<size_t>(value);
+	}
+
+	// Keep the highest SUB_BUCKET_BITS + 1 bits of the value, the rest determines the width of the bucket
+	auto shift = highest_bit(value) - SUB_BUCKET_BITS;
+	return static_cast<size_t>((shift + 1) * SUB_BUCKET_COUNT + ((value >> shift) - SUB_BUCKET_COUNT));
+}
+
+std::uint64_t LatencyHistogram::bucketValue(size_t index) {
+	if (index < 2 * SUB_BUCKET_COUNT) {
+		return index;
+	}
+
+	auto shift = index / SUB_BUCKET_COUNT - 1;
+	auto sub_bucket = index % SUB_BUCKET_COUNT + SUB_BUCKET_COUNT;
+	return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::uint64_t value) {
+	value = std::min(value, MAX_VALUE);
+
+	++_buckets[bucketIndex(value)];
+	++_count;
+	_max = std::max(_max, value);
+}
+
+void LatencyHistogram::reset() {
+	if (_count == 0) {
+		return;
+	}
+
+	std::fill(_buckets.begin(), _buckets.end(), 0);
+	_count = 0;
+	_max = 0;
+}
+
+std::uint64_t LatencyHistogram::percentile(double fraction) const {
+	if (_count == 0) {
+		return 0;
+	}
+
+	auto target = static_cast<std::uint64_t>(std::ceil(fraction * static_cast<double>(_count)));
+	target = std::max(target, static_cast<std::uint64_t>(1));
+
+	std::uint64_t seen = 0;
+	for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+		seen += _buckets[i];
+		if (seen >= target) {
+			// The bucket may extend past the largest value that was actually recorded
+			return std::min(bucketValue(i), _max);
+		}
+	}
+
+	return _max;
+}
+
+FrameTelemetry::FrameTelemetry() : _csv("telemetry.csv"), _json("telemetry.jsonl"), _next_snapshot(SNAPSHOT_INTERVAL) {
+	_csv << std::fixed << std::setprecision(3);
+	_csv << "time_s,scope,count,p50_us,p95_us,p99_us,max_us\n";
+
+	_json << std::fixed << std::setprecision(3);
+}
+
+FrameTelemetry::~FrameTelemetry() {
+	if (_frames.count() > 0) {
+		writeSnapshot(_frame_begin);
+	}
+
+	_csv.close();
+	_json.close();
+}
+
+void FrameTelemetry::processEvent(const trace_event* event) {
+	if (event->pid == GPU_PID) {
+		// GPU timings arrive with a delay of a few frames, so they can't be attributed to the right snapshot
+		return;
+	}
+
+	if (event->type == EventType::Complete) {
+		auto iter = _scope_indices.find(event->category);
+		size_t index;
+		if (iter == _scope_indices.end()) {
+			index = _scopes.size();
+			_scopes.push_back(scope_histogram{event->category, LatencyHistogram()});
+			_scope_indices.emplace(event->category, index);
+		} else {
+			index = iter->second;
+		}
+
+		_scopes[index].histogram.record(event->duration / 1000);
+		return;
+	}
+
+	// The same events MainFrameTimer uses, they span from one frame to the next including the buffer swap
+	if (event->scope != &MainFrameScope || event->category != &MainFrame) {
+		return;
+	}
+
+	if (event->type == EventType::AsyncBegin) {
+		_frame_begin = event->timestamp;
+		_frame_started = true;
+	} else if (event->type == EventType::AsyncEnd && _frame_started) {
+		_frames.record((event->timestamp - _frame_begin) / 1000);
+		_frame_started = false;
+
+		if (event->timestamp >= _next_snapshot) {
+			writeSnapshot(event->timestamp);
+			_next_snapshot = event->timestamp + SNAPSHOT_INTERVAL;
+		}
+	}
+}
+
+void FrameTelemetry::writeSnapshot(std::uint64_t time) {
+	auto seconds = static_cast<double>(time) / 1e9;
+
+	write_csv_row(_csv, seconds, FRAME_SCOPE_NAME, _frames);
+	_json << "{\"time\":" << seconds << ",\"scopes\":[";
+	write_json_scope(_json, FRAME_SCOPE_NAME, _frames);
+	_frames.reset();
+
+	for (auto& scope : _scopes) {
+		if (scope.histogram.count() == 0) {
+			continue;
+		}
+
+		write_csv_row(_csv, seconds, scope.category->getName(), scope.histogram);
+		_json << ",";
+		write_json_scope(_json, scope.category->getName(), scope.histogram);
+		scope.histogram.reset();
+	}
+
+	_json << "]}\n";
+
+	_csv.flush();
+	_json.flush();
+}
+
+}
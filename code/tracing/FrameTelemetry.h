@@ -0,0 +1,100 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+#include "tracing/tracing.h"
+
+#include "tracing/ThreadedEventProcessor.h"
+
+#include <fstream>
+
+/** @file
+ *  @ingroup tracing
+ */
+
+namespace tracing {
+
+/**
+ * @brief A histogram of durations with a bounded relative error
+ *
+ * Values are sorted into buckets whose width grows with the value, like in an HDR histogram. Every power of two is
+ * split into 32 linear buckets, so a value is known to within about 3% no matter how large it is. This allows to get
+ * percentiles without keeping every sample around, and recording a value is just an increment.
+ */
+class LatencyHistogram {
+ public:
+	static constexpr int SUB_BUCKET_BITS = 5;
+	static constexpr std::uint64_t SUB_BUCKET_COUNT = 1 << SUB_BUCKET_BITS;
+
+	//! Values with more bits than this are recorded as the largest value that fits
+	static constexpr int MAX_VALUE_BITS = 40;
+	static constexpr std::uint64_t MAX_VALUE = (std::uint64_t(1) << MAX_VALUE_BITS) - 1;
+
+	static constexpr size_t BUCKET_COUNT = (MAX_VALUE_BITS - SUB_BUCKET_BITS + 1) * SUB_BUCKET_COUNT;
+
+ private:
+	SCP_vector<std::uint32_t> _buckets;
+	std::uint64_t _count = 0;
+	std::uint64_t _max = 0;
+
+ public:
+	LatencyHistogram();
+
+	static size_t bucketIndex(std::uint64_t value);
+
+	//! The largest value which ends up in the given bucket
+	static std::uint64_t bucketValue(size_t index);
+
+	void record(std::uint64_t value);
+
+	void reset();
+
+	std::uint64_t count() const { return _count; }
+
+	//! The exact maximum of the recorded values
+	std::uint64_t max() const { return _max; }
+
+	/**
+	 * @brief Gets the value below which the given fraction of the recorded values lies
+	 * @param fraction The fraction, e.g. 0.99 for the 99th percentile
+	 * @return The percentile, or 0 if nothing has been recorded
+	 */
+	std::uint64_t percentile(double fraction) const;
+};
+
+/**
+ * @brief Records the frame time and the duration of every traced scope in histograms
+ *
+ * Every 10 seconds of wall-clock time, the 50th, 95th and 99th percentile and the maximum of each histogram are written
+ * to telemetry.csv and, one snapshot per line, to telemetry.jsonl. The interval follows the event timestamps rather
+ * than mission time, so snapshots keep coming while the game is paused or in menus. The histograms are reset after each
+ * snapshot, so that a stutter shows up in the snapshot it happened in instead of being averaged away.
+ */
+class FrameTelemetry {
+	struct scope_histogram {
+		const Category* category;
+		LatencyHistogram histogram;
+	};
+
+	std::ofstream _csv;
+	std::ofstream _json;
+
+	LatencyHistogram _frames;
+	std::uint64_t _frame_begin = 0;
+	bool _frame_started = false;
+
+	SCP_vector<scope_histogram> _scopes;
+	SCP_unordered_map<const Category*, size_t> _scope_indices;
+
+	std::uint64_t _next_snapshot;
+
+	void writeSnapshot(std::uint64_t time);
+
+ public:
+	FrameTelemetry();
+	~FrameTelemetry();
+
+	void processEvent(const trace_event* event);
+};
+
+typedef ThreadedEventProcessor<FrameTelemetry> ThreadedFrameTelemetry;
+}
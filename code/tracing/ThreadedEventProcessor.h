@@ -3,8 +3,10 @@
 #include "globalincs/pstypes.h"
 #include "tracing/tracing.h"
 
-#include "utils/boost/syncboundedqueue.h"
-
+#include <atomic>
+#include <chrono>
+#include <cinttypes>
+#include <mutex>
 #include <thread>
 
 
@@ -26,51 +28,143 @@ namespace tracing {
  *
  * This function will be called in a background-thread whenever a new event arrives.
  *
+ * Every thread which submits events gets its own ring buffer, which the background thread drains regularly. Submitting
+ * an event never locks or waits. If the background thread falls behind and the buffer of a thread is full, the event
+ * is dropped and counted instead, so that tracing doesn't stall the code that is being measured.
+ *
  * @tparam Processor Your processor implementation
- * @tparam QUEUE_SIZE The maximum size of the internal event buffer
+ * @tparam BUFFER_SIZE The number of events which can be buffered per thread, must be a power of two
  */
-template<class Processor, size_t QUEUE_SIZE = 200>
+template<class Processor, size_t BUFFER_SIZE = 4096>
 class ThreadedEventProcessor {
-	sync_bounded_queue<trace_event> _event_queue;
+	static_assert((BUFFER_SIZE & (BUFFER_SIZE - 1)) == 0, "The buffer size must be a power of two!");
 
-	std::thread _worker_thread;
+	// Only the thread this belongs to writes to it and only the background thread reads from it, so no locks are needed
+	struct ThreadBuffer {
+		trace_event events[BUFFER_SIZE];
+
+		alignas(64) std::atomic<size_t> head{0}; // the next event to be processed
+		alignas(64) std::atomic<size_t> tail{0}; // where the next event will be written
+		std::atomic<std::uint64_t> dropped{0};
+	};
+
+	struct ThreadCache {
+		std::uint64_t owner = 0;
+		ThreadBuffer* buffer = nullptr;
+	};
+
+	// Identifies the processor a thread's cached buffer belongs to. Addresses may be reused, ids aren't.
+	inline static std::atomic<std::uint64_t> _next_id{1};
+	inline static thread_local ThreadCache _thread_cache;
+
+	std::uint64_t _id;
+
+	// Only used when a thread submits its first event, and by the background thread to find the buffers
+	std::mutex _buffers_mutex;
+	SCP_vector<std::unique_ptr<ThreadBuffer>> _buffers;
+
+	std::atomic_bool _running{true};
 
 	Processor _processor;
 
+	// Declared last so that everything it uses is initialized before it starts
+	std::thread _worker_thread;
+
+	ThreadBuffer* getThreadBuffer() {
+		if (_thread_cache.owner != _id) {
+			auto buffer = std::make_unique<ThreadBuffer>();
+
+			std::lock_guard<std::mutex> guard(_buffers_mutex);
+			_thread_cache.owner = _id;
+			_thread_cache.buffer = buffer.get();
+			_buffers.push_back(std::move(buffer));
+		}
+
+		return _thread_cache.buffer;
+	}
+
+	size_t drainBuffer(ThreadBuffer& buffer) {
+		const auto head = buffer.head.load(std::memory_order_relaxed);
+		const auto tail = buffer.tail.load(std::memory_order_acquire);
+
+		for (auto i = head; i != tail; ++i) {
+			_processor.processEvent(&buffer.events[i & (BUFFER_SIZE - 1)]);
+
+			// Hand the slot back right away so that the thread can keep going while the rest is processed
+			buffer.head.store(i + 1, std::memory_order_release);
+		}
+
+		return tail - head;
+	}
+
 	void workerThread() {
-		while (!_event_queue.closed()) {
-			try {
-				trace_event evt;
-				auto status = _event_queue.wait_pull_front(evt);
+		SCP_vector<ThreadBuffer*> buffers;
+
+		for (;;) {
+			// Read before draining so that everything submitted before the shutdown still gets processed
+			bool running = _running.load(std::memory_order_acquire);
 
-				if (status != success) {
-					break;
+			{
+				std::lock_guard<std::mutex> guard(_buffers_mutex);
+				buffers.clear();
+				for (auto& buffer : _buffers) {
+					buffers.push_back(buffer.get());
 				}
+			}
 
-				_processor.processEvent(&evt);
+			size_t processed = 0;
+			for (auto buffer : buffers) {
+				processed += drainBuffer(*buffer);
 			}
-			catch (const sync_queue_is_closed&) {
-				// We are done here
+
+			if (!running) {
 				break;
 			}
+
+			if (processed == 0) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
 		}
 	}
  public:
 	template<typename... Params>
 	explicit ThreadedEventProcessor(Params&& ... params)
-		: _event_queue(QUEUE_SIZE), _worker_thread(&ThreadedEventProcessor<Processor>::workerThread, this),
-		  _processor(std::forward<Params>(params)...) {}
+		: _id(_next_id++), _processor(std::forward<Params>(params)...),
+		  _worker_thread(&ThreadedEventProcessor::workerThread, this) {}
 	~ThreadedEventProcessor() {
-		_event_queue.close();
+		_running.store(false, std::memory_order_release);
 		_worker_thread.join();
+
+		auto dropped = droppedEvents();
+		if (dropped > 0) {
+			mprintf(("Tracing: %" PRIu64 " events were dropped because they could not be processed fast enough.\n", dropped));
+		}
 	}
 
 	void processEvent(const trace_event* event) {
-		try {
-			_event_queue.wait_push_back(*event);
-		} catch (const sync_queue_is_closed&) {
-			mprintf(("Stream queue was closed in processEvent! This should not be possible...\n"));
+		auto buffer = getThreadBuffer();
+
+		const auto tail = buffer->tail.load(std::memory_order_relaxed);
+		if (tail - buffer->head.load(std::memory_order_acquire) == BUFFER_SIZE) {
+			buffer->dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		buffer->events[tail & (BUFFER_SIZE - 1)] = *event;
+		buffer->tail.store(tail + 1, std::memory_order_release);
+	}
+
+	/**
+	 * @brief Gets the number of events which had to be dropped because the buffer of their thread was full
+	 */
+	std::uint64_t droppedEvents() {
+		std::lock_guard<std::mutex> guard(_buffers_mutex);
+
+		std::uint64_t dropped = 0;
+		for (auto& buffer : _buffers) {
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
 		}
+		return dropped;
 	}
 };
 
@@ -79,11 +79,14 @@ Category NonrepeatingEvents("Nonrepeating events", false);
 Category ParticlesRenderAll("Render particles", true);
 Category ParticlesMoveAll("Move particles", false);
 
+Category VolumetricsGenerate("Generate volumetric nebula", false);
+
 Category EnvironmentMapping("Environment Mapping", true);
 Category BuildShadowMap("Build Shadow Map", true);
 Category RenderScene("Render scene", true);
 Category RenderTrails("Render trails", true);
 Category MoveObjects("Move Objects", false);
+Category AIDecideTargets("AI decide targets", false);
 Category ProcessParticleEffects("Process particle effects", false);
 Category TrailsMoveAll("Trails move all", false);
 Category Simulation("Simulation", false);
@@ -138,6 +141,9 @@ Category LoadSound("Load Sound", false);
 Category LevelPageIn("Level page in", false);
 Category PageInStop("Finish page in", false);
 Category PageInSingleBitmap("Page in single bitmap", false);
+Category PageInDecode("Decode bitmap", false);
+Category PageInWaitForDecode("Wait for bitmap decode", false);
+Category PageInUpload("Upload bitmap", false);
 Category ShipPageIn("Ship page in", false);
 Category WeaponPageIn("Weapon page in", false);
 
@@ -92,11 +92,14 @@ extern Category NonrepeatingEvents;
 extern Category ParticlesRenderAll;
 extern Category ParticlesMoveAll;
 
+extern Category VolumetricsGenerate;
+
 extern Category EnvironmentMapping;
 extern Category BuildShadowMap;
 extern Category RenderScene;
 extern Category RenderTrails;
 extern Category MoveObjects;
+extern Category AIDecideTargets;
 extern Category ProcessParticleEffects;
 extern Category TrailsMoveAll;
 extern Category Simulation;
@@ -152,6 +155,9 @@ extern Category LoadSound;
 extern Category LevelPageIn;
 extern Category PageInStop;
 extern Category PageInSingleBitmap;
+extern Category PageInDecode;
+extern Category PageInWaitForDecode;
+extern Category PageInUpload;
 extern Category ShipPageIn;
 extern Category WeaponPageIn;
 
@@ -7,7 +7,9 @@
 #include "TraceEventWriter.h"
 #include "MainFrameTimer.h"
 #include "FrameProfiler.h"
+#include "FrameTelemetry.h"
 
+#include <atomic>
 #include <cinttypes>
 #include <fstream>
 #include <future>
@@ -18,23 +20,29 @@
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
 
-static int64_t get_tid() {
+static int64_t query_tid() {
     return (int64_t) GetCurrentThreadId();
 }
 #elif __LINUX__
 #include <sys/syscall.h>
-static int64_t get_tid() {
+static int64_t query_tid() {
 	return (int64_t) syscall(SYS_gettid);
 }
 #else
 #include <pthread.h>
 
-static int64_t get_tid() {
+static int64_t query_tid() {
 // This is not a reliable way of getting the tid but it's better than nothing
     return (int64_t) pthread_self();
 }
 #endif
 
+// Every event needs this, and on Linux getting it is a system call
+static int64_t get_tid() {
+	static thread_local int64_t tid = query_tid();
+	return tid;
+}
+
 // A function for getting the id of the current process
 #ifdef WIN32
 static int64_t get_pid() {
@@ -55,6 +63,7 @@ using namespace tracing;
 std::unique_ptr<ThreadedTraceEventWriter> traceEventWriter;
 std::unique_ptr<ThreadedMainFrameTimer> mainFrameTimer;
 std::unique_ptr<FrameProfiler> frameProfiler;
+std::unique_ptr<ThreadedFrameTelemetry> frameTelemetry;
 
 SCP_vector<int> query_objects;
 // The GPU timestamp queries use an internal free list to reduce the number of graphics API calls
@@ -106,7 +115,8 @@ int gpu_start_query = -1;
 std::uint64_t gpu_start_time = 0;
 std::uint64_t cpu_start_time = 0;
 
-std::uint64_t current_id = 0;
+// events may be started on the worker threads of the job system as well
+std::atomic<std::uint64_t> current_id{0};
 
 void submit_event(trace_event* evt) {
 	if (evt->pid == GPU_PID) {
@@ -127,6 +137,10 @@ void submit_event(trace_event* evt) {
 	if (frameProfiler) {
 		frameProfiler->processEvent(evt);
 	}
+
+	if (frameTelemetry) {
+		frameTelemetry->processEvent(evt);
+	}
 }
 
 void process_gpu_events() {
@@ -229,8 +243,14 @@ void init() {
 		frameProfiler.reset(new FrameProfiler());
 		do_trace_events = true;
 	}
+	if (Cmdline_frame_telemetry) {
+		frameTelemetry.reset(new ThreadedFrameTelemetry());
+		do_trace_events = true;
+		do_async_events = true;
+	}
 
-	do_gpu_queries = gr_is_capable(gr_capability::CAPABILITY_TIMESTAMP_QUERY);
+	// Telemetry is meant to be left on, so it shouldn't pay for GPU queries it doesn't use
+	do_gpu_queries = (traceEventWriter || frameProfiler) && gr_is_capable(gr_capability::CAPABILITY_TIMESTAMP_QUERY);
 
 	if (do_gpu_queries) {
 		gpu_start_query = get_gpu_timestamp_query();
@@ -275,6 +295,7 @@ void shutdown() {
 
 	mainFrameTimer = nullptr;
 	traceEventWriter = nullptr;
+	frameTelemetry = nullptr;
 
 	initialized = false;
 }
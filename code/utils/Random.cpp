@@ -40,6 +40,8 @@ private:
 };
 
 RandomImpl<std::mt19937> SCP_rng;
+
+thread_local Random::thread_generator_type* Thread_rng = nullptr;
 } // namespace
 
 Random::Random() = default;
@@ -52,6 +54,10 @@ void Random::seed(unsigned int val)
 
 int Random::next()
 {
+	if (Thread_rng != nullptr) {
+		return static_cast<int>((*Thread_rng)() & Random::MAX_VALUE);
+	}
+
 	return SCP_rng.next();
 }
 
@@ -59,7 +65,7 @@ int Random::next(int modulus)
 {
 	Assert(modulus > 0);
 
-	return SCP_rng.next() % modulus;
+	return next() % modulus;
 }
 
 int Random::next(int low, int high)
@@ -67,17 +73,32 @@ int Random::next(int low, int high)
 	const int range = high - low + 1;
 	Assert(range > 0);
 
-	return low + (SCP_rng.next() % range);
+	return low + (next() % range);
 }
 
 bool Random::flip_coin()
 {
 	// [0, HALF_MAX_VALUE] and [HALF_MAX_VALUE+1,MAX_VALUE] are the same size
-	return SCP_rng.next() <= Random::HALF_MAX_VALUE;
+	return next() <= Random::HALF_MAX_VALUE;
 }
 
 void Random::advance(unsigned long long distance)
 {
 	SCP_rng.advance(distance);
 }
+
+Random::ThreadSeed::ThreadSeed(unsigned int seed) : m_rng(seed), m_previous(Thread_rng)
+{
+	Thread_rng = &m_rng;
+}
+
+Random::ThreadSeed::~ThreadSeed()
+{
+	Thread_rng = m_previous;
+}
+
+Random::thread_generator_type* Random::thread_generator()
+{
+	return Thread_rng;
+}
 } // namespace util
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <random>
+
 namespace util {
 
 class Random {
@@ -25,6 +27,27 @@ public:
 
 	// jump ahead in the RNG sequence
 	static void advance(unsigned long long distance);
+
+	using thread_generator_type = std::mt19937;
+
+	// While an instance of this exists, the thread which created it draws all its random numbers from a separate
+	// generator with the given seed, including the ones of RandomRange. Work which is spread across threads uses this
+	// to get the same numbers no matter which thread ends up doing it.
+	class ThreadSeed {
+	public:
+		explicit ThreadSeed(unsigned int seed);
+		~ThreadSeed();
+
+		ThreadSeed(const ThreadSeed&) = delete;
+		ThreadSeed& operator=(const ThreadSeed&) = delete;
+
+	private:
+		thread_generator_type m_rng;
+		thread_generator_type* m_previous;
+	};
+
+	// the generator of the innermost ThreadSeed of the calling thread, or nullptr if there is none
+	static thread_generator_type* thread_generator();
 private:
 	Random();
 };
@@ -4,6 +4,7 @@
 #include "parse/parselo.h"
 #include "math/curve.h"
 #include "globalincs/type_traits.h"
+#include "utils/Random.h"
 
 #include <variant>
 
@@ -73,6 +74,9 @@ class RandomRange {
 	mutable GeneratorType m_generator;
 	mutable DistributionType m_distribution;
 
+	// Set by seed(), the values are then always drawn from m_generator so that they can be reproduced
+	mutable bool m_seeded = false;
+
 	bool m_constant;
 	ValueType m_minValue;
 	ValueType m_maxValue;
@@ -114,9 +118,38 @@ class RandomRange {
 			return m_minValue;
 		}
 
+		if (!m_seeded) {
+			if (auto generator = Random::thread_generator()) {
+				// The range may be shared with other threads, so neither its generator nor its distribution may be touched
+				auto distribution = m_distribution;
+				return static_cast<ValueType>(distribution(*generator));
+			}
+		}
+
 		return m_distribution(m_generator);
 	}
 
+	/**
+	 * @brief Determines the random number a freshly seeded copy of this range would return first
+	 *
+	 * Same result as seed(new_seed) followed by next(), but without changing this range, so it may be used on ranges
+	 * shared between threads.
+	 *
+	 * @param new_seed The seed for the generator
+	 * @return The random number
+	 */
+	ValueType next(typename GeneratorType::result_type new_seed) const
+	{
+		if (m_constant) {
+			return m_minValue;
+		}
+
+		GeneratorType generator(new_seed);
+		auto distribution = m_distribution;
+		distribution.reset();
+		return static_cast<ValueType>(distribution(generator));
+	}
+
 	/**
 	 * @brief Gets the minimum value that may be returned by this random range
 	 *
@@ -160,6 +193,8 @@ class RandomRange {
 			return;
 
 		m_generator.seed(new_seed);
+		m_distribution.reset();
+		m_seeded = true;
 	}
 };
 
@@ -571,6 +606,9 @@ class ParsedRandomRange {
 	inline result_type next() const {
 		return static_cast<result_type>(std::visit([](auto& range) {return range.next();}, m_random_range));
 	}
+	inline result_type next(unsigned int new_seed) const {
+		return static_cast<result_type>(std::visit([new_seed](auto& range) {return range.next(new_seed);}, m_random_range));
+	}
 	inline result_type min() const {
 		return static_cast<result_type>(std::visit([](auto& range) {return range.min();}, m_random_range));
 	}
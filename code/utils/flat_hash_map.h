@@ -0,0 +1,298 @@
+#pragma once
+
+#include "globalincs/pstypes.h"
+
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <utility>
+
+namespace util {
+
+/**
+ * @brief A hash map which stores its elements in one flat array
+ *
+ * Collisions are resolved with robin hood linear probing, and erased elements are removed by shifting the following
+ * elements back, so lookups never have to step over tombstones. This is meant for small, trivially copyable keys and
+ * values that get looked up a lot, like the collision pair cache.
+ *
+ * Pointers and iterators to elements are invalidated by every insertion and erasure.
+ *
+ * @tparam Key The key type, must be equality comparable and default constructible
+ * @tparam Value The mapped type, must be default constructible
+ * @tparam Hash The hash function. The result is scrambled again internally, so an identity hash is fine.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class flat_hash_map {
+  public:
+	using key_type = Key;
+	using mapped_type = Value;
+	using value_type = std::pair<Key, Value>;
+
+  private:
+	// Distances are stored as probe distance + 1, so that 0 can mean "empty"
+	using distance_type = uint8_t;
+	static constexpr distance_type MAX_DISTANCE = std::numeric_limits<distance_type>::max();
+	static constexpr size_t MIN_CAPACITY = 16;
+	static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+	SCP_vector<distance_type> _distances;
+	SCP_vector<value_type> _slots;
+	size_t _size = 0;
+	size_t _mask = 0;
+	int _shift = 64;
+	Hash _hash;
+
+	size_t home_slot(const Key& key) const
+	{
+		// Fibonacci hashing, so that keys with regular patterns in their low bits still spread out nicely
+		return static_cast<size_t>((static_cast<uint64_t>(_hash(key)) * 11400714819323198485ull) >> _shift);
+	}
+
+	size_t next_slot(size_t slot) const { return (slot + 1) & _mask; }
+
+	bool needs_grow(size_t new_size) const
+	{
+		// Keep the load factor below 7/8
+		return new_size * 8 > _slots.size() * 7;
+	}
+
+	size_t find_slot(const Key& key) const
+	{
+		if (_size == 0)
+			return npos;
+
+		size_t slot = home_slot(key);
+		for (distance_type distance = 1; _distances[slot] >= distance; ++distance) {
+			if (_distances[slot] == distance && _slots[slot].first == key)
+				return slot;
+
+			slot = next_slot(slot);
+		}
+
+		return npos;
+	}
+
+	void rehash(size_t capacity)
+	{
+		SCP_vector<distance_type> old_distances(capacity, 0);
+		SCP_vector<value_type> old_slots(capacity);
+		old_distances.swap(_distances);
+		old_slots.swap(_slots);
+
+		_size = 0;
+		_mask = capacity - 1;
+		_shift = 64;
+		for (size_t i = capacity; i > 1; i >>= 1)
+			--_shift;
+
+		for (size_t i = 0; i < old_slots.size(); ++i) {
+			if (old_distances[i] != 0)
+				insert_new(std::move(old_slots[i]));
+		}
+	}
+
+	void grow() { rehash(std::max(MIN_CAPACITY, _slots.size() * 2)); }
+
+	// Inserts an element which is known not to be in the map yet and returns the slot it ended up in
+	size_t insert_new(value_type&& element)
+	{
+		const Key key = element.first;
+		size_t slot = home_slot(key);
+		size_t result = npos;
+
+		for (distance_type distance = 1;; ++distance) {
+			if (distance == MAX_DISTANCE) {
+				// The probe sequence got too long, make room and put back whatever we were carrying around
+				grow();
+				insert_new(std::move(element));
+				return find_slot(key);
+			}
+
+			if (_distances[slot] == 0) {
+				_distances[slot] = distance;
+				_slots[slot] = std::move(element);
+				++_size;
+				return result == npos ? slot : result;
+			}
+
+			if (_distances[slot] < distance) {
+				// Take the spot of the element which is closer to its home slot and carry that one on instead
+				std::swap(distance, _distances[slot]);
+				std::swap(element, _slots[slot]);
+				if (result == npos)
+					result = slot;
+			}
+
+			slot = next_slot(slot);
+		}
+	}
+
+	void erase_slot(size_t slot)
+	{
+		// Shift back everything that isn't in its home slot, so no tombstone is needed
+		size_t next = next_slot(slot);
+		while (_distances[next] > 1) {
+			_slots[slot] = std::move(_slots[next]);
+			_distances[slot] = _distances[next] - 1;
+			slot = next;
+			next = next_slot(next);
+		}
+
+		_distances[slot] = 0;
+		_slots[slot] = value_type();
+		--_size;
+	}
+
+	template <typename MapType, typename ElementType>
+	class iterator_base {
+		MapType* _map;
+		size_t _slot;
+
+		void skip_empty()
+		{
+			while (_slot < _map->_slots.size() && _map->_distances[_slot] == 0)
+				++_slot;
+		}
+
+	  public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = ElementType;
+		using difference_type = std::ptrdiff_t;
+		using pointer = ElementType*;
+		using reference = ElementType&;
+
+		iterator_base(MapType* map, size_t slot) : _map(map), _slot(slot) { skip_empty(); }
+
+		reference operator*() const { return _map->_slots[_slot]; }
+		pointer operator->() const { return &_map->_slots[_slot]; }
+
+		iterator_base& operator++()
+		{
+			++_slot;
+			skip_empty();
+			return *this;
+		}
+
+		bool operator==(const iterator_base& other) const { return _slot == other._slot; }
+		bool operator!=(const iterator_base& other) const { return _slot != other._slot; }
+	};
+
+  public:
+	using iterator = iterator_base<flat_hash_map, value_type>;
+	using const_iterator = iterator_base<const flat_hash_map, const value_type>;
+
+	flat_hash_map() = default;
+
+	size_t size() const { return _size; }
+	bool empty() const { return _size == 0; }
+	size_t capacity() const { return _slots.size(); }
+
+	void reserve(size_t count)
+	{
+		size_t capacity = std::max(MIN_CAPACITY, _slots.size());
+		while (count * 8 > capacity * 7)
+			capacity *= 2;
+
+		if (capacity != _slots.size())
+			rehash(capacity);
+	}
+
+	/**
+	 * @brief Removes all elements, but keeps the allocated memory around
+	 */
+	void clear()
+	{
+		std::fill(_distances.begin(), _distances.end(), static_cast<distance_type>(0));
+		std::fill(_slots.begin(), _slots.end(), value_type());
+		_size = 0;
+	}
+
+	Value* find(const Key& key)
+	{
+		size_t slot = find_slot(key);
+		return slot == npos ? nullptr : &_slots[slot].second;
+	}
+
+	const Value* find(const Key& key) const
+	{
+		size_t slot = find_slot(key);
+		return slot == npos ? nullptr : &_slots[slot].second;
+	}
+
+	bool contains(const Key& key) const { return find_slot(key) != npos; }
+
+	/**
+	 * @brief Returns the value for the key, inserting a default constructed one if the key isn't in the map yet
+	 */
+	Value& operator[](const Key& key)
+	{
+		size_t slot = find_slot(key);
+		if (slot != npos)
+			return _slots[slot].second;
+
+		if (_slots.empty() || needs_grow(_size + 1))
+			grow();
+
+		return _slots[insert_new(value_type(key, Value()))].second;
+	}
+
+	/**
+	 * @brief Removes the key from the map
+	 * @return @c true if the key was in the map
+	 */
+	bool erase(const Key& key)
+	{
+		size_t slot = find_slot(key);
+		if (slot == npos)
+			return false;
+
+		erase_slot(slot);
+		return true;
+	}
+
+	/**
+	 * @brief Calls pred(key, value) once for every element and removes the ones it returns @c true for
+	 *
+	 * The predicate may modify the value of elements it keeps.
+	 *
+	 * @return The number of removed elements
+	 */
+	template <typename Predicate>
+	size_t erase_if(Predicate&& pred)
+	{
+		if (_size == 0)
+			return 0;
+
+		// Start at the beginning of a probe run, so erasing never shifts an element we have already seen into a slot we
+		// have yet to visit. Since the map is never full, there always is such a slot.
+		size_t start = 0;
+		while (_distances[start] > 1)
+			start = next_slot(start);
+
+		size_t erased = 0;
+		size_t visited = 0;
+		while (visited < _slots.size()) {
+			size_t slot = (start + visited) & _mask;
+
+			if (_distances[slot] != 0 && pred(_slots[slot].first, _slots[slot].second)) {
+				// The next element of the run has been moved into this slot, so look at it again
+				erase_slot(slot);
+				++erased;
+				continue;
+			}
+
+			++visited;
+		}
+
+		return erased;
+	}
+
+	iterator begin() { return iterator(this, 0); }
+	iterator end() { return iterator(this, _slots.size()); }
+	const_iterator begin() const { return const_iterator(this, 0); }
+	const_iterator end() const { return const_iterator(this, _slots.size()); }
+};
+
+} // namespace util
@@ -600,12 +600,11 @@ private:
 
 			uint32_t seed = inout_seeds[input][static_cast<std::underlying_type_t<output_enum>>(output)] ^ curve_entry.curve_idx;
 
-			curve_entry.scaling_factor.seed(seed ^ instance->seed_scaling_factor);
-			curve_entry.translation.seed(seed ^ instance->seed_translation);
-
 			//This will yield consistent seeds (and thus random values) for the same tuples of input_idx-output_idx-curve_idx-instance_seed.
 			//if any of these four changes, the resulting value should be random with regard to the previous value.
 			//Furthermore, this seed generation is not commutative, so input 0 and output 1 will result in a different seed to input 1 and output 0
+			//The curve entries are shared by every instance (and thread), so they are sampled without seeding them.
+			return {curve_entry.scaling_factor.next(seed ^ instance->seed_scaling_factor), curve_entry.translation.next(seed ^ instance->seed_translation)};
 		}
 
 		return {curve_entry.scaling_factor.next(), curve_entry.translation.next()};
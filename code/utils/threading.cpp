@@ -1,11 +1,11 @@
 #include "threading.h"
 
 #include "cmdline/cmdline.h"
-#include "object/objcollide.h"
 #include "globalincs/pstypes.h"
 
 #include <atomic>
 #include <condition_variable>
+#include <limits>
 #include <mutex>
 #include <thread>
 
@@ -16,31 +16,203 @@
 #endif
 
 namespace threading {
+	//A queued job. Owned by the job system from submission until it has finished running.
+	struct job {
+		job_function function;
+		job_counter* counter;
+	};
+
+	struct job_counter_access {
+		static void add_job(job_counter& counter) {
+			counter.m_outstanding.fetch_add(1, std::memory_order_relaxed);
+			counter.m_resolving.store(false);
+		}
+
+		static void finish_job(job_counter& counter);
+
+		//Returns false if the dependency has already been resolved, in which case the caller has to submit the job itself
+		static bool add_continuation(job_counter& dependency, job_function& function, job_counter* counter) {
+			std::scoped_lock lock {dependency.m_continuations_mutex};
+			if (dependency.done() || dependency.m_resolving.load())
+				return false;
+
+			dependency.m_continuations.emplace_back(std::move(function), counter);
+			return true;
+		}
+	};
+
+	//Fixed size lock-free work-stealing deque (Chase-Lev).
+	//Only the owning thread may push and pop at the bottom, every other thread steals from the top.
+	class job_deque {
+		static constexpr int64_t CAPACITY = 4096;
+		static constexpr int64_t MASK = CAPACITY - 1;
+		static_assert((CAPACITY & MASK) == 0, "Job deque capacity must be a power of two!");
+
+		alignas(64) std::atomic<int64_t> m_top{0};
+		alignas(64) std::atomic<int64_t> m_bottom{0};
+		std::unique_ptr<std::atomic<job*>[]> m_buffer;
+
+	public:
+		job_deque() : m_buffer(std::make_unique<std::atomic<job*>[]>(CAPACITY)) {}
+
+		//Returns false if the deque is full
+		bool push(job* item) {
+			int64_t bottom = m_bottom.load(std::memory_order_relaxed);
+			int64_t top = m_top.load(std::memory_order_acquire);
+			if (bottom - top >= CAPACITY)
+				return false;
+
+			m_buffer[bottom & MASK].store(item, std::memory_order_relaxed);
+			m_bottom.store(bottom + 1, std::memory_order_release);
+			return true;
+		}
+
+		job* pop() {
+			int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+			m_bottom.store(bottom, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t top = m_top.load(std::memory_order_relaxed);
+
+			if (top > bottom) {
+				//Empty
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			job* item = m_buffer[bottom & MASK].load(std::memory_order_relaxed);
+			if (top == bottom) {
+				//Last item, race against the thieves for it
+				if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					item = nullptr;
+				m_bottom.store(bottom + 1, std::memory_order_relaxed);
+			}
+			return item;
+		}
+
+		job* steal() {
+			int64_t top = m_top.load(std::memory_order_acquire);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+			if (top >= bottom)
+				return nullptr;
+
+			job* item = m_buffer[top & MASK].load(std::memory_order_relaxed);
+			if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+				return nullptr;
+			return item;
+		}
+	};
+
 	static size_t num_threads = 1;
-	static std::condition_variable wait_for_task;
-	static std::mutex wait_for_task_mutex;
-	static bool wait_for_task_condition;
-	static std::atomic<WorkerThreadTask> worker_task;
 
 	static SCP_vector<std::thread> worker_threads;
 
+	//One deque per worker, plus one for the main thread at the very end
+	static std::unique_ptr<job_deque[]> job_queues;
+	static size_t num_job_queues = 0;
+	static thread_local size_t local_queue_index = std::numeric_limits<size_t>::max();
+
+	static std::atomic<int> queued_jobs {0};
+	static std::atomic<int> sleeping_workers {0};
+	static std::atomic_bool exit_workers {false};
+	static std::mutex wait_for_job_mutex;
+	static std::condition_variable wait_for_job;
+
 	//Internal Functions
+	static void run_job(job* item) {
+		item->function();
+
+		if (item->counter != nullptr)
+			job_counter_access::finish_job(*item->counter);
+
+		delete item;
+	}
+
+	static bool has_local_queue() {
+		return local_queue_index < num_job_queues;
+	}
+
+	static job* find_job() {
+		if (num_job_queues == 0)
+			return nullptr;
+
+		job* item = nullptr;
+		size_t start = 0;
+
+		if (has_local_queue()) {
+			item = job_queues[local_queue_index].pop();
+			start = local_queue_index + 1;
+		}
+
+		for (size_t i = 0; item == nullptr && i < num_job_queues; i++) {
+			size_t victim = (start + i) % num_job_queues;
+			if (victim != local_queue_index)
+				item = job_queues[victim].steal();
+		}
+
+		if (item != nullptr)
+			queued_jobs.fetch_sub(1, std::memory_order_relaxed);
+
+		return item;
+	}
+
+	static void queue_job(job* item) {
+		if (!has_local_queue() || !job_queues[local_queue_index].push(item)) {
+			//Either this thread doesn't own a queue or it is full, so just do the work right here
+			run_job(item);
+			return;
+		}
+
+		queued_jobs.fetch_add(1, std::memory_order_seq_cst);
+		if (sleeping_workers.load(std::memory_order_seq_cst) > 0) {
+			std::scoped_lock lock {wait_for_job_mutex};
+			wait_for_job.notify_one();
+		}
+	}
+
+	void job_counter_access::finish_job(job_counter& counter) {
+		int outstanding = counter.m_outstanding.load(std::memory_order_acquire);
+		while (outstanding != 1) {
+			if (counter.m_outstanding.compare_exchange_weak(outstanding, outstanding - 1, std::memory_order_acq_rel))
+				return;
+		}
+
+		//This is the last job of the counter. Once it reaches zero, whoever waits on it may destroy it at any time,
+		//so all the continuation handling has to happen before the final decrement.
+		decltype(counter.m_continuations) continuations;
+		{
+			std::scoped_lock lock {counter.m_continuations_mutex};
+			counter.m_resolving.store(true);
+			continuations.swap(counter.m_continuations);
+		}
+
+		for (auto& [function, continuation_counter] : continuations) {
+			//The continuation was already counted when it was submitted
+			queue_job(new job {std::move(function), continuation_counter});
+		}
+
+		counter.m_outstanding.fetch_sub(1, std::memory_order_acq_rel);
+	}
+
 	static void mp_worker_thread_main(size_t threadIdx) {
+		local_queue_index = threadIdx;
+
 		while(true) {
-			{
-				std::unique_lock<std::mutex> lk(wait_for_task_mutex);
-				wait_for_task.wait(lk, []() { return wait_for_task_condition; });
+			job* item = find_job();
+			if (item != nullptr) {
+				run_job(item);
+				continue;
 			}
 
-			switch (worker_task.load(std::memory_order_acquire)) {
-				case WorkerThreadTask::EXIT:
-					return;
-				case WorkerThreadTask::COLLISION:
-					collide_mp_worker_thread(threadIdx);
-					break;
-				default:
-					UNREACHABLE("Invalid threaded worker task!");
-			}
+			//Nothing to do right now, so wait until someone submits something
+			std::unique_lock<std::mutex> lk(wait_for_job_mutex);
+			sleeping_workers.fetch_add(1, std::memory_order_seq_cst);
+			wait_for_job.wait(lk, []() { return queued_jobs.load(std::memory_order_seq_cst) > 0 || exit_workers.load(); });
+			sleeping_workers.fetch_sub(1, std::memory_order_seq_cst);
+
+			if (exit_workers.load())
+				return;
 		}
 	}
 
@@ -143,18 +315,29 @@ namespace threading {
 
 	//External Functions
 
-	void spin_up_threaded_task(WorkerThreadTask task) {
-		worker_task.store(task);
-		{
-			std::scoped_lock lock {wait_for_task_mutex};
-			wait_for_task_condition = true;
-			wait_for_task.notify_all();
-		}
+	void submit_job(job_function job, job_counter* counter) {
+		if (counter != nullptr)
+			job_counter_access::add_job(*counter);
+
+		queue_job(new threading::job {std::move(job), counter});
 	}
 
-	void spin_down_threaded_task() {
-		std::scoped_lock lock {wait_for_task_mutex};
-		wait_for_task_condition = false;
+	void submit_job_after(job_counter& dependency, job_function job, job_counter* counter) {
+		if (counter != nullptr)
+			job_counter_access::add_job(*counter);
+
+		if (!job_counter_access::add_continuation(dependency, job, counter))
+			queue_job(new threading::job {std::move(job), counter});
+	}
+
+	void wait_for(job_counter& counter) {
+		while (!counter.done()) {
+			job* item = find_job();
+			if (item != nullptr)
+				run_job(item);
+			else
+				std::this_thread::yield();
+		}
 	}
 
 	void init_task_pool() {
@@ -173,17 +356,36 @@ namespace threading {
 
 		mprintf(("Spinning up threadpool with %d threads...\n", static_cast<int>(num_threads)));
 
+		num_job_queues = num_threads + 1;
+		job_queues = std::make_unique<job_deque[]>(num_job_queues);
+
+		//The thread initializing the pool is the main thread, and gets the last queue
+		local_queue_index = num_threads;
+
+		exit_workers.store(false);
 		for (size_t i = 0; i < num_threads; i++) {
 			worker_threads.emplace_back([i](){ mp_worker_thread_main(i); });
 		}
 	}
 
 	void shut_down_task_pool() {
-		spin_up_threaded_task(WorkerThreadTask::EXIT);
+		{
+			std::scoped_lock lock {wait_for_job_mutex};
+			exit_workers.store(true);
+			wait_for_job.notify_all();
+		}
 
 		for(auto& thread : worker_threads) {
 			thread.join();
 		}
+		worker_threads.clear();
+
+		//Anything that is left over still needs to run, since someone may be waiting on its counter
+		while (job* item = find_job())
+			run_job(item);
+
+		num_job_queues = 0;
+		job_queues.reset();
 	}
 
 	bool is_threading() {
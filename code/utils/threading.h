@@ -1,19 +1,70 @@
 #pragma once
 
+#include "globalincs/vmallocator.h"
+
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <functional>
+#include <mutex>
 
 namespace threading {
-	enum class WorkerThreadTask : uint8_t { EXIT, COLLISION };
+	using job_function = std::function<void()>;
+
+	//Keeps track of how many jobs of a group are still outstanding.
+	//Every job submitted with a counter increments it, and decrements it again once it has finished running.
+	class job_counter {
+		std::atomic<int> m_outstanding{0};
+
+		//Jobs which were submitted with this counter as their dependency
+		std::mutex m_continuations_mutex;
+		SCP_vector<std::pair<job_function, job_counter*>> m_continuations;
+		//Set while the last job is handing off the continuations, so that late continuations are queued right away
+		std::atomic_bool m_resolving{false};
+
+		friend struct job_counter_access;
+
+	public:
+		job_counter() = default;
+
+		job_counter(const job_counter&) = delete;
+		job_counter& operator=(const job_counter&) = delete;
+
+		bool done() const { return m_outstanding.load(std::memory_order_acquire) == 0; }
+	};
+
+	//Queues a job on the job queue of the calling thread, from where idle workers will steal it.
+	//If there are no worker threads, the job is run immediately.
+	void submit_job(job_function job, job_counter* counter = nullptr);
+
+	//Same as above, but the job is only queued once the dependency counter has reached zero.
+	void submit_job_after(job_counter& dependency, job_function job, job_counter* counter = nullptr);
+
+	//Blocks until the counter has reached zero. The calling thread runs queued jobs while it waits, so this may also be called from within a job.
+	void wait_for(job_counter& counter);
+
+	//Splits [begin, end) into chunks of at most grain_size elements and calls body(first, last) for each of them on the job system.
+	//Returns once all chunks have been processed. The calling thread processes the last chunk itself.
+	template<typename Body>
+	void parallel_for(size_t begin, size_t end, size_t grain_size, Body&& body) {
+		if (end <= begin)
+			return;
+
+		grain_size = std::max(grain_size, static_cast<size_t>(1));
 
-	//Call this to start a task on the task pool. Note that task-specific data must be set up before calling this.
-	void spin_up_threaded_task(WorkerThreadTask task);
+		job_counter counter;
+		size_t first = begin;
+		for (; end - first > grain_size; first += grain_size) {
+			submit_job([&body, first, grain_size]() { body(first, first + grain_size); }, &counter);
+		}
+		body(first, end);
 
-	//This _must_ be called on the main thread BEFORE a task completes on a thread of the task pool.
-	void spin_down_threaded_task();
+		wait_for(counter);
+	}
 
 	void init_task_pool();
 	void shut_down_task_pool();
 
 	bool is_threading();
 	size_t get_num_workers();
-}
\ No newline at end of file
+}
@@ -38,6 +38,7 @@
 #include "network/multiutil.h"
 #include "object/objcollide.h"
 #include "object/objectdock.h"
+#include "object/objectgrid.h"
 #include "object/objectshield.h"
 #include "object/objectsnd.h"
 #include "parse/parsehi.h"
@@ -352,6 +353,7 @@ int missile_obj_list_add(int objnum)
 	Missile_objs[i].objnum = objnum;
 	list_append(&Missile_obj_list, &Missile_objs[i]);
 	Missile_objs[i].flags |= MISSILE_OBJ_USED;
+	obj_grid_add(&Objects[objnum]);
 
 	return i;
 }
@@ -364,6 +366,7 @@ void missle_obj_list_remove(int index)
 {
 	Assert(index >= 0 && index < MAX_MISSILE_OBJS);
 	list_remove(&Missile_obj_list, &Missile_objs[index]);	
+	obj_grid_remove(&Objects[Missile_objs[index].objnum]);
 	Missile_objs[index].flags = 0;
 }
 
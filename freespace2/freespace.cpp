@@ -1484,6 +1484,10 @@ bool game_start_mission()
 		init_multiplayer_stats();
 	}
 
+	// decode the mission sounds on the worker threads while the mission and its models are loaded
+	if ( !(Game_mode & GM_STANDALONE_SERVER) )
+		gamesnd_queue_mission_sounds();
+
 	game_busy( NOX("** starting mission_load() **") );
 	bool load_success = mission_load(Game_current_mission_filename);
 
@@ -0,0 +1,149 @@
+#include <gtest/gtest.h>
+
+#include <ai/ai.h>
+#include <ai/ai_profiles.h>
+#include <cmdline/cmdline.h>
+#include <iff_defs/iff_defs.h>
+#include <mission/missionparse.h>
+#include <object/object.h>
+#include <ship/awacs.h>
+#include <ship/ship.h>
+#include <utils/threading.h>
+
+#include "util/FSTestFixture.h"
+
+#include <algorithm>
+#include <random>
+
+namespace {
+// Enough ships for the decisions to be spread over several jobs
+const int NUM_SHIPS = 200;
+
+const int TEAM_FRIENDLY_TEST = 0;
+const int TEAM_HOSTILE_TEST = 1;
+} // namespace
+
+class AiDecideTargetsTest : public test::FSTestFixture {
+ public:
+	AiDecideTargetsTest() : test::FSTestFixture(INIT_NONE) {
+	}
+
+ protected:
+	SCP_vector<ship_obj> _ship_objs;
+	SCP_vector<int> _objnums;
+	ai_profile_t _ai_profile;
+	int _ship_info_index = -1;
+
+	SCP_vector<iff_info> _saved_iff_info;
+	ai_profile_t* _saved_ai_profile = nullptr;
+	int _saved_multithreading = 0;
+
+	void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		// two teams which attack each other
+		_saved_iff_info = Iff_info;
+		Iff_info.resize(2);
+		Iff_info[TEAM_FRIENDLY_TEST].attackee_bitmask = Iff_info[TEAM_FRIENDLY_TEST].attackee_bitmask_all_teams_at_war = 1 << TEAM_HOSTILE_TEST;
+		Iff_info[TEAM_HOSTILE_TEST].attackee_bitmask = Iff_info[TEAM_HOSTILE_TEST].attackee_bitmask_all_teams_at_war = 1 << TEAM_FRIENDLY_TEST;
+
+		_ship_info_index = (int)Ship_info.size();
+		Ship_info.emplace_back();
+		Ship_info.back().flags.set(Ship::Info_Flags::Fighter);
+
+		for (int i = 0; i < NUM_SKILL_LEVELS; ++i) {
+			_ai_profile.max_attackers[i] = 3;
+		}
+		_saved_ai_profile = The_mission.ai_profile;
+		The_mission.ai_profile = &_ai_profile;
+
+		// The ship_obj nodes have to stay where they are once they are linked
+		_ship_objs.resize(NUM_SHIPS);
+		list_init(&Ship_obj_list);
+
+		// A furball where the ships are close enough for the numbers of attackers to matter
+		std::mt19937 gen(42);
+		std::uniform_real_distribution<float> dist(-1500.0f, 1500.0f);
+
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			auto objp = &Objects[i];
+			objp->type = OBJ_SHIP;
+			objp->instance = i;
+			objp->signature = i + 1;
+			objp->radius = 10.0f;
+			objp->pos.xyz.x = dist(gen);
+			objp->pos.xyz.y = dist(gen);
+			objp->pos.xyz.z = dist(gen);
+
+			auto shipp = &Ships[i];
+			shipp->objnum = i;
+			shipp->ai_index = i;
+			shipp->ship_info_index = _ship_info_index;
+			shipp->team = (i % 3 == 0) ? TEAM_HOSTILE_TEST : TEAM_FRIENDLY_TEST;
+			shipp->wingnum = -1;
+
+			auto aip = &Ai_info[i];
+			aip->shipnum = i;
+			aip->enemy_wing = -1;
+			aip->targeted_subsys = nullptr;
+			aip->danger_weapon_objnum = -1;
+			aip->ignore_objnum = UNUSED_OBJNUM;
+			for (int j = 0; j < MAX_IGNORE_NEW_OBJECTS; ++j) {
+				aip->ignore_new_objnums[j] = UNUSED_OBJNUM;
+			}
+			// some ships already have a target, which counts towards the attackers of that ship
+			aip->target_objnum = (i % 4 == 0) ? (i + 1) % NUM_SHIPS : -1;
+
+			_ship_objs[i].objnum = i;
+			list_append(&Ship_obj_list, &_ship_objs[i]);
+
+			_objnums.push_back(i);
+		}
+
+		awacs_level_init();
+
+		_saved_multithreading = Cmdline_multithreading;
+		Cmdline_multithreading = 4;
+		threading::init_task_pool();
+	}
+
+	void TearDown() override {
+		threading::shut_down_task_pool();
+		Cmdline_multithreading = _saved_multithreading;
+
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			Objects[i].clear();
+			Ships[i].objnum = -1;
+			Ships[i].ai_index = -1;
+			Ships[i].ship_info_index = -1;
+			Ai_info[i].shipnum = -1;
+			Ai_info[i].target_objnum = -1;
+		}
+		list_init(&Ship_obj_list);
+
+		The_mission.ai_profile = _saved_ai_profile;
+		Ship_info.pop_back();
+		Iff_info = _saved_iff_info;
+
+		test::FSTestFixture::TearDown();
+	}
+};
+
+TEST_F(AiDecideTargetsTest, parallelMatchesSerial) {
+	ASSERT_TRUE(threading::is_threading());
+
+	SCP_vector<int> serial_targets;
+	ai_decide_target_objnums(_objnums, false, serial_targets);
+
+	// there has to be something to compare, else the test says nothing
+	ASSERT_EQ(serial_targets.size(), _objnums.size());
+	ASSERT_TRUE(std::any_of(serial_targets.begin(), serial_targets.end(), [](int target) { return target >= 0; }));
+
+	// the jobs run in a different order every time, so repeat it a few times
+	for (int run = 0; run < 10; ++run) {
+		SCP_vector<int> parallel_targets;
+		ai_decide_target_objnums(_objnums, true, parallel_targets);
+
+		ASSERT_EQ(serial_targets, parallel_targets) << "run " << run;
+	}
+}
@@ -0,0 +1,252 @@
+
+#include <gtest/gtest.h>
+
+#include "math/fvi.h"
+#include "math/fvi_simd.h"
+#include "math/vecmat.h"
+
+#include <random>
+
+namespace {
+struct test_poly {
+	SCP_vector<vec3d> verts;
+	vec3d norm;
+	size_t first_tri;
+	size_t last_tri;
+};
+
+class random_polys {
+	std::mt19937 _gen;
+	std::uniform_real_distribution<float> _unit{-1.0f, 1.0f};
+
+  public:
+	SCP_vector<test_poly> polys;
+	fvi_tri_soa tris;
+
+	explicit random_polys(unsigned int seed) : _gen(seed) {}
+
+	vec3d random_vec(float scale)
+	{
+		vec3d v;
+		v.xyz.x = _unit(_gen) * scale;
+		v.xyz.y = _unit(_gen) * scale;
+		v.xyz.z = _unit(_gen) * scale;
+		return v;
+	}
+
+	float random_float(float min, float max) { return min + (_unit(_gen) + 1.0f) * 0.5f * (max - min); }
+
+	// Convex polygons with 3 to 8 vertices, which are slightly bent like the ones found in actual models
+	void generate(size_t count)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			test_poly poly;
+
+			vec3d center = random_vec(100.0f);
+			vec3d norm = random_vec(1.0f);
+			vm_vec_normalize_safe(&norm);
+
+			matrix orient;
+			vm_vector_2_matrix_norm(&orient, &norm);
+
+			int nv = 3 + (int)(random_float(0.0f, 5.99f));
+			float radius = random_float(1.0f, 20.0f);
+			for (int j = 0; j < nv; ++j) {
+				float angle = (PI2 * j) / nv;
+				vec3d vert = center;
+				vm_vec_scale_add2(&vert, &orient.vec.rvec, cosf(angle) * radius);
+				vm_vec_scale_add2(&vert, &orient.vec.uvec, sinf(angle) * radius);
+				vm_vec_scale_add2(&vert, &orient.vec.fvec, random_float(-0.01f, 0.01f) * radius);
+				poly.verts.push_back(vert);
+			}
+			poly.norm = norm;
+
+			poly.first_tri = tris.count;
+			for (int j = 2; j < nv; ++j) {
+				tris.add(&poly.verts[0], &poly.verts[j - 1], &poly.verts[j], &poly.norm);
+			}
+			poly.last_tri = tris.count;
+
+			polys.push_back(std::move(poly));
+		}
+
+		tris.finish();
+	}
+
+	// A path which passes close to a random polygon, so that a good number of the tests actually hit something
+	void random_path(vec3d *p0, vec3d *pdir, float length)
+	{
+		const auto &poly = polys[(size_t)random_float(0.0f, (float)polys.size() - 0.01f)];
+		vec3d target = poly.verts[0];
+		vm_vec_add2(&target, &poly.verts[1]);
+		vm_vec_add2(&target, &poly.verts[2]);
+		vm_vec_scale(&target, 1.0f / 3.0f);
+		vec3d offset = random_vec(10.0f);
+		vm_vec_add2(&target, &offset);
+
+		vec3d dir = random_vec(1.0f);
+		vm_vec_normalize_safe(&dir);
+		vm_vec_scale_add(p0, &target, &dir, -length * random_float(0.0f, 1.5f));
+		vm_vec_copy_scale(pdir, &dir, length);
+	}
+
+	SCP_vector<vec3d *> vert_pointers(test_poly &poly)
+	{
+		SCP_vector<vec3d *> pointers;
+		for (auto &vert : poly.verts) {
+			pointers.push_back(&vert);
+		}
+		return pointers;
+	}
+};
+
+bool any_marked(const SCP_vector<ubyte> &hits, const test_poly &poly)
+{
+	for (size_t i = poly.first_tri; i < poly.last_tri; ++i) {
+		if (hits[i]) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// The vectorized and scalar paths do the same operations in the same order, but the compiler is free to contract some
+// of them into fused multiply-adds differently, so hits right on the tolerance boundary may differ in rare cases.
+const size_t MAX_MISMATCHES_PER_MILLION = 10;
+} // namespace
+
+TEST(FviSimdTest, rayMatchesScalar)
+{
+	random_polys data(1234);
+	data.generate(1000);
+
+	SCP_vector<ubyte> simd_hits(data.tris.count), scalar_hits(data.tris.count);
+	size_t mismatches = 0, marked = 0, tests = 0;
+
+	for (int i = 0; i < 1000; ++i) {
+		vec3d p0, pdir;
+		data.random_path(&p0, &pdir, 50.0f);
+		float max_dist = (i % 4 == 0) ? FLT_MAX : 1.0f;
+
+		// Test odd ranges as well, so that the tails which don't fill a whole register get covered
+		size_t first = (size_t)(i % 7);
+		size_t last = data.tris.count - (size_t)(i % 5);
+
+		fvi_ray_tris(data.tris, first, last, &p0, &pdir, max_dist, simd_hits.data());
+		fvi_ray_tris_scalar(data.tris, first, last, &p0, &pdir, max_dist, scalar_hits.data());
+
+		for (size_t j = 0; j < last - first; ++j) {
+			mismatches += simd_hits[j] != scalar_hits[j];
+			marked += scalar_hits[j];
+			++tests;
+		}
+	}
+
+	EXPECT_GT(marked, (size_t)0);
+	EXPECT_LE(mismatches * 1000000, tests * MAX_MISMATCHES_PER_MILLION) << "Instruction set: " << fvi_simd_instruction_set();
+}
+
+TEST(FviSimdTest, spherelineMatchesScalar)
+{
+	random_polys data(4321);
+	data.generate(1000);
+
+	SCP_vector<ubyte> simd_hits(data.tris.count), scalar_hits(data.tris.count);
+	size_t mismatches = 0, marked = 0, tests = 0;
+
+	for (int i = 0; i < 1000; ++i) {
+		vec3d p0, pdir;
+		data.random_path(&p0, &pdir, 50.0f);
+		float radius = data.random_float(0.5f, 10.0f);
+
+		size_t first = (size_t)(i % 7);
+		size_t last = data.tris.count - (size_t)(i % 5);
+
+		fvi_sphereline_tris(data.tris, first, last, &p0, &pdir, radius, simd_hits.data());
+		fvi_sphereline_tris_scalar(data.tris, first, last, &p0, &pdir, radius, scalar_hits.data());
+
+		for (size_t j = 0; j < last - first; ++j) {
+			mismatches += simd_hits[j] != scalar_hits[j];
+			marked += scalar_hits[j];
+			++tests;
+		}
+	}
+
+	EXPECT_GT(marked, (size_t)0);
+	EXPECT_LE(mismatches * 1000000, tests * MAX_MISMATCHES_PER_MILLION) << "Instruction set: " << fvi_simd_instruction_set();
+}
+
+TEST(FviSimdTest, rayNeverMissesExactHits)
+{
+	random_polys data(5678);
+	data.generate(500);
+
+	SCP_vector<ubyte> hits(data.tris.count);
+	size_t exact_hits = 0;
+
+	for (int i = 0; i < 2000; ++i) {
+		vec3d p0, pdir;
+		data.random_path(&p0, &pdir, 50.0f);
+
+		fvi_ray_tris(data.tris, 0, data.tris.count, &p0, &pdir, 1.0f, hits.data());
+
+		for (auto &poly : data.polys) {
+			// This is what mc_check_face() does, minus the backface culling
+			auto verts = data.vert_pointers(poly);
+			vec3d hit_point;
+			float dist = fvi_ray_plane(&hit_point, verts[0], &poly.norm, &p0, &pdir, 0.0f);
+			if (dist < 0.0f || dist > 1.0f) {
+				continue;
+			}
+
+			if (fvi_point_face(&hit_point, (int)verts.size(), verts.data(), &poly.norm, nullptr, nullptr, nullptr)) {
+				++exact_hits;
+				ASSERT_TRUE(any_marked(hits, poly)) << "Ray " << i << " hits a polygon which wasn't marked";
+			}
+		}
+	}
+
+	EXPECT_GT(exact_hits, (size_t)0);
+}
+
+TEST(FviSimdTest, spherelineNeverMissesExactHits)
+{
+	random_polys data(8765);
+	data.generate(500);
+
+	SCP_vector<ubyte> hits(data.tris.count);
+	size_t exact_hits = 0;
+
+	for (int i = 0; i < 2000; ++i) {
+		vec3d p0, pdir;
+		data.random_path(&p0, &pdir, 50.0f);
+		float radius = data.random_float(0.5f, 10.0f);
+
+		fvi_sphereline_tris(data.tris, 0, data.tris.count, &p0, &pdir, radius, hits.data());
+
+		for (auto &poly : data.polys) {
+			// This is what mc_check_sphereline_face() does, minus the backface culling
+			auto verts = data.vert_pointers(poly);
+			vec3d hit_point;
+			float face_t, delta_t, edge_t;
+			if (!fvi_sphere_plane(&hit_point, &p0, &pdir, radius, &poly.norm, verts[0], &face_t, &delta_t)) {
+				continue;
+			}
+
+			bool hit = false;
+			if (face_t >= 0.0f && face_t <= 1.0f) {
+				hit = fvi_point_face(&hit_point, (int)verts.size(), verts.data(), &poly.norm, nullptr, nullptr, nullptr) != 0;
+			}
+			if (!hit && face_t <= 1.0f && face_t + delta_t >= 0.0f) {
+				hit = fvi_polyedge_sphereline(&hit_point, &p0, &pdir, radius, (int)verts.size(), verts.data(), &edge_t) != 0;
+			}
+
+			if (hit) {
+				++exact_hits;
+				ASSERT_TRUE(any_marked(hits, poly)) << "Sphere " << i << " touches a polygon which wasn't marked";
+			}
+		}
+	}
+
+	EXPECT_GT(exact_hits, (size_t)0);
+}
@@ -26,6 +26,7 @@ protected:
 		pm = new polymodel();
 		pmi = new polymodel_instance();
 
+		pm->n_models = 3;
 		pm->submodel = new bsp_info[3];
 		pmi->submodel = new submodel_instance[3];
 
@@ -98,4 +99,39 @@ TEST_F(SubmodelLocalizeTest, submodel_instance_localize_roundtrip_world) {
 	EXPECT_VECMAT_NEAR(global, (vec3d{ {{-1.0f, 4.0f, 1.0f}} }));
 	EXPECT_VECMAT_NEAR(roundtrip, local);
 	EXPECT_VECMAT_NEAR(roundtripMat, localMat);
-}
\ No newline at end of file
+}
+
+TEST_F(SubmodelLocalizeTest, submodel_instance_transform_invalidation) {
+
+	vec3d local{ {{0.0f, 1.0f, 0.0f}} };
+	vec3d global;
+	model_instance_local_to_global_point(&global, &local, pm, pmi, 2);
+	EXPECT_VECMAT_NEAR(global, (vec3d{ {{-1.0f, 1.0f, 1.0f}} }));
+
+	// moving the parent has to move the child as well
+	angles ang{ 0.0f, PI_2, 0.0f };
+	vm_angles_2_matrix(&pmi->submodel[1].canonical_orient, &ang);
+	pmi->submodel[1].canonical_offset = vec3d{ {{2.0f, 0.0f, 0.0f}} };
+	submodel_invalidate_transform(&pmi->submodel[1]);
+
+	// the last frame isn't cached, so it can be used to check the cached transforms against walking up the tree
+	for (int i = 0; i < 3; ++i) {
+		pmi->submodel[i].canonical_prev_orient = pmi->submodel[i].canonical_orient;
+		pmi->submodel[i].canonical_prev_offset = pmi->submodel[i].canonical_offset;
+	}
+
+	vec3d expected;
+	model_instance_local_to_global_point(&expected, &local, pm, pmi, 2, nullptr, nullptr, true);
+	model_instance_local_to_global_point(&global, &local, pm, pmi, 2);
+	EXPECT_VECMAT_NEAR(global, expected);
+
+	vec3d expected_dir;
+	vec3d dir;
+	model_instance_global_to_local_dir(&expected_dir, &local, pm, pmi, 2, nullptr, true);
+	model_instance_global_to_local_dir(&dir, &local, pm, pmi, 2);
+	EXPECT_VECMAT_NEAR(dir, expected_dir);
+
+	vec3d roundtrip;
+	model_instance_global_to_local_point(&roundtrip, &global, pm, pmi, 2);
+	EXPECT_VECMAT_NEAR(roundtrip, local);
+}
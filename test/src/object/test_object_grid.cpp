@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include "math/vecmat.h"
+#include "object/objectgrid.h"
+
+#include <random>
+
+namespace {
+const float CELL_SIZE = 2000.0f;
+
+struct grid_object {
+	int objnum;
+	vec3d pos;
+	float bound;
+	bool always_include;
+};
+
+class random_objects {
+	std::mt19937 _gen;
+
+  public:
+	SCP_vector<grid_object> objects;
+
+	explicit random_objects(unsigned int seed) : _gen(seed) {}
+
+	vec3d random_pos(float extent)
+	{
+		std::uniform_real_distribution<float> dist(-extent, extent);
+
+		vec3d v;
+		v.xyz.x = dist(_gen);
+		v.xyz.y = dist(_gen);
+		v.xyz.z = dist(_gen);
+		return v;
+	}
+
+	// Mostly fighters and bombers, with a few capital ships which are too large for a single cell
+	void add(object_grid& grid, int count, float extent)
+	{
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+		for (int i = 0; i < count; ++i) {
+			grid_object obj;
+			// spread the object numbers like the object slots in a mission
+			obj.objnum = (i * 13) % 5000;
+			obj.pos = random_pos(extent);
+			obj.bound = unit(_gen) < 0.05f ? 500.0f + 3000.0f * unit(_gen) : 5.0f + 30.0f * unit(_gen);
+			obj.always_include = unit(_gen) < 0.02f;
+
+			grid.add(obj.objnum, obj.pos, obj.bound, obj.always_include);
+			objects.push_back(obj);
+		}
+	}
+};
+
+// The objects in insertion order whose bound intersects the sphere, which the query has to return
+SCP_vector<int> linear_query(const SCP_vector<grid_object>& objects, const vec3d& center, float radius)
+{
+	SCP_vector<int> result;
+	for (auto& obj : objects) {
+		if (obj.always_include || vm_vec_dist(&obj.pos, &center) <= radius + obj.bound) {
+			result.push_back(obj.objnum);
+		}
+	}
+	return result;
+}
+
+// Checks that expected is a subsequence of actual, i.e. that actual contains everything in the right order
+void expect_contains_in_order(const SCP_vector<int>& expected, const SCP_vector<int>& actual)
+{
+	auto iter = actual.begin();
+	for (auto objnum : expected) {
+		iter = std::find(iter, actual.end(), objnum);
+		ASSERT_NE(iter, actual.end()) << "Object " << objnum << " is missing or out of order";
+	}
+}
+} // namespace
+
+TEST(ObjectGridTest, sphereQueryMatchesLinearScan)
+{
+	object_grid grid(CELL_SIZE);
+	random_objects objects(1);
+	objects.add(grid, 1000, 20000.0f);
+
+	EXPECT_EQ(grid.getNumObjects(), 1000);
+
+	SCP_vector<int> result;
+	for (float radius : {0.0f, 100.0f, 800.0f, 2500.0f, 99999.9f}) {
+		for (int i = 0; i < 20; ++i) {
+			auto center = objects.random_pos(20000.0f);
+			grid.querySphere(center, radius, result);
+
+			auto expected = linear_query(objects.objects, center, radius);
+			expect_contains_in_order(expected, result);
+
+			// the grid may return a few objects which are out of range, but not many
+			EXPECT_LE(result.size(), expected.size() * 2 + 10) << "Radius " << radius;
+		}
+	}
+}
+
+TEST(ObjectGridTest, removeAndUpdate)
+{
+	object_grid grid(CELL_SIZE);
+
+	vec3d origin = vmd_zero_vector;
+	vec3d far_away;
+	vm_vec_make(&far_away, 50000.0f, 0.0f, 0.0f);
+
+	grid.add(3, origin, 10.0f);
+	grid.add(1, origin, 10.0f);
+	grid.add(2, far_away, 10.0f);
+
+	SCP_vector<int> result;
+	grid.querySphere(origin, 100.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({3, 1}));
+
+	// moving an object keeps its place in the order
+	grid.update(2, origin, 10.0f);
+	grid.update(3, far_away, 10.0f);
+	grid.querySphere(origin, 100.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({1, 2}));
+
+	// objects which are always included are returned regardless of where they are
+	grid.update(3, far_away, 10.0f, true);
+	grid.querySphere(origin, 100.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({3, 1, 2}));
+
+	grid.remove(1);
+	grid.remove(1);
+	EXPECT_FALSE(grid.contains(1));
+	EXPECT_EQ(grid.getNumObjects(), 2);
+	grid.querySphere(origin, 100.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({3, 2}));
+
+	// an object which is added again goes after everything else
+	grid.add(1, origin, 10.0f);
+	grid.querySphere(origin, 100.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({3, 2, 1}));
+
+	grid.clear();
+	EXPECT_EQ(grid.getNumObjects(), 0);
+	grid.querySphere(origin, 100000.0f, result);
+	EXPECT_TRUE(result.empty());
+}
+
+TEST(ObjectGridTest, coneQuery)
+{
+	object_grid grid(CELL_SIZE);
+
+	vec3d apex = vmd_zero_vector;
+	vec3d dir;
+	vm_vec_make(&dir, 0.0f, 0.0f, 1.0f);
+
+	vec3d ahead, behind, beside, large_beside;
+	vm_vec_make(&ahead, 0.0f, 100.0f, 1000.0f);
+	vm_vec_make(&behind, 0.0f, 0.0f, -1000.0f);
+	vm_vec_make(&beside, 1000.0f, 0.0f, 100.0f);
+	vm_vec_make(&large_beside, 1000.0f, 0.0f, 100.0f);
+
+	grid.add(0, ahead, 10.0f);
+	grid.add(1, behind, 10.0f);
+	grid.add(2, beside, 10.0f);
+	// the bounding sphere of this one reaches into the cone
+	grid.add(3, large_beside, 900.0f);
+
+	SCP_vector<int> result;
+	grid.queryCone(apex, dir, 2000.0f, cosf(PI / 6), result);
+	EXPECT_EQ(result, SCP_vector<int>({0, 3}));
+
+	// a cone wider than a half space
+	grid.queryCone(apex, dir, 2000.0f, cosf(PI * 0.75f), result);
+	EXPECT_EQ(result, SCP_vector<int>({0, 2, 3}));
+
+	// too short to reach anything
+	grid.queryCone(apex, dir, 500.0f, cosf(PI / 6), result);
+	EXPECT_EQ(result, SCP_vector<int>({3}));
+}
+
+TEST(ObjectGridTest, narrowConeQuery)
+{
+	object_grid grid(CELL_SIZE);
+
+	vec3d apex = vmd_zero_vector;
+	vec3d dir;
+	vm_vec_make(&dir, 0.0f, 0.0f, 1.0f);
+
+	// the turret field of view test accepts this one for a cone without any width, its bounding sphere doesn't reach the axis
+	vec3d close_to_axis, far_from_axis;
+	vm_vec_make(&close_to_axis, 100.0f, 0.0f, 1000.0f);
+	vm_vec_make(&far_from_axis, 400.0f, 0.0f, 1000.0f);
+
+	grid.add(0, close_to_axis, 50.0f);
+	grid.add(1, far_from_axis, 50.0f);
+
+	SCP_vector<int> result;
+	grid.queryCone(apex, dir, 2000.0f, 1.0f, result);
+	EXPECT_EQ(result, SCP_vector<int>({0}));
+}
@@ -0,0 +1,282 @@
+#include <gtest/gtest.h>
+
+#include <globalincs/systemvars.h>
+#include <io/timer.h>
+#include <mission/missiongoals.h>
+#include <parse/parselo.h>
+#include <parse/sexp.h>
+#include <parse/sexp/sexp_program.h>
+#include <playerman/player.h>
+
+#include "util/FSTestFixture.h"
+
+class SEXPProgramTest : public test::FSTestFixture {
+ public:
+	SEXPProgramTest() : test::FSTestFixture(INIT_CFILE) {
+		pushModDir("sexp_program");
+	}
+
+ protected:
+	void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		init_sexp();
+	}
+
+	static int parse_sexp(const char* text) {
+		char buf[1024];
+		strcpy_s(buf, text);
+
+		auto oldMp = Mp;
+		Mp = buf;
+		auto node = get_sexp_main();
+		Mp = oldMp;
+
+		return node;
+	}
+
+	// Both trees have been parsed from the same text, so they have the same shape
+	static void expect_same_values(int tree_node, int program_node) {
+		if (tree_node < 0 || program_node < 0) {
+			EXPECT_EQ(tree_node < 0, program_node < 0);
+			return;
+		}
+
+		EXPECT_EQ(Sexp_nodes[tree_node].value, Sexp_nodes[program_node].value) << "Node " << CTEXT(tree_node);
+
+		expect_same_values(Sexp_nodes[tree_node].first, Sexp_nodes[program_node].first);
+		expect_same_values(Sexp_nodes[tree_node].rest, Sexp_nodes[program_node].rest);
+	}
+
+	// Evaluates the sexp a few times with the tree interpreter and the compiled program and checks that both agree
+	static void expect_equivalent(const char* text, size_t expected_tree_instructions) {
+		SCOPED_TRACE(text);
+
+		auto tree = parse_sexp(text);
+		auto compiled = parse_sexp(text);
+		ASSERT_GE(tree, 0);
+		ASSERT_GE(compiled, 0);
+
+		auto program = sexp::SEXPProgram::compile(compiled);
+		EXPECT_EQ(program.getRoot(), compiled);
+		EXPECT_EQ(program.getNumTreeInstructions(), expected_tree_instructions);
+
+		for (int i = 0; i < 3; ++i) {
+			auto tree_result = eval_sexp(tree);
+			auto program_result = program.evaluate();
+
+			EXPECT_EQ(tree_result, program_result) << "Evaluation " << i;
+			expect_same_values(tree, compiled);
+			EXPECT_TRUE(Current_sexp_operator.empty());
+		}
+
+		free_sexp2(tree);
+		free_sexp2(compiled);
+	}
+};
+
+TEST_F(SEXPProgramTest, boolean_operators) {
+	expect_equivalent("( when ( and ( < 1 2 ) ( or ( false ) ( = 3 3 3 ) ) ( not ( > 1 2 ) ) ) ( do-nothing ) )", 0);
+	expect_equivalent("( when ( or ( >= 1 2 ) ( <= 2 1 ) ( != 4 4 ) ) ( do-nothing ) )", 0);
+}
+
+TEST_F(SEXPProgramTest, known_values) {
+	// these become known-false and known-true, after which the condition isn't evaluated any more
+	expect_equivalent("( when ( and ( true ) ( false ) ) ( do-nothing ) )", 0);
+	expect_equivalent("( when ( or ( false ) ( not ( false ) ) ) ( do-nothing ) )", 0);
+	expect_equivalent("( when ( and ( true ) ( not ( true ) ) ( < 1 2 ) ) ( do-nothing ) )", 0);
+}
+
+TEST_F(SEXPProgramTest, conditionals) {
+	expect_equivalent("( every-time ( < 1 2 ) ( do-nothing ) )", 0);
+	expect_equivalent("( if-then-else ( > 1 2 ) ( do-nothing ) ( do-nothing ) )", 0);
+	expect_equivalent("( if-then-else ( true ) ( do-nothing ) ( do-nothing ) )", 0);
+}
+
+TEST_F(SEXPProgramTest, tree_fallback) {
+	// operators which aren't compiled are handed to eval_sexp together with their arguments
+	expect_equivalent("( when ( = ( + 1 2 ) 3 ) ( do-nothing ) )", 1);
+	expect_equivalent("( when ( and ( < ( * 2 3 ) ( - 10 1 ) ) ( xor ( true ) ( false ) ) ) ( do-nothing ) )", 3);
+}
+
+TEST_F(SEXPProgramTest, dependencies) {
+	using Dependency = sexp::SEXPProgram::Dependency;
+
+	auto compile = [](const char* text) {
+		auto node = parse_sexp(text);
+		EXPECT_GE(node, 0) << text;
+
+		auto program = sexp::SEXPProgram::compile(node);
+		free_sexp2(node);
+		return program;
+	};
+
+	auto program = compile("( when ( has-time-elapsed 10 ) ( do-nothing ) )");
+	EXPECT_TRUE(program.isSchedulable());
+	EXPECT_EQ(program.getDependencies(), flagset<Dependency>({ Dependency::Time }));
+
+	program = compile("( when ( and ( is-destroyed-delay 0 \"Alpha 1\" \"Beta\" ) ( not ( is-goal-incomplete \"Destroy\" ) ) ) ( do-nothing ) )");
+	EXPECT_TRUE(program.isSchedulable());
+	EXPECT_EQ(program.getDependencies(), flagset<Dependency>({ Dependency::MissionLog, Dependency::Ships, Dependency::Time }));
+	// every argument of the objective operator may name a ship or wing, the goal is found through the mission log
+	EXPECT_EQ(program.getDependencyNodes(Dependency::Ships).size(), 3u);
+	EXPECT_TRUE(program.getDependencyNodes(Dependency::Events).empty());
+	EXPECT_TRUE(program.getDependencyNodes(Dependency::MissionLog).empty());
+
+	program = compile("( when ( or ( is-event-true \"Start\" ) ( is-event-incomplete \"End\" ) ) ( do-nothing ) )");
+	EXPECT_TRUE(program.isSchedulable());
+	EXPECT_EQ(program.getDependencies(), flagset<Dependency>({ Dependency::Events }));
+	EXPECT_EQ(program.getDependencyNodes(Dependency::Events).size(), 2u);
+	EXPECT_TRUE(program.getDependencyNodes(Dependency::Ships).empty());
+
+	// the actions run every time or when the condition is false, so these have to be evaluated
+	EXPECT_FALSE(compile("( every-time ( has-time-elapsed 10 ) ( do-nothing ) )").isSchedulable());
+	EXPECT_FALSE(compile("( if-then-else ( has-time-elapsed 10 ) ( do-nothing ) ( do-nothing ) )").isSchedulable());
+
+	// operators which may read anything
+	EXPECT_FALSE(compile("( when ( = ( + 1 2 ) 3 ) ( do-nothing ) )").isSchedulable());
+	EXPECT_FALSE(compile("( when ( has-time-elapsed ( + 1 2 ) ) ( do-nothing ) )").isSchedulable());
+	EXPECT_FALSE(compile("( when ( is-event-true-delay \"Start\" 5 ) ( do-nothing ) )").isSchedulable());
+}
+
+namespace {
+struct event_definition {
+	const char* name;
+	const char* formula;
+	int repeat_count;
+	int interval;
+	int chain_delay;
+};
+
+// What processing an event leaves behind, with the timestamps relative to the start of the run
+struct event_state {
+	int result;
+	int flags;
+	int count;
+	int repeat_count;
+	int timestamp;
+	int satisfied_time;
+
+	bool operator==(const event_state& other) const {
+		return result == other.result && flags == other.flags && count == other.count && repeat_count == other.repeat_count
+			&& timestamp == other.timestamp && satisfied_time == other.satisfied_time;
+	}
+};
+
+std::ostream& operator<<(std::ostream& out, const event_state& state) {
+	return out << "result " << state.result << ", flags " << state.flags << ", count " << state.count << ", repeat count "
+	           << state.repeat_count << ", timestamp " << state.timestamp << ", satisfied " << state.satisfied_time;
+}
+
+const int NUM_FRAMES = 60;
+const int FRAME_MSECS = 250;
+
+// invalid, never and immediate don't depend on when the run started, so they are kept apart from the relative times
+int relative_timestamp(TIMESTAMP stamp, int start) {
+	if (!stamp.isFinite() || stamp.isImmediate())
+		return -10 - stamp.value();
+
+	return stamp.value() - start;
+}
+} // namespace
+
+class SEXPEventSchedulingTest : public SEXPProgramTest {
+ protected:
+	player* _saved_player = nullptr;
+	fix _saved_missiontime = 0;
+
+	void SetUp() override {
+		SEXPProgramTest::SetUp();
+
+		// the frames advance the timestamps by hand, so both runs see exactly the same times
+		timestamp_pause(true);
+
+		// an event which is done adds its score to the player
+		_saved_player = Player;
+		Player = &Players[0];
+		_saved_missiontime = Missiontime;
+	}
+
+	void TearDown() override {
+		Missiontime = _saved_missiontime;
+		Player = _saved_player;
+		timestamp_unpause(true);
+
+		SEXPProgramTest::TearDown();
+	}
+
+	// Evaluates the events for a number of frames, during which the mission time moves on and the events change each
+	// other's results.  Returns the state of every event after each frame.
+	static SCP_vector<SCP_vector<event_state>> run_events(const SCP_vector<event_definition>& definitions, bool scheduling) {
+		mission_goals_and_events_init();
+		for (auto& definition : definitions) {
+			mission_event mevent;
+			mevent.name = definition.name;
+			mevent.formula = parse_sexp(definition.formula);
+			mevent.repeat_count = definition.repeat_count;
+			mevent.interval = definition.interval;
+			mevent.chain_delay = definition.chain_delay;
+			EXPECT_GE(mevent.formula, 0) << definition.formula;
+
+			Mission_events.push_back(mevent);
+		}
+		mission_events_compile();
+
+		Mission_event_scheduling = scheduling;
+		Missiontime = 0;
+		timer_start_frame();
+		int start = timestamp();
+
+		SCP_vector<SCP_vector<event_state>> frames;
+		for (int frame = 0; frame < NUM_FRAMES; ++frame) {
+			timestamp_adjust_microseconds(FRAME_MSECS * MICROSECONDS_PER_MILLISECOND, TIMER_DIRECTION::FORWARD);
+			timer_start_frame();
+			Missiontime += fl2f(FRAME_MSECS / 1000.0f);
+
+			mission_eval_goals();
+
+			frames.emplace_back();
+			for (auto& mevent : Mission_events) {
+				frames.back().push_back({ mevent.result, mevent.flags, mevent.count, mevent.repeat_count,
+					relative_timestamp(mevent.timestamp, start), relative_timestamp(mevent.satisfied_time, start) });
+			}
+		}
+
+		for (auto& mevent : Mission_events) {
+			free_sexp2(mevent.formula);
+		}
+		mission_goals_and_events_init();
+		Mission_event_scheduling = true;
+
+		return frames;
+	}
+};
+
+TEST_F(SEXPEventSchedulingTest, same_results_as_unscheduled) {
+	SCP_vector<event_definition> events = {
+		{ "Start", "( when ( has-time-elapsed 3 ) ( do-nothing ) )", 1, 1, -1 },
+		{ "Follow", "( when ( is-event-true \"Start\" ) ( do-nothing ) )", 1, 1, -1 },
+		{ "Wait", "( when ( and ( is-event-true \"Follow\" ) ( has-time-elapsed 8 ) ) ( do-nothing ) )", 1, 1, -1 },
+		{ "After Wait", "( when ( not ( is-event-incomplete \"Wait\" ) ) ( do-nothing ) )", 1, 1, -1 },
+		{ "Repeat", "( when ( or ( has-time-elapsed 5 ) ( is-event-true \"Wait\" ) ) ( do-nothing ) )", 3, 2, -1 },
+		{ "Chained", "( when ( has-time-elapsed 1 ) ( do-nothing ) )", 1, 1, 2 },
+		{ "Never", "( when ( and ( has-time-elapsed 1000 ) ( is-event-true \"Start\" ) ) ( do-nothing ) )", 1, 1, -1 },
+	};
+
+	auto scheduled = run_events(events, true);
+	auto unscheduled = run_events(events, false);
+
+	ASSERT_EQ(scheduled.size(), unscheduled.size());
+	for (size_t frame = 0; frame < scheduled.size(); ++frame) {
+		for (size_t i = 0; i < events.size(); ++i) {
+			EXPECT_EQ(unscheduled[frame][i], scheduled[frame][i]) << events[i].name << " in frame " << frame;
+		}
+	}
+
+	// the events have to actually change over the frames, else nothing has been compared
+	auto& last_frame = scheduled.back();
+	for (size_t i = 0; i < events.size(); ++i) {
+		bool never = !strcmp(events[i].name, "Never");
+		EXPECT_EQ(last_frame[i].result != 0, !never) << events[i].name;
+	}
+}
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+
+#include <object/object.h>
+#include <ship/ship.h>
+
+#include "util/FSTestFixture.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+// As many ships as a large fleet battle mission has
+const int NUM_SHIPS = 400;
+
+// The lookup as it was before the index, which is the reference the index has to match
+int linear_ship_name_lookup(const char* name, int inc_players)
+{
+	for (int i = 0; i < MAX_SHIPS; i++) {
+		if (Ships[i].objnum >= 0) {
+			if (Objects[Ships[i].objnum].type == OBJ_SHIP || (Objects[Ships[i].objnum].type == OBJ_START && inc_players)) {
+				if (!stricmp(name, Ships[i].ship_name)) {
+					return i;
+				}
+			}
+		}
+	}
+
+	return -1;
+}
+} // namespace
+
+class ShipNameLookupTest : public test::FSTestFixture {
+ public:
+	ShipNameLookupTest() : test::FSTestFixture(INIT_NONE) {
+	}
+
+ protected:
+	SCP_vector<SCP_string> _names;
+
+	void SetUp() override {
+		test::FSTestFixture::SetUp();
+
+		// Spread the ships over the array like in a mission where ships have arrived and died in between
+		for (int i = 0; i < NUM_SHIPS; ++i) {
+			int shipnum = (i * 7) % MAX_SHIPS;
+
+			Ships[shipnum].objnum = shipnum;
+			Objects[shipnum].type = OBJ_SHIP;
+			Objects[shipnum].instance = shipnum;
+			sprintf(Ships[shipnum].ship_name, "GTF Myrmidon %d", i);
+			ship_name_index_add(shipnum);
+
+			_names.emplace_back(Ships[shipnum].ship_name);
+		}
+	}
+
+	void TearDown() override {
+		for (int i = 0; i < MAX_SHIPS; ++i) {
+			if (Ships[i].objnum >= 0) {
+				ship_name_index_remove(i);
+				Ships[i].objnum = -1;
+				Ships[i].ship_name[0] = '\0';
+				Objects[i].type = OBJ_NONE;
+			}
+		}
+
+		test::FSTestFixture::TearDown();
+	}
+
+	void expectSameAsLinear(const char* name) {
+		EXPECT_EQ(linear_ship_name_lookup(name, 0), ship_name_lookup(name, 0)) << name;
+		EXPECT_EQ(linear_ship_name_lookup(name, 1), ship_name_lookup(name, 1)) << name;
+	}
+};
+
+TEST_F(ShipNameLookupTest, matchesLinearLookup) {
+	for (auto& name : _names) {
+		expectSameAsLinear(name.c_str());
+	}
+
+	expectSameAsLinear("gtf myrmidon 17");
+	expectSameAsLinear("GTF MYRMIDON 399");
+	expectSameAsLinear("GTF Myrmidon 400");
+	expectSameAsLinear("");
+}
+
+TEST_F(ShipNameLookupTest, deleteAndRename) {
+	// deleted ships can't be found any more
+	int deleted = ship_name_lookup("GTF Myrmidon 10");
+	ASSERT_GE(deleted, 0);
+	ship_name_index_remove(deleted);
+	Ships[deleted].objnum = -1;
+	Objects[deleted].type = OBJ_NONE;
+	EXPECT_EQ(-1, ship_name_lookup("GTF Myrmidon 10"));
+
+	int renamed = ship_name_lookup("GTF Myrmidon 20");
+	ASSERT_GE(renamed, 0);
+	ship_rename(renamed, "Alpha 1");
+	EXPECT_EQ(-1, ship_name_lookup("GTF Myrmidon 20"));
+	EXPECT_EQ(renamed, ship_name_lookup("alpha 1"));
+
+	// player start ships are only found if asked for
+	Objects[renamed].type = OBJ_START;
+	expectSameAsLinear("Alpha 1");
+	EXPECT_EQ(-1, ship_name_lookup("Alpha 1", 0));
+	EXPECT_EQ(renamed, ship_name_lookup("Alpha 1", 1));
+
+	// with duplicate names the lowest slot wins, like it always did
+	int other = ship_name_lookup("GTF Myrmidon 30");
+	ASSERT_GE(other, 0);
+	ship_rename(other, "GTF Myrmidon 31");
+	expectSameAsLinear("GTF Myrmidon 31");
+}
+
+TEST_F(ShipNameLookupTest, renameInWing) {
+	// red-alert restores and in-game joins give a ship the name of its slot in the wing
+	int restored = ship_name_lookup("GTF Myrmidon 40");
+	ASSERT_GE(restored, 0);
+	ship_rename_in_wing(restored, "Alpha", 4);
+	EXPECT_EQ(-1, ship_name_lookup("GTF Myrmidon 40"));
+	EXPECT_EQ(restored, ship_name_lookup("Alpha 4"));
+	expectSameAsLinear("GTF Myrmidon 40");
+	expectSameAsLinear("Alpha 4");
+
+	// wing names with a hash put the number in front of it
+	int joined = ship_name_lookup("GTF Myrmidon 50");
+	ASSERT_GE(joined, 0);
+	ship_rename_in_wing(joined, "Beta#Delta", 2);
+	EXPECT_EQ(-1, ship_name_lookup("GTF Myrmidon 50"));
+	EXPECT_EQ(joined, ship_name_lookup("Beta 2#Delta"));
+	expectSameAsLinear("Beta 2#Delta");
+}
+
+// Not run by default, use --gtest_also_run_disabled_tests to get the numbers
+TEST_F(ShipNameLookupTest, DISABLED_lookupBenchmark) {
+	constexpr int ROUNDS = 100;
+
+	// every ship gets looked up once per round, like a mission with a few sexps referencing each ship
+	auto time_lookups = [this](int (*lookup)(const char*, int)) {
+		int found = 0;
+
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int round = 0; round < ROUNDS; ++round) {
+			for (auto& name : _names) {
+				found += lookup(name.c_str(), 0) >= 0 ? 1 : 0;
+			}
+		}
+		auto end = std::chrono::high_resolution_clock::now();
+
+		EXPECT_EQ(ROUNDS * NUM_SHIPS, found);
+		return std::chrono::duration<double, std::micro>(end - start).count() / (ROUNDS * NUM_SHIPS);
+	};
+
+	auto linear_us = time_lookups(linear_ship_name_lookup);
+	auto index_us = time_lookups(ship_name_lookup);
+
+	std::cout << NUM_SHIPS << " ships: linear lookup " << linear_us << " us, indexed lookup " << index_us << " us"
+	          << std::endl;
+}
@@ -13,6 +13,10 @@ add_file_folder("Actions\\\\Expression"
 	actions/expression/test_ExpressionParser.cpp
 )
 
+add_file_folder("AI"
+    ai/test_ai_decide_targets.cpp
+)
+
 add_file_folder("CFile"
     cfile/cfile.cpp
 )
@@ -28,6 +32,7 @@ add_file_folder("Graphics"
 )
 
 add_file_folder("Math"
+    math/test_fvi_simd.cpp
     math/test_vecmat.cpp
 )
 
@@ -43,9 +48,14 @@ add_file_folder("model"
     model/test_modelread.cpp
 )
 
+add_file_folder("Object"
+    object/test_object_grid.cpp
+)
+
 add_file_folder("Parse"
     parse/test_parselo.cpp
     parse/test_replace.cpp
+    parse/test_sexp_program.cpp
 )
 
 add_file_folder("Pilotfile"
@@ -81,14 +91,24 @@ add_file_folder("Scripting\\\\Lua"
     scripting/lua/Value.cpp
 )
 
+add_file_folder("Ship"
+    ship/test_ship_name_lookup.cpp
+)
+
 add_file_folder("Test Util"
     util/FSTestFixture.cpp
     util/FSTestFixture.h
     util/test_util.h
 )
 
+add_file_folder("Tracing"
+    tracing/test_latency_histogram.cpp
+)
+
 add_file_folder("Utils"
     utils/HeapAllocatorTest.cpp
+    utils/test_flat_hash_map.cpp
+    utils/test_random.cpp
 )
 
 add_file_folder("Weapon"
@@ -0,0 +1,52 @@
+#include <gtest/gtest.h>
+
+#include "tracing/FrameTelemetry.h"
+
+using namespace tracing;
+
+TEST(LatencyHistogramTest, bucketsCoverValues)
+{
+	// Every value has to end up in a bucket whose range contains it, and the relative error has to stay bounded
+	for (std::uint64_t value = 0; value < 1000000; value = value * 11 / 10 + 1) {
+		auto index = LatencyHistogram::bucketIndex(value);
+		ASSERT_LT(index, LatencyHistogram::BUCKET_COUNT);
+
+		auto upper = LatencyHistogram::bucketValue(index);
+		ASSERT_GE(upper, value);
+		ASSERT_LE(upper - value, value / LatencyHistogram::SUB_BUCKET_COUNT + 1) << "Value " << value;
+
+		if (index > 0) {
+			ASSERT_LT(LatencyHistogram::bucketValue(index - 1), value);
+		}
+	}
+
+	EXPECT_EQ(LatencyHistogram::bucketIndex(LatencyHistogram::MAX_VALUE), LatencyHistogram::BUCKET_COUNT - 1);
+	EXPECT_EQ(LatencyHistogram::bucketValue(LatencyHistogram::BUCKET_COUNT - 1), LatencyHistogram::MAX_VALUE);
+}
+
+TEST(LatencyHistogramTest, percentiles)
+{
+	LatencyHistogram histogram;
+	EXPECT_EQ(histogram.percentile(0.5), 0u);
+
+	// 1000 frames of about 16ms with ten spikes, which an average would hide
+	for (int i = 0; i < 990; ++i) {
+		histogram.record(16000 + i % 100);
+	}
+	for (int i = 0; i < 10; ++i) {
+		histogram.record(100000 + i);
+	}
+
+	EXPECT_EQ(histogram.count(), 1000u);
+	EXPECT_EQ(histogram.max(), 100009u);
+
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.5)), 16050.0, 16050.0 * 0.04);
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.95)), 16095.0, 16095.0 * 0.04);
+	EXPECT_NEAR(static_cast<double>(histogram.percentile(0.995)), 100000.0, 100000.0 * 0.04);
+	EXPECT_EQ(histogram.percentile(1.0), 100009u);
+
+	histogram.reset();
+	EXPECT_EQ(histogram.count(), 0u);
+	EXPECT_EQ(histogram.max(), 0u);
+	EXPECT_EQ(histogram.percentile(0.99), 0u);
+}
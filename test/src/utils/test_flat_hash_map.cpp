@@ -0,0 +1,191 @@
+
+#include <gtest/gtest.h>
+
+#include "utils/flat_hash_map.h"
+
+#include <chrono>
+#include <iostream>
+#include <random>
+
+using namespace util;
+
+namespace {
+// Same layout as the objcollide.cpp collision cache: two object indices packed into one key
+uint make_pair_key(uint a, uint b)
+{
+	return (a << 16) + b;
+}
+
+struct cached_pair {
+	void* a = nullptr;
+	void* b = nullptr;
+	int signature_a = -1;
+	int signature_b = -1;
+	int next_check_time = -1;
+	bool initialized = false;
+};
+} // namespace
+
+TEST(FlatHashMapTests, insertFindErase)
+{
+	flat_hash_map<uint, int> map;
+
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(nullptr, map.find(42));
+
+	map[42] = 1;
+	map[7] = 2;
+
+	ASSERT_EQ((size_t)2, map.size());
+	ASSERT_NE(nullptr, map.find(42));
+	ASSERT_EQ(1, *map.find(42));
+	ASSERT_EQ(2, *map.find(7));
+
+	ASSERT_TRUE(map.erase(42));
+	ASSERT_FALSE(map.erase(42));
+	ASSERT_EQ(nullptr, map.find(42));
+	ASSERT_EQ(2, *map.find(7));
+	ASSERT_EQ((size_t)1, map.size());
+
+	map.clear();
+	ASSERT_TRUE(map.empty());
+	ASSERT_EQ(nullptr, map.find(7));
+}
+
+TEST(FlatHashMapTests, matchesUnorderedMap)
+{
+	std::mt19937 gen(1234);
+	// A small key range causes lots of collisions and erasures of existing keys
+	std::uniform_int_distribution<uint> keyDist(0, 5000);
+	std::uniform_int_distribution<int> opDist(0, 3);
+
+	flat_hash_map<uint, int> map;
+	SCP_unordered_map<uint, int> reference;
+
+	for (int i = 0; i < 100000; ++i) {
+		auto key = keyDist(gen);
+
+		switch (opDist(gen)) {
+		case 0:
+		case 1:
+			map[key] = i;
+			reference[key] = i;
+			break;
+		case 2:
+			ASSERT_EQ(reference.erase(key) > 0, map.erase(key));
+			break;
+		default: {
+			auto found = map.find(key);
+			auto it = reference.find(key);
+			ASSERT_EQ(it != reference.end(), found != nullptr);
+			if (found != nullptr) {
+				ASSERT_EQ(it->second, *found);
+			}
+			break;
+		}
+		}
+	}
+
+	ASSERT_EQ(reference.size(), map.size());
+
+	size_t count = 0;
+	for (auto& element : map) {
+		ASSERT_EQ(reference.at(element.first), element.second);
+		++count;
+	}
+	ASSERT_EQ(reference.size(), count);
+}
+
+TEST(FlatHashMapTests, eraseIf)
+{
+	flat_hash_map<uint, int> map;
+
+	for (uint i = 0; i < 10000; ++i) {
+		map[i * 7919] = (int)i;
+	}
+
+	size_t visited = 0;
+	auto erased = map.erase_if([&visited](uint, int& value) {
+		++visited;
+		value += 1;
+		return value % 3 == 0;
+	});
+
+	// every element has to be visited exactly once, even though erasing shifts elements around
+	ASSERT_EQ((size_t)10000, visited);
+	ASSERT_EQ((size_t)3333, erased);
+	ASSERT_EQ((size_t)(10000 - 3333), map.size());
+
+	for (uint i = 0; i < 10000; ++i) {
+		auto found = map.find(i * 7919);
+		if ((i + 1) % 3 == 0) {
+			ASSERT_EQ(nullptr, found);
+		} else {
+			ASSERT_NE(nullptr, found);
+			ASSERT_EQ((int)i + 1, *found);
+		}
+	}
+}
+
+namespace {
+template <typename Map, typename Lookup, typename Sweep>
+double time_collision_cache_frames(Map& map, const SCP_vector<uint>& keys, Lookup&& lookup, Sweep&& sweep)
+{
+	constexpr int FRAMES = 20;
+
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < FRAMES; ++frame) {
+		// every live pair gets looked up once per frame, and then the stale ones get swept out
+		for (auto key : keys) {
+			lookup(map, key).next_check_time = frame;
+		}
+		sweep(map, frame);
+	}
+	auto end = std::chrono::high_resolution_clock::now();
+
+	return std::chrono::duration<double, std::milli>(end - start).count() / FRAMES;
+}
+} // namespace
+
+// Not run by default, use --gtest_also_run_disabled_tests to get the numbers
+TEST(FlatHashMapTests, DISABLED_collisionCacheBenchmark)
+{
+	std::mt19937 gen(42);
+	std::uniform_int_distribution<uint> objDist(0, 5000);
+
+	for (size_t live_pairs : {10000, 50000, 100000, 200000}) {
+		SCP_vector<uint> keys;
+		SCP_unordered_set<uint> unique;
+		while (unique.size() < live_pairs) {
+			auto key = make_pair_key(objDist(gen), objDist(gen));
+			if (unique.insert(key).second)
+				keys.push_back(key);
+		}
+
+		SCP_unordered_map<uint, cached_pair> node_map;
+		auto node_ms = time_collision_cache_frames(
+			node_map, keys,
+			[](SCP_unordered_map<uint, cached_pair>& map, uint key) -> cached_pair& { return map[key]; },
+			[](SCP_unordered_map<uint, cached_pair>& map, int frame) {
+				for (auto it = map.begin(); it != map.end();) {
+					if (it->second.next_check_time != frame)
+						it = map.erase(it);
+					else
+						++it;
+				}
+			});
+
+		flat_hash_map<uint, cached_pair> flat_map;
+		auto flat_ms = time_collision_cache_frames(
+			flat_map, keys,
+			[](flat_hash_map<uint, cached_pair>& map, uint key) -> cached_pair& { return map[key]; },
+			[](flat_hash_map<uint, cached_pair>& map, int frame) {
+				map.erase_if([frame](uint, cached_pair& pair) { return pair.next_check_time != frame; });
+			});
+
+		ASSERT_EQ(node_map.size(), flat_map.size());
+
+		std::cout << live_pairs << " live pairs: SCP_unordered_map " << node_ms << " ms/frame, flat_hash_map "
+		          << flat_ms << " ms/frame" << std::endl;
+	}
+}
@@ -0,0 +1,105 @@
+#include <gtest/gtest.h>
+
+#include "utils/Random.h"
+#include "utils/RandomRange.h"
+
+#include <thread>
+
+using namespace util;
+
+namespace {
+SCP_vector<int> draw_numbers(unsigned int seed, const UniformFloatRange& range, size_t count)
+{
+	Random::ThreadSeed thread_seed(seed);
+
+	SCP_vector<int> numbers;
+	for (size_t i = 0; i < count; ++i) {
+		numbers.push_back(Random::next());
+		numbers.push_back(static_cast<int>(range.next() * 1000.0f));
+	}
+	return numbers;
+}
+} // namespace
+
+TEST(RandomTest, threadSeedIsDeterministic)
+{
+	UniformFloatRange range(0.0f, 1.0f);
+
+	auto first = draw_numbers(1234, range, 100);
+	auto second = draw_numbers(1234, range, 100);
+	auto other = draw_numbers(4321, range, 100);
+
+	EXPECT_EQ(first, second);
+	EXPECT_NE(first, other);
+}
+
+TEST(RandomTest, threadSeedIsPerThread)
+{
+	UniformFloatRange range(0.0f, 1.0f);
+
+	auto expected = draw_numbers(1234, range, 1000);
+
+	// Other threads drawing from the global generator and the shared range at the same time must not interfere
+	SCP_vector<int> on_thread;
+	std::thread seeded([&]() { on_thread = draw_numbers(1234, range, 1000); });
+	std::thread unseeded([&]() {
+		for (int i = 0; i < 1000; ++i) {
+			Random::next();
+		}
+	});
+	seeded.join();
+	unseeded.join();
+
+	EXPECT_EQ(expected, on_thread);
+}
+
+TEST(RandomTest, threadSeedRestoresPrevious)
+{
+	EXPECT_EQ(Random::thread_generator(), nullptr);
+
+	{
+		Random::ThreadSeed outer(1);
+		auto outer_generator = Random::thread_generator();
+		ASSERT_NE(outer_generator, nullptr);
+
+		{
+			Random::ThreadSeed inner(2);
+			EXPECT_NE(Random::thread_generator(), outer_generator);
+		}
+
+		EXPECT_EQ(Random::thread_generator(), outer_generator);
+	}
+
+	EXPECT_EQ(Random::thread_generator(), nullptr);
+}
+
+TEST(RandomTest, explicitSeedIgnoresThreadSeed)
+{
+	UniformFloatRange unthreaded(0.0f, 1.0f);
+	unthreaded.seed(42);
+	auto expected = unthreaded.next();
+
+	UniformFloatRange threaded(0.0f, 1.0f);
+	{
+		Random::ThreadSeed thread_seed(1234);
+		threaded.seed(42);
+		EXPECT_EQ(expected, threaded.next());
+	}
+}
+
+TEST(RandomTest, seededNextMatchesSeed)
+{
+	NormalFloatRange range(0.0f, 1.0f);
+
+	auto value = range.next(42);
+
+	// Drawing with a seed must not change the range, so the value can be reproduced with and without a thread seed
+	EXPECT_EQ(value, range.next(42));
+	{
+		Random::ThreadSeed thread_seed(1234);
+		EXPECT_EQ(value, range.next(42));
+	}
+
+	range.seed(42);
+	EXPECT_EQ(value, range.next());
+}